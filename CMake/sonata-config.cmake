@@ -1 +1,4 @@
-include("${CMAKE_CURRENT_LIST_DIR}/sonata-targets.cmake")
\ No newline at end of file
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+
+include("${CMAKE_CURRENT_LIST_DIR}/sonata-targets.cmake")
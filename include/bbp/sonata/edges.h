@@ -12,6 +12,7 @@
 #include "common.h"
 #include "population.h"
 
+#include <memory>  // std::shared_ptr
 #include <string>
 #include <vector>
 
@@ -23,6 +24,35 @@ namespace sonata {
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * The edges of several nodes, as returned by `EdgePopulation::afferentEdgesPerNode` and
+ * `EdgePopulation::efferentEdgesPerNode`.
+ *
+ * The edges of the i-th node are the ranges `ranges[offsets[i]:offsets[i + 1]]`.
+ */
+struct SONATA_API EdgesPerNode {
+    std::vector<uint64_t> offsets;
+    Selection::Ranges ranges;
+
+    /**
+     * Number of nodes
+     */
+    size_t size() const {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    /**
+     * Edges of the i-th node
+     */
+    Selection operator[](size_t i) const {
+        return Selection(Selection::Ranges(ranges.begin() + static_cast<ptrdiff_t>(offsets[i]),
+                                           ranges.begin() +
+                                               static_cast<ptrdiff_t>(offsets[i + 1])));
+    }
+};
+
+//--------------------------------------------------------------------------------------------------
+
 class SONATA_API EdgePopulation: public Population
 {
   public:
@@ -73,14 +103,53 @@ class SONATA_API EdgePopulation: public Population
     Selection connectingEdges(const std::vector<NodeID>& source,
                               const std::vector<NodeID>& target) const;
 
+    /**
+     * Return inbound edges of each of the given node IDs, in one call.
+     */
+    EdgesPerNode afferentEdgesPerNode(const std::vector<NodeID>& target) const;
+
+    /**
+     * Return outbound edges of each of the given node IDs, in one call.
+     */
+    EdgesPerNode efferentEdgesPerNode(const std::vector<NodeID>& source) const;
+
+    /**
+     * Load the node->edge indices in memory.
+     *
+     * Afterwards, queries for afferent, efferent or connecting edges no longer read the file.
+     * The indices take 8 bytes per node and 16 bytes per range of edges, for both directions.
+     * They are loaded once and shared by all the populations which preload them from the same
+     * file, until the last of these populations is destroyed, or the indices are rewritten.
+     *
+     * Rewrites by `writeIndices` are always noticed. Other rewrites, e.g. by another process, are
+     * noticed by the modification time and size of the file, and the sizes of the indices: they
+     * are missed if the file system doesn't update its modification time.
+     */
+    void preloadIndices();
+
+    /**
+     * Whether the node->edge indices were loaded in memory by `preloadIndices`.
+     */
+    bool hasPreloadedIndices() const;
+
     /**
      * Write bidirectional node->edge indices to EdgePopulation HDF5.
+     *
+     * The node IDs are streamed from the file in blocks, scanned by up to `n_threads` threads,
+     * so that memory use is bounded by the number of nodes rather than edges.
+     *
+     * \param overwrite replaces existing indices, instead of throwing
      */
     static void writeIndices(const std::string& h5FilePath,
                              const std::string& population,
                              uint64_t sourceNodeCount,
                              uint64_t targetNodeCount,
-                             bool overwrite = false);
+                             bool overwrite = false,
+                             size_t n_threads = 1);
+
+  private:
+    struct PreloadedIndices;
+    std::shared_ptr<const PreloadedIndices> preloaded_;
 };
 
 //--------------------------------------------------------------------------------------------------
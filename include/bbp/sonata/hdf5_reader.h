@@ -179,5 +179,25 @@ class SONATA_API Hdf5Reader
     std::shared_ptr<Hdf5PluginInterface<supported_1D_types, supported_2D_types>> impl;
 };
 
+/// Create an Hdf5Reader which reads with `n_threads` threads.
+///
+/// Numeric datasets stored contiguously, i.e. neither chunked nor compressed,
+/// are read directly from the file, splitting the selection across the
+/// threads. Other datasets are read as with the default `Hdf5Reader`. With
+/// `n_threads <= 1` this is the default `Hdf5Reader`.
+///
+/// This reader is not MPI-collective.
+SONATA_API Hdf5Reader makeParallelHdf5Reader(size_t n_threads);
+
+/// Create an Hdf5Reader which reads from memory mappings of the files.
+///
+/// Numeric datasets stored contiguously, i.e. neither chunked nor compressed,
+/// are copied straight out of the mapping of their file, which is kept open
+/// as long as the reader, or mapped anew if the file is replaced or modified.
+/// Other datasets are read as with the default `Hdf5Reader`.
+///
+/// This reader is not MPI-collective.
+SONATA_API Hdf5Reader makeMappedHdf5Reader();
+
 }  // namespace sonata
 }  // namespace bbp
@@ -25,6 +25,52 @@
 namespace bbp {
 namespace sonata {
 
+/**
+ * Read-only array of values memory-mapped from a file, see `Population::getAttributeView`.
+ *
+ * Copies share the mapping, which is released when the last one is destroyed.
+ */
+template <typename T>
+class MappedArray
+{
+  public:
+    MappedArray() = default;
+
+    MappedArray(std::shared_ptr<const void> owner, const T* data, size_t size)
+        : owner_(std::move(owner))
+        , data_(data)
+        , size_(size) { }
+
+    const T* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    const T& operator[](size_t i) const {
+        return data_[i];
+    }
+
+    const T* begin() const {
+        return data_;
+    }
+
+    const T* end() const {
+        return data_ + size_;
+    }
+
+  private:
+    std::shared_ptr<const void> owner_;
+    const T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
 class SONATA_API Population
 {
   public:
@@ -92,6 +138,20 @@ class SONATA_API Population
                                 const Selection& selection,
                                 const T& defaultValue) const;
 
+    /**
+     * Get a read-only view of all the values of an attribute, memory-mapped from the file
+     * without any copy.
+     *
+     * Only attributes stored contiguously (i.e. neither chunked nor compressed), with exactly
+     * the type `T` and aligned in the file can be viewed; use `getAttribute` for the others.
+     *
+     * \param name is a string to allow attributes not defined in spec
+     * \throw if there is no such attribute for the population
+     * \throw if the attribute can't be memory-mapped
+     */
+    template <typename T>
+    MappedArray<T> getAttributeView(const std::string& name) const;
+
     /**
      * Get enumeration values for given attribute and {element} Selection
      *
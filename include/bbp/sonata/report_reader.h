@@ -1,6 +1,8 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -13,6 +15,8 @@
 namespace bbp {
 namespace sonata {
 
+class CompartmentSet;
+
 // KeyType will be NodeID for somas report and CompartmentID for elements report
 template <typename KeyType>
 struct SONATA_API DataFrame {
@@ -23,6 +27,42 @@ struct SONATA_API DataFrame {
     std::vector<float> data;
 };
 
+/// Scratch space for the blocks read by `ReportReader::Population::getInto`, kept between calls so
+/// that polling the same selection doesn't allocate it again
+struct SONATA_API ReportReadBuffer {
+    std::vector<float> values;
+    // The values read from 'data' stored as float16 or int16, before they are decoded
+    std::vector<int16_t> encoded;
+};
+
+/// Summary of report values over windows of timesteps, see `ReportReader::Population::getSummary`
+template <typename KeyType>
+struct SONATA_API ReportSummary {
+    using DataType = std::vector<KeyType>;
+    // Number of timesteps per window
+    size_t window = 1;
+    // Time of the first timestep of each window
+    std::vector<double> times;
+    DataType ids;
+    // min[windows][ids], flattened; likewise for max and mean
+    std::vector<float> min;
+    std::vector<float> max;
+    std::vector<float> mean;
+};
+
+/// Reduction of report values, see `ReportReader::Population::getReducedByNode`
+enum class ReportReduction { sum, mean, min, max };
+
+/**
+ * Type of the values of the 'data' dataset of a report, decoded to float32 when read.
+ *
+ * - float32: the values as is.
+ * - float16: IEEE 754 half precision floats, accurate to about 3 decimal digits.
+ * - int16: integers v standing for v * scale_factor + add_offset, given by the attributes of
+ *   the dataset of the same names (1 and 0 if missing).
+ */
+enum class ReportEncoding { float32, float16, int16 };
+
 using Spike = std::pair<NodeID, double>;
 using Spikes = std::vector<Spike>;
 struct SpikeTimes {
@@ -30,6 +70,17 @@ struct SpikeTimes {
     std::vector<double> timestamps;
 };
 
+/// Statistics of the inter-spike intervals of nodes
+struct SONATA_API IsiStats {
+    std::vector<NodeID> node_ids;
+    // Number of intervals, i.e. the number of spikes minus one, if any
+    std::vector<uint64_t> counts;
+    // Mean of the intervals, NaN without intervals
+    std::vector<double> means;
+    // Coefficient of variation: the standard deviation of the intervals over their mean
+    std::vector<double> cvs;
+};
+
 /// Used to read spike files
 class SONATA_API SpikeReader
 {
@@ -56,17 +107,59 @@ class SONATA_API SpikeReader
                    const nonstd::optional<double>& tstop = nonstd::nullopt) const;
 
         /**
-         * Return the raw node_ids and timestamps vectors
+         * Return the raw node_ids and timestamps vectors, without copying them
          */
         const SpikeTimes& getRawArrays() const;
 
         /**
          * Return the node_ids and timestamps vectors with all node_ids between 'tstart' and 'tstop'
+         *
+         * Spikes are returned in the order of the file. Indices by node ID and by time are built
+         * on the first filtered query, so that later ones only visit the matching spikes. Lazy
+         * populations are instead searched and read in the file.
          */
         SpikeTimes getArrays(const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
                              const nonstd::optional<double>& tstart = nonstd::nullopt,
                              const nonstd::optional<double>& tstop = nonstd::nullopt) const;
 
+        /**
+         * Same as `getArrays`, replacing the content of `spikes`, whose memory is reused
+         */
+        void getArrays(SpikeTimes& spikes,
+                       const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
+                       const nonstd::optional<double>& tstart = nonstd::nullopt,
+                       const nonstd::optional<double>& tstop = nonstd::nullopt) const;
+
+        /**
+         * Return the number of spikes of `node_ids` (all nodes if not given) in each bin of
+         * `binSize` splitting [tstart, tstop), the last bin being cut at `tstop`.
+         *
+         * Counting is split between up to `n_threads` threads.
+         */
+        std::vector<uint64_t> binnedCounts(const nonstd::optional<Selection>& node_ids,
+                                           double tstart,
+                                           double tstop,
+                                           double binSize,
+                                           size_t n_threads = 1) const;
+
+        /**
+         * Return the number of spikes per unit of time of each of `node_ids`, in order, between
+         * 'tstart' and 'tstop' (those of the population if not given).
+         */
+        std::vector<double> firingRates(const Selection& node_ids,
+                                        const nonstd::optional<double>& tstart = nonstd::nullopt,
+                                        const nonstd::optional<double>& tstop = nonstd::nullopt,
+                                        size_t n_threads = 1) const;
+
+        /**
+         * Return the statistics of the intervals between the spikes of each of `node_ids`, in
+         * order, between 'tstart' and 'tstop'.
+         */
+        IsiStats isiStats(const Selection& node_ids,
+                          const nonstd::optional<double>& tstart = nonstd::nullopt,
+                          const nonstd::optional<double>& tstop = nonstd::nullopt,
+                          size_t n_threads = 1) const;
+
         /**
          * Return the way data are sorted ('none', 'by_id', 'by_time')
          */
@@ -78,26 +171,42 @@ class SONATA_API SpikeReader
         std::string getTimeUnits() const;
 
       private:
-        Population(const std::string& filename, const std::string& populationName);
+        class SpikeIndex;
+        class LazySpikes;
+
+        Population(const std::string& filename, const std::string& populationName, bool lazy);
 
         SpikeTimes spike_times_;
+        // Built on first use by `getArrays` and the spike statistics, shared by copies
+        std::shared_ptr<SpikeIndex> index_;
+        // Set instead of `spike_times_` for sorted populations of a lazy SpikeReader
+        std::shared_ptr<LazySpikes> lazy_;
         Sorting sorting_ = Sorting::none;
         // Use for clamping of user values
         double tstart_, tstop_;
         std::string time_units_;
 
-        void filterNode(Spikes& spikes, const Selection& node_ids) const;
-        void filterTimestamp(Spikes& spikes, double tstart, double tstop) const;
         /**
-         * Create the spikes from the vectors of node_ids and timestamps
+         * All the spikes, read from the file on first use for lazy populations
          */
-        Spikes createSpikes() const;
+        const SpikeTimes& spikeTimes() const;
+        /**
+         * Positions in the index by node of the spikes of `node_id` in [tstart, tstop]
+         */
+        std::pair<size_t, size_t> nodeSpikes(NodeID node_id, double tstart, double tstop) const;
 
         friend SpikeReader;
     };
 
     explicit SpikeReader(std::string filename);
 
+    /**
+     * With `lazy`, populations sorted 'by_time' or 'by_id' are not loaded in memory when opened.
+     * Instead, `get` and `getArrays` binary-search the datasets in the file and only read the
+     * spikes which can match. Other populations are loaded in memory as usual.
+     */
+    SpikeReader(std::string filename, bool lazy);
+
     /**
      * Return a list of all population names.
      */
@@ -107,11 +216,127 @@ class SONATA_API SpikeReader
 
   private:
     std::string filename_;
+    bool lazy_ = false;
 
     // Lazy loaded population
     mutable std::map<std::string, Population> populations_;
 };
 
+/// Used to write spike files
+class SONATA_API SpikeWriter
+{
+  public:
+    using Sorting = SpikeReader::Population::Sorting;
+
+    /**
+     * Spikes are sorted with up to `n_threads` threads when written.
+     */
+    explicit SpikeWriter(std::string filename, size_t n_threads = 1);
+
+    /**
+     * Declare a population, whose spikes are written sorted according to `sorting`.
+     *
+     * Throws if the population was already added, or once the file is written.
+     */
+    void addPopulation(const std::string& populationName,
+                       Sorting sorting = Sorting::by_time,
+                       const std::string& timeUnits = "ms");
+
+    /**
+     * Add a batch of spikes to a population declared with `addPopulation`.
+     *
+     * Batches can be added from several threads at the same time, until the file is written.
+     */
+    void addSpikes(const std::string& populationName,
+                   const std::vector<NodeID>& node_ids,
+                   const std::vector<double>& timestamps);
+
+    /**
+     * Sort the spikes of each population and write them to the file, which is overwritten.
+     *
+     * The datasets are split in chunks of `chunkSize` spikes, compressed with deflate if
+     * `compressionLevel` is positive. With a `chunkSize` of 0, they are stored contiguously and
+     * can't be compressed. The spikes are dropped from the writer once written.
+     *
+     * The file can only be written once: the writer throws on any later call.
+     */
+    void write(size_t chunkSize = 65536, unsigned compressionLevel = 0);
+
+  private:
+    struct PopulationSpikes {
+        Sorting sorting;
+        std::string time_units;
+        SpikeTimes spikes;
+    };
+
+    std::string filename_;
+    size_t n_threads_;
+
+    std::mutex mutex_;
+    std::map<std::string, PopulationSpikes> populations_;
+    bool written_ = false;
+};
+
+/// Spikes of several populations and their population
+struct SONATA_API MergedSpikes {
+    std::vector<NodeID> node_ids;
+    std::vector<double> timestamps;
+    // Index in the sources of the population of each spike
+    std::vector<size_t> sources;
+};
+
+/// Used to read the spikes of several populations, possibly in several files, as one sorted stream
+class SONATA_API MergedSpikeReader
+{
+  public:
+    using Sorting = SpikeReader::Population::Sorting;
+    // File name and population name
+    using Source = std::pair<std::string, std::string>;
+
+    /**
+     * Merge the spikes of `sources`, sorted 'by_time' or 'by_id' according to `sorting`.
+     *
+     * Spikes with the same sorting key are ordered as their sources, then as in their source.
+     * The sources sorted accordingly are read `blockSize` spikes at a time as they are merged,
+     * the others are loaded and sorted when opened.
+     */
+    explicit MergedSpikeReader(std::vector<Source> sources,
+                               Sorting sorting = Sorting::by_time,
+                               size_t blockSize = 65536);
+    MergedSpikeReader(MergedSpikeReader&&) noexcept;
+    MergedSpikeReader& operator=(MergedSpikeReader&&) noexcept;
+    ~MergedSpikeReader();
+
+    const std::vector<Source>& getSources() const;
+
+    /**
+     * Return the next spikes, `maxSpikes` at most; none once all of them have been read.
+     */
+    MergedSpikes next(size_t maxSpikes);
+
+    /**
+     * Return true once all the spikes have been read.
+     */
+    bool done() const;
+
+    /**
+     * Go back to the first spike.
+     */
+    void reset();
+
+  private:
+    class Cursor;
+
+    std::vector<Source> sources_;
+    Sorting sorting_;
+    std::vector<std::unique_ptr<Cursor>> cursors_;
+    // Heap of the cursors with spikes left, whose next spike comes first at the top
+    std::vector<size_t> heap_;
+
+    // Does the next spike of cursor `lhs` come after the next spike of cursor `rhs`?
+    bool after(size_t lhs, size_t rhs) const;
+};
+
 template <typename KeyType>
 class SONATA_API ReportReader
 {
@@ -119,6 +344,8 @@ class SONATA_API ReportReader
     class Population
     {
       public:
+        class FrameIterator;
+
         /**
          * Return (tstart, tstop, tstep) of the population
          */
@@ -139,6 +366,24 @@ class SONATA_API ReportReader
          */
         bool getSorted() const;
 
+        /**
+         * Return true if the population has a transposed copy of its data, written by
+         * `ReportWriter::writeTransposedData`. Queries then read it instead of 'data' whenever
+         * it is expected to be cheaper, e.g. for the long traces of a few nodes. Transposed
+         * data of a previous generation of 'data' is ignored, as is, on a best-effort basis,
+         * transposed data outdated by writes to 'data' in place (see
+         * `ReportWriter::writeTransposedData`).
+         */
+        bool hasTransposedData() const;
+
+        /**
+         * Return the number of timesteps per window of each level of the summary pyramid
+         * written by `ReportWriter::writeSummaryPyramid`, from the finest; empty without one,
+         * or if it was computed from a previous generation of 'data', or if it is outdated by
+         * writes to 'data' in place, as far as its fingerprint of 'data' tells.
+         */
+        std::vector<size_t> getSummaryWindows() const;
+
         /**
          * Return all the node ids.
          */
@@ -168,14 +413,148 @@ class SONATA_API ReportReader
          * tstop=nonstd::nullopt indicates no limit. \param tstride indicates every how many
          * timesteps we read data. tstride=nonstd::nullopt indicates that all timesteps are read.
          * \param block_gap_limit gap limit between each IO block while fetching data from storage.
+         * \param max_read_size upper bound, in bytes, of the buffer used for each read from
+         * storage; as many timesteps as fit are fetched with a single read (at least one).
+         * max_read_size=nonstd::nullopt uses 64MB.
          */
         DataFrame<KeyType> get(
             const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
             const nonstd::optional<double>& tstart = nonstd::nullopt,
             const nonstd::optional<double>& tstop = nonstd::nullopt,
             const nonstd::optional<size_t>& tstride = nonstd::nullopt,
+            const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt,
+            const nonstd::optional<size_t>& max_read_size = nonstd::nullopt) const;
+
+        /**
+         * Same as `get`, reading into `data_frame`, whose vectors are reused: once they are
+         * large enough, polling the same selection doesn't allocate. The blocks read from the
+         * file go through `buffer`, unless the selection is a single block of contiguous
+         * columns, read straight into the data.
+         */
+        void getInto(DataFrame<KeyType>& data_frame,
+                     ReportReadBuffer& buffer,
+                     const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
+                     const nonstd::optional<double>& tstart = nonstd::nullopt,
+                     const nonstd::optional<double>& tstop = nonstd::nullopt,
+                     const nonstd::optional<size_t>& tstride = nonstd::nullopt,
+                     const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt,
+                     const nonstd::optional<size_t>& max_read_size = nonstd::nullopt) const;
+
+        /**
+         * Same as `getInto`, reading only the values, into the `n_frames` rows of `n_ids`
+         * values of `data`, laid out as data[times][ids]: the ids are those of
+         * `getNodeIdElementIdMapping`, and the times those of the timesteps from tstart.
+         *
+         * Return the number of timesteps read. Throws if `n_ids` isn't the number of ids of
+         * the selection, or `n_frames` is less than the number of timesteps.
+         */
+        size_t getInto(float* data,
+                       size_t n_frames,
+                       size_t n_ids,
+                       ReportReadBuffer& buffer,
+                       const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
+                       const nonstd::optional<double>& tstart = nonstd::nullopt,
+                       const nonstd::optional<double>& tstop = nonstd::nullopt,
+                       const nonstd::optional<size_t>& tstride = nonstd::nullopt,
+                       const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt,
+                       const nonstd::optional<size_t>& max_read_size = nonstd::nullopt) const;
+
+        /**
+         * Same as `get`, for the compartments of `compartment_set`, which must be of this
+         * population: the DataFrame has a column per compartment location, in the order of the
+         * set. Each location is resolved to a column of its node whose element id is its
+         * section, the n columns of a section splitting it evenly from offset 0 to 1.
+         *
+         * Only the columns of the locations are read, in {min,max} blocks as for `get`. Throws
+         * if the set is of another population, or a node or section of the set is not in the
+         * report.
+         */
+        DataFrame<KeyType> getCompartmentSet(
+            const CompartmentSet& compartment_set,
+            const nonstd::optional<double>& tstart = nonstd::nullopt,
+            const nonstd::optional<double>& tstop = nonstd::nullopt,
+            const nonstd::optional<size_t>& tstride = nonstd::nullopt,
+            const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt,
+            const nonstd::optional<size_t>& max_read_size = nonstd::nullopt) const;
+
+        /**
+         * Same as `get`, with the values of the elements of each node reduced to a single one
+         * per timestep with `reduction`: the ids of the DataFrame are the node ids, nodes
+         * without elements being left out.
+         *
+         * The timesteps are read and reduced a block at a time, so that the values of all the
+         * elements are never held in memory.
+         */
+        DataFrame<NodeID> getReducedByNode(
+            const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
+            const nonstd::optional<double>& tstart = nonstd::nullopt,
+            const nonstd::optional<double>& tstop = nonstd::nullopt,
+            ReportReduction reduction = ReportReduction::mean,
+            const nonstd::optional<size_t>& tstride = nonstd::nullopt,
             const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt) const;
 
+        /**
+         * Same as `get`, with the values of each element reduced with `reduction` over
+         * windows of `window` consecutive timesteps (after `tstride`), the last one possibly
+         * shorter. The times of the DataFrame are those of the first timestep of each window.
+         *
+         * The timesteps are read and reduced a block at a time, as for `getReducedByNode`.
+         */
+        DataFrame<KeyType> getReducedByWindow(
+            size_t window,
+            const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
+            const nonstd::optional<double>& tstart = nonstd::nullopt,
+            const nonstd::optional<double>& tstop = nonstd::nullopt,
+            ReportReduction reduction = ReportReduction::mean,
+            const nonstd::optional<size_t>& tstride = nonstd::nullopt,
+            const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt) const;
+
+        /**
+         * Return the min, max and mean of each element over windows of timesteps between tstart
+         * and tstop, for an overview of the report at the time resolution `resolution`.
+         *
+         * The windows are those of the coarsest level of the summary pyramid whose windows
+         * last at most `resolution`, so that long time ranges are summarized from a few
+         * values; the first and last windows may extend beyond tstart and tstop. Without such
+         * a level, the values of each timestep are returned, as min, max and mean alike.
+         */
+        ReportSummary<KeyType> getSummary(
+            double resolution,
+            const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
+            const nonstd::optional<double>& tstart = nonstd::nullopt,
+            const nonstd::optional<double>& tstop = nonstd::nullopt,
+            const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt) const;
+
+        /**
+         * Iterate over the report in time order, returning DataFrames of at most
+         * `frames_per_chunk` timesteps each, so that the memory used does not depend on the
+         * length of the simulation. The layout of the selected nodes is computed only once.
+         * The iterator holds its own copy of the population, so it may outlive the reader.
+         *
+         * \param node_ids limit the report to the given selection.
+         * \param tstart return voltages occurring on or after tstart. tstart=nonstd::nullopt
+         * indicates no limit.
+         * \param tstop return voltages occurring on or before tstop. tstop=nonstd::nullopt
+         * indicates no limit.
+         * \param frames_per_chunk maximum number of timesteps per DataFrame.
+         * frames_per_chunk=nonstd::nullopt uses as many as fit in 64MB (at least one).
+         * \param tstride indicates every how many timesteps we read data.
+         * tstride=nonstd::nullopt indicates that all timesteps are read.
+         * \param block_gap_limit gap limit between each IO block while fetching data from storage.
+         * \param prefetch number of DataFrames read ahead by a background thread while the
+         * previous ones are consumed, so that reading and consuming overlap. 0 reads each
+         * DataFrame when it is requested. The reads of the background thread are serialized
+         * with those of the other threads by the lock of the library on HDF5.
+         */
+        FrameIterator iterate(
+            const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
+            const nonstd::optional<double>& tstart = nonstd::nullopt,
+            const nonstd::optional<double>& tstop = nonstd::nullopt,
+            const nonstd::optional<size_t>& frames_per_chunk = nonstd::nullopt,
+            const nonstd::optional<size_t>& tstride = nonstd::nullopt,
+            const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt,
+            size_t prefetch = 0) const;
+
       private:
         struct NodeIdElementLayout {
             typename DataFrame<KeyType>::DataType ids;
@@ -184,38 +563,202 @@ class SONATA_API ReportReader
             std::vector<uint64_t> node_index;
             Selection::Ranges min_max_blocks;
         };
+        class LayoutCache;
+        class NodeMapping;
 
-        Population(const HighFive::File& file, const std::string& populationName);
+        /**
+         * Open the population `populationName` of `file`, reading only its times, units and
+         * attributes: the mapping of its nodes is read on first use, see `getNodeMapping`.
+         */
+        Population(const HighFive::File& file,
+                   const std::string& populationName,
+                   size_t n_threads);
         std::pair<size_t, size_t> getIndex(const nonstd::optional<double>& tstart,
                                            const nonstd::optional<double>& tstop) const;
+
+        /**
+         * Return the time of the timestep `index`.
+         */
+        double getTime(size_t index) const;
+
+        /**
+         * Return the node ids of the mapping, with the range of the columns of each node and
+         * their index sorted by node id, reading them on first use.
+         *
+         * The index is read from 'mapping/node_index' when written by
+         * `ReportWriter::writeNodeIndex`, instead of sorting the node ids, unless they are
+         * sorted in the file.
+         */
+        const NodeMapping& getNodeMapping() const;
         /**
          * Return the element IDs for the given selection, alongside the filtered node pointers
          * and the range of positions where they fit in the file. This latter two are necessary
          * for performance to understand how and where to retrieve the data from storage.
          *
+         * Recently used layouts are cached, so that repeated queries over the same selection
+         * don't read 'mapping/element_ids' again.
+         *
          * \param node_ids limit the report to the given selection. If nullptr, all nodes in the
          * report are used
          * \param block_gap_limit gap limit between each IO block while fetching data from storage
          */
-        NodeIdElementLayout getNodeIdElementLayout(
+        std::shared_ptr<const NodeIdElementLayout> getNodeIdElementLayout(
             const nonstd::optional<Selection>& node_ids = nonstd::nullopt,
             const nonstd::optional<size_t>& block_gap_limit = nonstd::nullopt) const;
 
+        /**
+         * Compute the layout returned by `getNodeIdElementLayout`, bypassing the cache.
+         */
+        NodeIdElementLayout computeNodeIdElementLayout(const nonstd::optional<Selection>& node_ids,
+                                                       size_t block_gap_limit) const;
+
+        /**
+         * Compute the layout of the columns of the locations of `compartment_set`, see
+         * `getCompartmentSet`. Consecutive columns of consecutive locations share a range.
+         */
+        NodeIdElementLayout computeCompartmentSetLayout(
+            const CompartmentSet& compartment_set,
+            const nonstd::optional<size_t>& block_gap_limit) const;
+
+        /**
+         * Read the timesteps [index_start, index_stop] with the given stride into `out`, laid
+         * out as data[times][ids] according to `layout`.
+         *
+         * Each {min,max} block is fetched in 2D tiles spanning several timesteps, so that the
+         * number of reads from storage does not grow with the number of timesteps. The tiles
+         * are read into `buffer`, reused between tiles and calls, unless their columns are
+         * those of `out`. Values stored as float16 or int16 are decoded as they are copied.
+         */
+        void readFrames(const NodeIdElementLayout& layout,
+                        size_t index_start,
+                        size_t index_stop,
+                        size_t stride,
+                        size_t max_read_size,
+                        float* out,
+                        ReportReadBuffer& buffer) const;
+
+        /**
+         * Same as `readFrames`, for a contiguous 'data' dataset of `n_cols` columns stored at
+         * byte `offset` of `filename`: the tiles are read directly from the file, concurrently
+         * by `n_threads_` threads.
+         */
+        void readFramesParallel(const NodeIdElementLayout& layout,
+                                size_t index_start,
+                                size_t index_stop,
+                                size_t stride,
+                                size_t max_read_size,
+                                const std::string& filename,
+                                uint64_t offset,
+                                size_t n_cols,
+                                float* out) const;
+
+        /**
+         * Same as `readFrames`, from 'data_transposed': the elements of consecutive nodes are
+         * read together, as many timesteps at a time as fit in `max_read_size`.
+         */
+        void readFramesTransposed(const NodeIdElementLayout& layout,
+                                  size_t index_start,
+                                  size_t index_stop,
+                                  size_t stride,
+                                  size_t max_read_size,
+                                  float* out,
+                                  ReportReadBuffer& buffer) const;
+
+        /**
+         * Return true if reading the timesteps [index_start, index_stop] of `layout` from
+         * 'data_transposed' is estimated to be cheaper than from 'data'.
+         */
+        bool preferTransposedData(const NodeIdElementLayout& layout,
+                                  size_t index_start,
+                                  size_t index_stop,
+                                  size_t stride) const;
+
+        /**
+         * Fill the times and data of `data_frame` for the timesteps [index_start, index_stop]
+         * with the given stride. The ids are left untouched.
+         */
+        void readDataFrame(const NodeIdElementLayout& layout,
+                           size_t index_start,
+                           size_t index_stop,
+                           size_t stride,
+                           size_t max_read_size,
+                           DataFrame<KeyType>& data_frame,
+                           ReportReadBuffer& buffer) const;
+
         HighFive::Group pop_group_;
-        std::vector<NodeID> node_ids_;
-        std::vector<Selection::Range> node_ranges_;
-        std::vector<uint64_t> node_offsets_;
-        std::vector<uint64_t> node_index_;
+        std::string population_name_;
         double tstart_, tstop_, tstep_;
-        std::vector<std::pair<size_t, double>> times_index_;
+        size_t n_times_ = 0;
         std::string time_units_;
         std::string data_units_;
         bool is_node_ids_sorted_;
+        bool has_transposed_data_ = false;
+        std::vector<size_t> summary_windows_;
+        size_t n_threads_;
+        // Shared between the copies of the Population, which read the same file
+        std::shared_ptr<NodeMapping> node_mapping_;
+        std::shared_ptr<LayoutCache> layout_cache_;
 
         friend ReportReader;
+
+      public:
+        /**
+         * Iterator over consecutive DataFrames of a report, see `Population::iterate`.
+         */
+        class FrameIterator
+        {
+          public:
+            FrameIterator(FrameIterator&&) noexcept;
+            FrameIterator& operator=(FrameIterator&&) noexcept;
+            /**
+             * Stop the background thread, if prefetching, dropping the prefetched DataFrames.
+             */
+            ~FrameIterator();
+
+            /**
+             * Return true if there are timesteps left.
+             */
+            bool hasNext() const;
+
+            /**
+             * Return the DataFrame of the next (at most `frames_per_chunk`) timesteps.
+             *
+             * When prefetching, wait for it to be read by the background thread, rethrowing
+             * its error if it failed.
+             */
+            DataFrame<KeyType> next();
+
+          private:
+            class Prefetcher;
+
+            FrameIterator(std::shared_ptr<const Population> population,
+                          std::shared_ptr<const NodeIdElementLayout> layout,
+                          size_t index_start,
+                          size_t index_stop,
+                          size_t stride,
+                          size_t frames_per_chunk,
+                          size_t prefetch);
+
+            // A copy shared with the background thread, outliving the reader it was opened by
+            std::shared_ptr<const Population> population_;
+            std::shared_ptr<const NodeIdElementLayout> layout_;
+            size_t index_next_, index_stop_, stride_, frames_per_chunk_;
+            ReportReadBuffer buffer_;
+            // Reads the next DataFrames in the background, if prefetching
+            std::unique_ptr<Prefetcher> prefetcher_;
+
+            friend Population;
+        };
     };
 
-    explicit ReportReader(const std::string& filename);
+    /**
+     * Open the report `filename`.
+     *
+     * \param n_threads number of threads used to read the data of each query. Reports stored
+     * contiguously, i.e. neither chunked nor compressed, are then read directly from the file,
+     * concurrently by `n_threads` threads; other reports are read as with a single thread.
+     */
+    explicit ReportReader(const std::string& filename, size_t n_threads = 1);
 
     /**
      * Return a list of all population names.
@@ -226,6 +769,7 @@ class SONATA_API ReportReader
 
   private:
     HighFive::File file_;
+    size_t n_threads_;
 
     // Lazy loaded population
     mutable std::map<std::string, Population> populations_;
@@ -234,5 +778,198 @@ class SONATA_API ReportReader
 using SomaReportReader = ReportReader<NodeID>;
 using ElementReportReader = ReportReader<CompartmentID>;
 
+/// Used to write soma and element reports, streaming their frames in
+class SONATA_API ReportWriter
+{
+  public:
+    /**
+     * Shape of the chunks of the 'data' dataset, whose rows are frames and columns elements.
+     *
+     * - contiguous: not chunked, the fastest to read whole frames and the only layout read
+     *   directly from the file by several threads; it can't be compressed.
+     * - time_major: chunks span all the elements of a few frames, for readers of all (or most)
+     *   of the nodes over short time windows.
+     * - element_major: chunks span all the frames of a few elements, for readers of the whole
+     *   trace of a few nodes.
+     * - balanced: square chunks, for mixed access patterns.
+     *
+     * The frames of a row of chunks are buffered until it is complete: chunks span fewer frames
+     * than their shape asks for if their row would take more than 64MB of frames.
+     */
+    enum class ChunkShape { contiguous, time_major, element_major, balanced };
+
+    class SONATA_API Population
+    {
+      public:
+        /**
+         * Return the number of frames of the population.
+         */
+        size_t getFrameCount() const;
+
+        /**
+         * Return the number of frames written so far, buffered ones included.
+         */
+        size_t getWrittenFrameCount() const;
+
+        /**
+         * Return the number of elements of each frame.
+         */
+        size_t getElementCount() const;
+
+        /**
+         * Append `n_frames` frames of `getElementCount()` values each, stored row-major in
+         * `data`.
+         */
+        void writeFrames(const float* data, size_t n_frames);
+
+        /**
+         * Same as above, for frames stored row-major in `data`, whose size must be a multiple of
+         * `getElementCount()`.
+         */
+        void writeFrames(const std::vector<float>& data);
+
+      private:
+        Population(HighFive::DataSet data,
+                   size_t n_frames,
+                   size_t n_elements,
+                   size_t frames_per_chunk,
+                   ReportEncoding encoding,
+                   float scale_factor,
+                   float add_offset);
+
+        // Write the buffered frames to the file
+        void flush();
+
+        // Write `n_rows` frames to the rows of 'data' from `row`, encoded
+        void writeRows(const float* data, size_t row, size_t n_rows);
+
+        HighFive::DataSet data_;
+        size_t n_frames_;
+        size_t n_elements_;
+        // Frames are written to the file a row of chunks at a time
+        size_t frames_per_chunk_;
+        size_t n_written_ = 0;
+        std::vector<float> buffer_;
+        size_t n_buffered_ = 0;
+        ReportEncoding encoding_;
+        float scale_factor_, add_offset_;
+        std::vector<int16_t> encoded_;
+
+        friend ReportWriter;
+    };
+
+    /**
+     * Create the report `filename`, overwriting it if it exists.
+     */
+    explicit ReportWriter(const std::string& filename);
+    ReportWriter(ReportWriter&&) noexcept;
+    ReportWriter& operator=(ReportWriter&&) noexcept;
+
+    /**
+     * Write the buffered frames, errors being ignored; see `close`.
+     */
+    ~ReportWriter();
+
+    /**
+     * Add a population, writing its mapping and laying out its data.
+     *
+     * The columns of the report are given by `node_ids` and `element_ids`, where the columns of
+     * a node must be contiguous; the mapping is flagged 'sorted' if the nodes are increasing.
+     * Frames are those of the reader for `times` = (tstart, tstop, tstep).
+     *
+     * \param chunkShape shape of the chunks of the 'data' dataset, see `ChunkShape`.
+     * \param chunkSize number of values per chunk.
+     * \param compressionLevel deflate level of the chunks, not compressed if 0.
+     * \param encoding type of the values of 'data', see `ReportEncoding`: the frames are
+     * converted as they are written, rounding to the nearest value.
+     * \param scaleFactor for int16, the values are stored as (value - addOffset) / scaleFactor,
+     * clamped to the range of int16.
+     * \param addOffset for int16, see `scaleFactor`.
+     */
+    Population& addPopulation(const std::string& populationName,
+                              const std::vector<NodeID>& node_ids,
+                              const std::vector<ElementID>& element_ids,
+                              const std::tuple<double, double, double>& times,
+                              const std::string& timeUnits = "ms",
+                              const std::string& dataUnits = "mV",
+                              ChunkShape chunkShape = ChunkShape::balanced,
+                              size_t chunkSize = 262144,
+                              unsigned compressionLevel = 0,
+                              ReportEncoding encoding = ReportEncoding::float32,
+                              float scaleFactor = 1.f,
+                              float addOffset = 0.f);
+
+    /**
+     * Return a population added with `addPopulation`.
+     */
+    Population& getPopulation(const std::string& populationName);
+
+    /**
+     * Write 'data_transposed' next to the 'data' of a population of the report `filename`: a
+     * copy of the data stored as data[element][time], in chunks of `elementsPerChunk` elements
+     * by `framesPerChunk` frames, picked up by `ReportReader` for per-trace queries.
+     *
+     * The data is copied in tiles of whole chunks, so that memory use doesn't depend on the
+     * size of the report. Values stored as float16 or int16 are copied decoded, as float32.
+     *
+     * The copy records a fingerprint of 'data', and is ignored by readers once it differs: the
+     * random 'generation' attribute set by `addPopulation` (and here if missing), the dimensions,
+     * the modification time of the dataset, if HDF5 tracks it, and a few of its values. Writes
+     * in place keep the generation, and HDF5 doesn't update the modification time on writes of
+     * values, so only those changing the sampled values are detected: programs rewriting 'data'
+     * in place should give it a new generation, or write the copy again.
+     *
+     * \param compressionLevel deflate level of the chunks, not compressed if 0.
+     * \param overwrite replaces existing transposed data, instead of throwing
+     */
+    static void writeTransposedData(const std::string& filename,
+                                    const std::string& populationName,
+                                    size_t elementsPerChunk = 64,
+                                    size_t framesPerChunk = 1024,
+                                    unsigned compressionLevel = 0,
+                                    bool overwrite = false);
+
+    /**
+     * Write 'mapping/node_index' to a population of the report `filename`: the positions of
+     * its node ids in 'mapping/node_ids', sorted by node id. `ReportReader` then reads it
+     * instead of sorting the node ids when they aren't sorted in the file.
+     *
+     * Populations added by `addPopulation` with unsorted node ids already have one.
+     *
+     * \param overwrite replaces an existing index, instead of throwing
+     */
+    static void writeNodeIndex(const std::string& filename,
+                               const std::string& populationName,
+                               bool overwrite = false);
+
+    /**
+     * Write a summary pyramid next to the 'data' of a population of the report `filename`,
+     * read by `ReportReader::Population::getSummary`: level k holds the min, max and mean of
+     * each element over windows of 2^k timesteps, up to a single window.
+     *
+     * Each level is computed from the previous one, a block of rows at a time, so that the
+     * data is read once and memory use doesn't depend on the size of the report. As with
+     * `writeTransposedData`, the pyramid is ignored once the fingerprint of 'data' changes.
+     *
+     * \param compressionLevel deflate level of the chunks, not compressed if 0.
+     * \param overwrite replaces an existing summary pyramid, instead of throwing
+     */
+    static void writeSummaryPyramid(const std::string& filename,
+                                    const std::string& populationName,
+                                    unsigned compressionLevel = 0,
+                                    bool overwrite = false);
+
+    /**
+     * Write the buffered frames and close the file.
+     *
+     * Throws if the frames of a population were not all written.
+     */
+    void close();
+
+  private:
+    std::unique_ptr<HighFive::File> file_;
+    std::map<std::string, Population> populations_;
+};
+
 }  // namespace sonata
 }  // namespace bbp
@@ -58,6 +58,73 @@ py::array asArray(std::vector<std::string>&& values) {
 }
 
 
+// Return `(offsets, ranges)`, with the `[start, end)` edge ranges as a (N, 2) array
+py::tuple asOffsetsAndRanges(EdgesPerNode&& edges) {
+    auto ptr = new Selection::Ranges(std::move(edges.ranges));
+    const std::array<size_t, 2> dims{ptr->size(), 2};
+    return py::make_tuple(asArray(std::move(edges.offsets)),
+                          py::array(dims,
+                                    reinterpret_cast<const Selection::Value*>(ptr->data()),
+                                    freeWhenDone(ptr)));
+}
+
+
+// Return the spike sorting named `sorting`
+SpikeReader::Population::Sorting spikeSorting(const std::string& sorting) {
+    if (sorting == "by_id") {
+        return SpikeReader::Population::Sorting::by_id;
+    } else if (sorting == "by_time") {
+        return SpikeReader::Population::Sorting::by_time;
+    } else if (sorting == "none") {
+        return SpikeReader::Population::Sorting::none;
+    }
+    throw SonataError(fmt::format("Invalid sorting: '{}'", sorting));
+}
+
+
+// Return the report chunk shape named `shape`
+ReportWriter::ChunkShape reportChunkShape(const std::string& shape) {
+    if (shape == "contiguous") {
+        return ReportWriter::ChunkShape::contiguous;
+    } else if (shape == "time_major") {
+        return ReportWriter::ChunkShape::time_major;
+    } else if (shape == "element_major") {
+        return ReportWriter::ChunkShape::element_major;
+    } else if (shape == "balanced") {
+        return ReportWriter::ChunkShape::balanced;
+    }
+    throw SonataError(fmt::format("Invalid chunk shape: '{}'", shape));
+}
+
+
+// Return the report encoding named `encoding`
+ReportEncoding reportEncoding(const std::string& encoding) {
+    if (encoding == "float32") {
+        return ReportEncoding::float32;
+    } else if (encoding == "float16") {
+        return ReportEncoding::float16;
+    } else if (encoding == "int16") {
+        return ReportEncoding::int16;
+    }
+    throw SonataError(fmt::format("Invalid report encoding: '{}'", encoding));
+}
+
+
+// Return the report reduction named `reduction`
+ReportReduction reportReduction(const std::string& reduction) {
+    if (reduction == "sum") {
+        return ReportReduction::sum;
+    } else if (reduction == "mean") {
+        return ReportReduction::mean;
+    } else if (reduction == "min") {
+        return ReportReduction::min;
+    } else if (reduction == "max") {
+        return ReportReduction::max;
+    }
+    throw SonataError(fmt::format("Invalid reduction: '{}'", reduction));
+}
+
+
 // Return a new Numpy array with data owned by another python object
 // This avoids copies, and enables correct reference counting for memory keep-alive
 template <typename DATA_T, typename DIMS_T, typename OWNER_T>
@@ -84,6 +151,23 @@ py::object getAttributeVector(const Population& obj,
 }
 
 
+// The returned array is read-only and points into the mapping, which it keeps alive
+template <typename T>
+py::object getAttributeView(const Population& obj, const std::string& name) {
+    auto ptr = new MappedArray<T>(obj.getAttributeView<T>(name));
+    auto array = py::array(ptr->size(), ptr->data(), freeWhenDone(ptr));
+    array.attr("setflags")("write"_a = false);
+    return array;
+}
+
+
+template <>
+py::object getAttributeView<std::string>(const Population& /* obj */, const std::string& name) {
+    throw SonataError(
+        fmt::format("Attribute '{}' can't be memory-mapped: strings are not supported", name));
+}
+
+
 template <typename T>
 py::object getEnumerationVector(const Population& obj,
                                 const std::string& name,
@@ -241,6 +325,14 @@ py::class_<Population, std::shared_ptr<Population>> bindPopulationClass(py::modu
             "selection"_a,
             "default_value"_a,
             imbueElementName(DOC_POP(getAttribute)).c_str())
+        .def(
+            "get_attribute_view",
+            [](Population& obj, const std::string& name) {
+                const auto dtype = obj._attributeDataType(name);
+                DISPATCH_TYPE(dtype, getAttributeView, obj, name);
+            },
+            "name"_a,
+            DOC_POP(getAttributeView))
         .def_property_readonly("dynamics_attribute_names",
                                &Population::dynamicsAttributeNames,
                                DOC_POP(dynamicsAttributeNames))
@@ -374,6 +466,52 @@ void bindReportReader(py::module& m, const std::string& prefix) {
             return managedMemoryArray(dframe.times.data(), dframe.times.size(), dframe);
         });
 
+    // Like the DataFrame, the arrays are owned by the c++ object
+    using Summary = ReportSummary<KeyType>;
+    const auto summaryValues = [](const Summary& summary, const std::vector<float>& values) {
+        std::array<ssize_t, 2> dims{ssize_t(summary.times.size()), ssize_t(summary.ids.size())};
+        return managedMemoryArray(values.data(), dims, summary);
+    };
+    py::class_<Summary>(m, (prefix + "ReportSummary").c_str(), DOC(bbp, sonata, ReportSummary))
+        .def_readonly("window", &Summary::window)
+        .def_property_readonly("ids",
+                               [](const Summary& summary) {
+                                   std::array<ssize_t, 1> dims{ssize_t(summary.ids.size())};
+                                   return managedMemoryArray(summary.ids.data(), dims, summary);
+                               })
+        .def_property_readonly("times",
+                               [](const Summary& summary) {
+                                   return managedMemoryArray(summary.times.data(),
+                                                             summary.times.size(),
+                                                             summary);
+                               })
+        .def_property_readonly("min",
+                               [summaryValues](const Summary& summary) {
+                                   return summaryValues(summary, summary.min);
+                               })
+        .def_property_readonly("max",
+                               [summaryValues](const Summary& summary) {
+                                   return summaryValues(summary, summary.max);
+                               })
+        .def_property_readonly("mean", [summaryValues](const Summary& summary) {
+            return summaryValues(summary, summary.mean);
+        });
+
+    using FrameIterator = typename ReportType::Population::FrameIterator;
+    py::class_<FrameIterator>(m,
+                              (prefix + "FrameIterator").c_str(),
+                              DOC_REPORTREADER_POP(FrameIterator))
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", [](FrameIterator& iterator) {
+            if (!iterator.hasNext()) {
+                throw py::stop_iteration();
+            }
+            // Other Python threads run while the frames are read, or waited for: the reads of
+            // the report take the HDF5 lock, serializing them with those of these threads
+            py::gil_scoped_release release;
+            return iterator.next();
+        });
+
     py::class_<typename ReportType::Population>(m,
                                                 (prefix + "ReportPopulation").c_str(),
                                                 "A population inside a ReportReader")
@@ -385,7 +523,116 @@ void bindReportReader(py::module& m, const std::string& prefix) {
              "tstart"_a = nonstd::nullopt,
              "tstop"_a = nonstd::nullopt,
              "tstride"_a = nonstd::nullopt,
+             "block_gap_limit"_a = nonstd::nullopt,
+             "max_read_size"_a = nonstd::nullopt)
+        .def(
+            "get_into",
+            [](const typename ReportType::Population& population,
+               py::array_t<float, py::array::c_style> out,
+               const nonstd::optional<Selection>& node_ids,
+               const nonstd::optional<double>& tstart,
+               const nonstd::optional<double>& tstop,
+               const nonstd::optional<size_t>& tstride,
+               const nonstd::optional<size_t>& block_gap_limit,
+               const nonstd::optional<size_t>& max_read_size,
+               ReportReadBuffer* buffer) {
+                if (out.ndim() != 2) {
+                    throw SonataError("'out' should have 2 dimensions");
+                }
+                ReportReadBuffer call_buffer;
+                return population.getInto(out.mutable_data(),
+                                          out.shape(0),
+                                          out.shape(1),
+                                          buffer ? *buffer : call_buffer,
+                                          node_ids,
+                                          tstart,
+                                          tstop,
+                                          tstride,
+                                          block_gap_limit,
+                                          max_read_size);
+            },
+            DOC_REPORTREADER_POP(getInto_2),
+            py::arg("out").noconvert(true),
+            "node_ids"_a = nonstd::nullopt,
+            "tstart"_a = nonstd::nullopt,
+            "tstop"_a = nonstd::nullopt,
+            "tstride"_a = nonstd::nullopt,
+            "block_gap_limit"_a = nonstd::nullopt,
+            "max_read_size"_a = nonstd::nullopt,
+            "buffer"_a = nullptr)
+        .def("get_compartment_set",
+             &ReportType::Population::getCompartmentSet,
+             DOC_REPORTREADER_POP(getCompartmentSet),
+             "compartment_set"_a,
+             "tstart"_a = nonstd::nullopt,
+             "tstop"_a = nonstd::nullopt,
+             "tstride"_a = nonstd::nullopt,
+             "block_gap_limit"_a = nonstd::nullopt,
+             "max_read_size"_a = nonstd::nullopt)
+        .def(
+            "get_reduced_by_node",
+            [](const typename ReportType::Population& population,
+               const nonstd::optional<Selection>& node_ids,
+               const nonstd::optional<double>& tstart,
+               const nonstd::optional<double>& tstop,
+               const std::string& reduction,
+               const nonstd::optional<size_t>& tstride,
+               const nonstd::optional<size_t>& block_gap_limit) {
+                return population.getReducedByNode(
+                    node_ids, tstart, tstop, reportReduction(reduction), tstride, block_gap_limit);
+            },
+            DOC_REPORTREADER_POP(getReducedByNode),
+            "node_ids"_a = nonstd::nullopt,
+            "tstart"_a = nonstd::nullopt,
+            "tstop"_a = nonstd::nullopt,
+            "reduction"_a = "mean",
+            "tstride"_a = nonstd::nullopt,
+            "block_gap_limit"_a = nonstd::nullopt)
+        .def(
+            "get_reduced_by_window",
+            [](const typename ReportType::Population& population,
+               size_t window,
+               const nonstd::optional<Selection>& node_ids,
+               const nonstd::optional<double>& tstart,
+               const nonstd::optional<double>& tstop,
+               const std::string& reduction,
+               const nonstd::optional<size_t>& tstride,
+               const nonstd::optional<size_t>& block_gap_limit) {
+                return population.getReducedByWindow(window,
+                                                     node_ids,
+                                                     tstart,
+                                                     tstop,
+                                                     reportReduction(reduction),
+                                                     tstride,
+                                                     block_gap_limit);
+            },
+            DOC_REPORTREADER_POP(getReducedByWindow),
+            "window"_a,
+            "node_ids"_a = nonstd::nullopt,
+            "tstart"_a = nonstd::nullopt,
+            "tstop"_a = nonstd::nullopt,
+            "reduction"_a = "mean",
+            "tstride"_a = nonstd::nullopt,
+            "block_gap_limit"_a = nonstd::nullopt)
+        .def("get_summary",
+             &ReportType::Population::getSummary,
+             DOC_REPORTREADER_POP(getSummary),
+             "resolution"_a,
+             "node_ids"_a = nonstd::nullopt,
+             "tstart"_a = nonstd::nullopt,
+             "tstop"_a = nonstd::nullopt,
              "block_gap_limit"_a = nonstd::nullopt)
+        .def("iterate",
+             &ReportType::Population::iterate,
+             DOC_REPORTREADER_POP(iterate),
+             "node_ids"_a = nonstd::nullopt,
+             "tstart"_a = nonstd::nullopt,
+             "tstop"_a = nonstd::nullopt,
+             "frames_per_chunk"_a = nonstd::nullopt,
+             "tstride"_a = nonstd::nullopt,
+             "block_gap_limit"_a = nonstd::nullopt,
+             "prefetch"_a = 0,
+             py::keep_alive<0, 1>())
         .def("get_node_ids",
              &ReportType::Population::getNodeIds,
              "Return the list of nodes ids for this population")
@@ -402,6 +649,12 @@ void bindReportReader(py::module& m, const std::string& prefix) {
         .def_property_readonly("sorted",
                                &ReportType::Population::getSorted,
                                DOC_REPORTREADER_POP(getSorted))
+        .def_property_readonly("has_transposed_data",
+                               &ReportType::Population::hasTransposedData,
+                               DOC_REPORTREADER_POP(hasTransposedData))
+        .def_property_readonly("summary_windows",
+                               &ReportType::Population::getSummaryWindows,
+                               DOC_REPORTREADER_POP(getSummaryWindows))
         .def_property_readonly("times",
                                &ReportType::Population::getTimes,
                                DOC_REPORTREADER_POP(getTimes))
@@ -412,15 +665,25 @@ void bindReportReader(py::module& m, const std::string& prefix) {
                                &ReportType::Population::getDataUnits,
                                DOC_REPORTREADER_POP(getDataUnits));
     py::class_<ReportType>(m, (prefix + "ReportReader").c_str(), "Used to read somas files")
-        .def(py::init([](py::object h5_filepath) { return ReportType(py::str(h5_filepath)); }),
-             "h5_filepath"_a)
+        .def(py::init([](py::object h5_filepath, size_t n_threads) {
+                 return ReportType(py::str(h5_filepath), n_threads);
+             }),
+             "h5_filepath"_a,
+             "n_threads"_a = 1)
         .def("get_population_names", &ReportType::getPopulationNames, "Get list of all populations")
         .def("__getitem__", &ReportType::openPopulation);
 }
 
 
 PYBIND11_MODULE(_libsonata, m) {
-    py::class_<Hdf5Reader>(m, "Hdf5Reader").def(py::init([]() { return Hdf5Reader(); }));
+    py::class_<Hdf5Reader>(m, "Hdf5Reader")
+        .def(py::init([]() { return Hdf5Reader(); }))
+        .def(py::init([](size_t n_threads) { return makeParallelHdf5Reader(n_threads); }),
+             DOC(bbp, sonata, makeParallelHdf5Reader),
+             "n_threads"_a)
+        .def_static("memory_mapped",
+                    &makeMappedHdf5Reader,
+                    DOC(bbp, sonata, makeMappedHdf5Reader));
 
     py::class_<Selection>(m,
                           "Selection",
@@ -1492,6 +1755,26 @@ PYBIND11_MODULE(_libsonata, m) {
             "source"_a,
             "target"_a,
             DOC_POP_EDGE(connectingEdges))
+        .def(
+            "afferent_edges_per_node",
+            [](EdgePopulation& obj, const std::vector<NodeID>& target) {
+                return asOffsetsAndRanges(obj.afferentEdgesPerNode(target));
+            },
+            "target"_a,
+            DOC_POP_EDGE(afferentEdgesPerNode))
+        .def(
+            "efferent_edges_per_node",
+            [](EdgePopulation& obj, const std::vector<NodeID>& source) {
+                return asOffsetsAndRanges(obj.efferentEdgesPerNode(source));
+            },
+            "source"_a,
+            DOC_POP_EDGE(efferentEdgesPerNode))
+        .def("preload_indices",
+             &EdgePopulation::preloadIndices,
+             DOC_POP_EDGE(preloadIndices))
+        .def_property_readonly("has_preloaded_indices",
+                               &EdgePopulation::hasPreloadedIndices,
+                               DOC_POP_EDGE(hasPreloadedIndices))
         .def_static("write_indices",
                     &EdgePopulation::writeIndices,
                     "h5_filepath"_a,
@@ -1499,6 +1782,7 @@ PYBIND11_MODULE(_libsonata, m) {
                     "source_node_count"_a,
                     "target_node_count"_a,
                     "overwrite"_a = false,
+                    "n_threads"_a = 1,
                     DOC_POP_EDGE(writeIndices));
 
     bindStorageClass<EdgeStorage>(m, "EdgeStorage", "EdgePopulation");
@@ -1516,27 +1800,85 @@ PYBIND11_MODULE(_libsonata, m) {
                const py::object& node_ids = py::none(),
                const py::object& tstart = py::none(),
                const py::object& tstop = py::none()) {
-                const SpikeTimes& spikes =
-                    (node_ids.is_none() && tstart.is_none() && tstop.is_none())
-                        ? self.getRawArrays()
-                        : self.getArrays(node_ids.is_none()
-                                             ? nonstd::nullopt
-                                             : node_ids.cast<nonstd::optional<Selection>>(),
-                                         tstart.is_none() ? nonstd::nullopt
-                                                          : tstart.cast<nonstd::optional<double>>(),
-                                         tstop.is_none() ? nonstd::nullopt
-                                                         : tstop.cast<nonstd::optional<double>>());
-
                 py::dict result;
-                result["node_ids"] = py::array_t<NodeID>(spikes.node_ids.size(),
-                                                         spikes.node_ids.data());
-                result["timestamps"] = py::array_t<double>(spikes.timestamps.size(),
-                                                           spikes.timestamps.data());
+                if (node_ids.is_none() && tstart.is_none() && tstop.is_none()) {
+                    // Read-only views of the arrays of the population, which they keep alive
+                    const SpikeTimes& spikes = self.getRawArrays();
+                    auto ids = managedMemoryArray(spikes.node_ids.data(),
+                                                  spikes.node_ids.size(),
+                                                  self);
+                    auto timestamps = managedMemoryArray(spikes.timestamps.data(),
+                                                         spikes.timestamps.size(),
+                                                         self);
+                    ids.attr("setflags")("write"_a = false);
+                    timestamps.attr("setflags")("write"_a = false);
+                    result["node_ids"] = ids;
+                    result["timestamps"] = timestamps;
+                    return result;
+                }
+
+                auto spikes = self.getArrays(
+                    node_ids.is_none() ? nonstd::nullopt
+                                       : node_ids.cast<nonstd::optional<Selection>>(),
+                    tstart.is_none() ? nonstd::nullopt : tstart.cast<nonstd::optional<double>>(),
+                    tstop.is_none() ? nonstd::nullopt : tstop.cast<nonstd::optional<double>>());
+                result["node_ids"] = asArray(std::move(spikes.node_ids));
+                result["timestamps"] = asArray(std::move(spikes.timestamps));
                 return result;
             },
             "node_ids"_a = nonstd::nullopt,
             "tstart"_a = nonstd::nullopt,
             "tstop"_a = nonstd::nullopt)
+        .def(
+            "binned_counts",
+            [](const SpikeReader::Population& self,
+               const nonstd::optional<Selection>& node_ids,
+               double tstart,
+               double tstop,
+               double bin_size,
+               size_t n_threads) {
+                return asArray(self.binnedCounts(node_ids, tstart, tstop, bin_size, n_threads));
+            },
+            "node_ids"_a,
+            "tstart"_a,
+            "tstop"_a,
+            "bin_size"_a,
+            "n_threads"_a = 1,
+            DOC_SPIKEREADER_POP(binnedCounts))
+        .def(
+            "firing_rates",
+            [](const SpikeReader::Population& self,
+               const Selection& node_ids,
+               const nonstd::optional<double>& tstart,
+               const nonstd::optional<double>& tstop,
+               size_t n_threads) {
+                return asArray(self.firingRates(node_ids, tstart, tstop, n_threads));
+            },
+            "node_ids"_a,
+            "tstart"_a = nonstd::nullopt,
+            "tstop"_a = nonstd::nullopt,
+            "n_threads"_a = 1,
+            DOC_SPIKEREADER_POP(firingRates))
+        .def(
+            "isi_stats",
+            [](const SpikeReader::Population& self,
+               const Selection& node_ids,
+               const nonstd::optional<double>& tstart,
+               const nonstd::optional<double>& tstop,
+               size_t n_threads) {
+                auto stats = self.isiStats(node_ids, tstart, tstop, n_threads);
+                py::dict result;
+                result["node_ids"] = asArray(std::move(stats.node_ids));
+                result["counts"] = asArray(std::move(stats.counts));
+                result["means"] = asArray(std::move(stats.means));
+                result["cvs"] = asArray(std::move(stats.cvs));
+                return result;
+            },
+            "node_ids"_a,
+            "tstart"_a = nonstd::nullopt,
+            "tstop"_a = nonstd::nullopt,
+            "n_threads"_a = 1,
+            DOC_SPIKEREADER_POP(isiStats))
         .def_property_readonly(
             "sorting",
             [](const SpikeReader::Population& self) {
@@ -1555,15 +1897,219 @@ PYBIND11_MODULE(_libsonata, m) {
                                &SpikeReader::Population::getTimeUnits,
                                DOC_REPORTREADER_POP(getTimeUnits));
     py::class_<SpikeReader>(m, "SpikeReader", DOC(bbp, sonata, SpikeReader))
-        .def(py::init([](py::object h5_filepath) { return SpikeReader(py::str(h5_filepath)); }),
-             "h5_filepath"_a)
+        .def(py::init([](py::object h5_filepath, bool lazy) {
+                 return SpikeReader(py::str(h5_filepath), lazy);
+             }),
+             "h5_filepath"_a,
+             "lazy"_a = false,
+             DOC(bbp, sonata, SpikeReader, SpikeReader, 2))
         .def("get_population_names",
              &SpikeReader::getPopulationNames,
              DOC_SPIKEREADER(getPopulationNames))
-        .def("__getitem__", &SpikeReader::openPopulation);
+        .def("__getitem__",
+             &SpikeReader::openPopulation,
+             py::return_value_policy::reference_internal);
+
+    py::class_<SpikeWriter>(m, "SpikeWriter", DOC(bbp, sonata, SpikeWriter))
+        .def(py::init([](py::object h5_filepath, size_t n_threads) {
+                 return std::unique_ptr<SpikeWriter>(
+                     new SpikeWriter(py::str(h5_filepath), n_threads));
+             }),
+             "h5_filepath"_a,
+             "n_threads"_a = 1,
+             DOC(bbp, sonata, SpikeWriter, SpikeWriter))
+        .def(
+            "add_population",
+            [](SpikeWriter& self,
+               const std::string& population,
+               const std::string& sorting,
+               const std::string& time_units) {
+                self.addPopulation(population, spikeSorting(sorting), time_units);
+            },
+            "population"_a,
+            "sorting"_a = "by_time",
+            "time_units"_a = "ms",
+            DOC(bbp, sonata, SpikeWriter, addPopulation))
+        .def("add_spikes",
+             &SpikeWriter::addSpikes,
+             "population"_a,
+             "node_ids"_a,
+             "timestamps"_a,
+             DOC(bbp, sonata, SpikeWriter, addSpikes))
+        .def("write",
+             &SpikeWriter::write,
+             "chunk_size"_a = 65536,
+             "compression_level"_a = 0,
+             DOC(bbp, sonata, SpikeWriter, write));
+
+    py::class_<MergedSpikeReader>(m, "MergedSpikeReader", DOC(bbp, sonata, MergedSpikeReader))
+        .def(py::init([](const std::vector<std::pair<py::object, std::string>>& sources,
+                         const std::string& sorting,
+                         size_t block_size) {
+                 std::vector<MergedSpikeReader::Source> paths;
+                 for (const auto& source : sources) {
+                     paths.emplace_back(py::str(source.first), source.second);
+                 }
+                 return std::unique_ptr<MergedSpikeReader>(
+                     new MergedSpikeReader(std::move(paths), spikeSorting(sorting), block_size));
+             }),
+             "sources"_a,
+             "sorting"_a = "by_time",
+             "block_size"_a = 65536,
+             DOC(bbp, sonata, MergedSpikeReader, MergedSpikeReader))
+        .def_property_readonly("sources",
+                               &MergedSpikeReader::getSources,
+                               DOC(bbp, sonata, MergedSpikeReader, getSources))
+        .def_property_readonly("done",
+                               &MergedSpikeReader::done,
+                               DOC(bbp, sonata, MergedSpikeReader, done))
+        .def(
+            "next",
+            [](MergedSpikeReader& self, size_t max_spikes) {
+                auto spikes = self.next(max_spikes);
+                py::dict result;
+                result["node_ids"] = asArray(std::move(spikes.node_ids));
+                result["timestamps"] = asArray(std::move(spikes.timestamps));
+                result["sources"] = asArray(std::move(spikes.sources));
+                return result;
+            },
+            "max_spikes"_a,
+            DOC(bbp, sonata, MergedSpikeReader, next))
+        .def("reset", &MergedSpikeReader::reset, DOC(bbp, sonata, MergedSpikeReader, reset));
+
+    py::class_<ReportReadBuffer>(m, "ReportReadBuffer", DOC(bbp, sonata, ReportReadBuffer))
+        .def(py::init<>());
 
     bindReportReader<SomaReportReader, NodeID>(m, "Soma");
     bindReportReader<ElementReportReader, CompartmentID>(m, "Element");
 
+    py::class_<ReportWriter::Population>(m,
+                                         "ReportWriterPopulation",
+                                         DOC(bbp, sonata, ReportWriter, Population))
+        .def(
+            "write_frames",
+            [](ReportWriter::Population& self,
+               py::array_t<float, py::array::c_style | py::array::forcecast> data) {
+                const size_t n_elements = self.getElementCount();
+                if (data.ndim() == 1 && static_cast<size_t>(data.size()) == n_elements) {
+                    self.writeFrames(data.data(), 1);
+                } else if (data.ndim() == 2 && static_cast<size_t>(data.shape(1)) == n_elements) {
+                    self.writeFrames(data.data(), data.shape(0));
+                } else {
+                    throw SonataError(fmt::format(
+                        "Frames must be an array of shape (n_frames, {})", n_elements));
+                }
+            },
+            "data"_a,
+            DOC(bbp, sonata, ReportWriter, Population, writeFrames))
+        .def_property_readonly("frame_count",
+                               &ReportWriter::Population::getFrameCount,
+                               DOC(bbp, sonata, ReportWriter, Population, getFrameCount))
+        .def_property_readonly("written_frame_count",
+                               &ReportWriter::Population::getWrittenFrameCount,
+                               DOC(bbp, sonata, ReportWriter, Population, getWrittenFrameCount))
+        .def_property_readonly("element_count",
+                               &ReportWriter::Population::getElementCount,
+                               DOC(bbp, sonata, ReportWriter, Population, getElementCount));
+
+    py::class_<ReportWriter>(m, "ReportWriter", DOC(bbp, sonata, ReportWriter))
+        .def(py::init([](py::object h5_filepath) {
+                 return std::unique_ptr<ReportWriter>(new ReportWriter(py::str(h5_filepath)));
+             }),
+             "h5_filepath"_a,
+             DOC(bbp, sonata, ReportWriter, ReportWriter))
+        .def(
+            "add_population",
+            [](ReportWriter& self,
+               const std::string& population,
+               const std::vector<NodeID>& node_ids,
+               const std::vector<ElementID>& element_ids,
+               const std::tuple<double, double, double>& times,
+               const std::string& time_units,
+               const std::string& data_units,
+               const std::string& chunk_shape,
+               size_t chunk_size,
+               unsigned compression_level,
+               const std::string& encoding,
+               float scale_factor,
+               float add_offset) -> ReportWriter::Population& {
+                return self.addPopulation(population,
+                                          node_ids,
+                                          element_ids,
+                                          times,
+                                          time_units,
+                                          data_units,
+                                          reportChunkShape(chunk_shape),
+                                          chunk_size,
+                                          compression_level,
+                                          reportEncoding(encoding),
+                                          scale_factor,
+                                          add_offset);
+            },
+            "population"_a,
+            "node_ids"_a,
+            "element_ids"_a,
+            "times"_a,
+            "time_units"_a = "ms",
+            "data_units"_a = "mV",
+            "chunk_shape"_a = "balanced",
+            "chunk_size"_a = 262144,
+            "compression_level"_a = 0,
+            "encoding"_a = "float32",
+            "scale_factor"_a = 1.0f,
+            "add_offset"_a = 0.0f,
+            py::return_value_policy::reference_internal,
+            DOC(bbp, sonata, ReportWriter, addPopulation))
+        .def("__getitem__",
+             &ReportWriter::getPopulation,
+             py::return_value_policy::reference_internal,
+             DOC(bbp, sonata, ReportWriter, getPopulation))
+        .def("close", &ReportWriter::close, DOC(bbp, sonata, ReportWriter, close))
+        .def_static(
+            "write_transposed_data",
+            [](py::object h5_filepath,
+               const std::string& population,
+               size_t elements_per_chunk,
+               size_t frames_per_chunk,
+               unsigned compression_level,
+               bool overwrite) {
+                ReportWriter::writeTransposedData(py::str(h5_filepath),
+                                                  population,
+                                                  elements_per_chunk,
+                                                  frames_per_chunk,
+                                                  compression_level,
+                                                  overwrite);
+            },
+            "h5_filepath"_a,
+            "population"_a,
+            "elements_per_chunk"_a = 64,
+            "frames_per_chunk"_a = 1024,
+            "compression_level"_a = 0,
+            "overwrite"_a = false,
+            DOC(bbp, sonata, ReportWriter, writeTransposedData))
+        .def_static(
+            "write_node_index",
+            [](py::object h5_filepath, const std::string& population, bool overwrite) {
+                ReportWriter::writeNodeIndex(py::str(h5_filepath), population, overwrite);
+            },
+            "h5_filepath"_a,
+            "population"_a,
+            "overwrite"_a = false,
+            DOC(bbp, sonata, ReportWriter, writeNodeIndex))
+        .def_static(
+            "write_summary_pyramid",
+            [](py::object h5_filepath,
+               const std::string& population,
+               unsigned compression_level,
+               bool overwrite) {
+                ReportWriter::writeSummaryPyramid(
+                    py::str(h5_filepath), population, compression_level, overwrite);
+            },
+            "h5_filepath"_a,
+            "population"_a,
+            "compression_level"_a = 0,
+            "overwrite"_a = false,
+            DOC(bbp, sonata, ReportWriter, writeSummaryPyramid));
+
     py::register_exception<SonataError>(m, "SonataError");
 }
@@ -349,10 +349,33 @@ static const char *__doc_bbp_sonata_EdgePopulation_EdgePopulation_2 = R"doc()doc
 
 static const char *__doc_bbp_sonata_EdgePopulation_afferentEdges = R"doc(Return inbound edges for given node IDs.)doc";
 
+static const char *__doc_bbp_sonata_EdgePopulation_afferentEdgesPerNode = R"doc(Return inbound edges of each of the given node IDs, in one call.)doc";
+
 static const char *__doc_bbp_sonata_EdgePopulation_connectingEdges = R"doc(Return edges connecting two given nodes.)doc";
 
 static const char *__doc_bbp_sonata_EdgePopulation_efferentEdges = R"doc(Return outbound edges for given node IDs.)doc";
 
+static const char *__doc_bbp_sonata_EdgePopulation_efferentEdgesPerNode = R"doc(Return outbound edges of each of the given node IDs, in one call.)doc";
+
+static const char *__doc_bbp_sonata_EdgePopulation_hasPreloadedIndices = R"doc(Whether the node->edge indices were loaded in memory by `preloadIndices`.)doc";
+
+static const char *__doc_bbp_sonata_EdgePopulation_preloadIndices =
+R"doc(Load the node->edge indices in memory.
+
+Afterwards, queries for afferent, efferent or connecting edges no
+longer read the file. The indices take 8 bytes per node and 16 bytes
+per range of edges, for both directions. They are loaded once and
+shared by all the populations which preload them from the same file,
+until the last of these populations is destroyed, or the indices are
+rewritten.
+
+Rewrites by `writeIndices` are always noticed. Other rewrites, e.g. by
+another process, are noticed by the modification time and size of the
+file, and the sizes of the indices: they are missed if the file system
+doesn't update its modification time.)doc";
+
+static const char *__doc_bbp_sonata_EdgePopulation_preloaded = R"doc()doc";
+
 static const char *__doc_bbp_sonata_EdgePopulation_source = R"doc(Name of source population extracted from 'source_node_id' dataset)doc";
 
 static const char *__doc_bbp_sonata_EdgePopulation_sourceNodeIDs = R"doc(Return source node IDs for a given edge selection)doc";
@@ -361,7 +384,31 @@ static const char *__doc_bbp_sonata_EdgePopulation_target = R"doc(Name of target
 
 static const char *__doc_bbp_sonata_EdgePopulation_targetNodeIDs = R"doc(Return target node IDs for a given edge selection)doc";
 
-static const char *__doc_bbp_sonata_EdgePopulation_writeIndices = R"doc(Write bidirectional node->edge indices to EdgePopulation HDF5.)doc";
+static const char *__doc_bbp_sonata_EdgePopulation_writeIndices =
+R"doc(Write bidirectional node->edge indices to EdgePopulation HDF5.
+
+The node IDs are streamed from the file in blocks, scanned by up to
+`n_threads` threads, so that memory use is bounded by the number of
+nodes rather than edges.
+
+Parameter ``overwrite``:
+    replaces existing indices, instead of throwing)doc";
+
+static const char *__doc_bbp_sonata_EdgesPerNode =
+R"doc(The edges of several nodes, as returned by
+`EdgePopulation::afferentEdgesPerNode` and
+`EdgePopulation::efferentEdgesPerNode`.
+
+The edges of the i-th node are the ranges
+`ranges[offsets[i]:offsets[i + 1]]`.)doc";
+
+static const char *__doc_bbp_sonata_EdgesPerNode_offsets = R"doc()doc";
+
+static const char *__doc_bbp_sonata_EdgesPerNode_operator_array = R"doc(Edges of the i-th node)doc";
+
+static const char *__doc_bbp_sonata_EdgesPerNode_ranges = R"doc()doc";
+
+static const char *__doc_bbp_sonata_EdgesPerNode_size = R"doc(Number of nodes)doc";
 
 static const char *__doc_bbp_sonata_Hdf5PluginInterface = R"doc()doc";
 
@@ -454,6 +501,111 @@ Both selections are canonical, i.e. sorted and non-overlapping. The
 dataset is obtained from a `HighFive::File` opened via
 `this->openFile`.)doc";
 
+static const char *__doc_bbp_sonata_makeMappedHdf5Reader =
+R"doc(Create an Hdf5Reader which reads from memory mappings of the files.
+
+Numeric datasets stored contiguously, i.e. neither chunked nor
+compressed, are copied straight out of the mapping of their file,
+which is kept open as long as the reader, or mapped anew if the file
+is replaced or modified. Other datasets are read as with the default
+`Hdf5Reader`.
+
+This reader is not MPI-collective.)doc";
+
+static const char *__doc_bbp_sonata_makeParallelHdf5Reader =
+R"doc(Create an Hdf5Reader which reads with `n_threads` threads.
+
+Numeric datasets stored contiguously, i.e. neither chunked nor
+compressed, are read directly from the file, splitting the selection
+across the threads. Other datasets are read as with the default
+`Hdf5Reader`. With `n_threads <= 1` this is the default `Hdf5Reader`.
+
+This reader is not MPI-collective.)doc";
+
+static const char *__doc_bbp_sonata_IsiStats = R"doc(Statistics of the inter-spike intervals of nodes)doc";
+
+static const char *__doc_bbp_sonata_IsiStats_counts = R"doc()doc";
+
+static const char *__doc_bbp_sonata_IsiStats_cvs = R"doc()doc";
+
+static const char *__doc_bbp_sonata_IsiStats_means = R"doc()doc";
+
+static const char *__doc_bbp_sonata_IsiStats_node_ids = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MappedArray =
+R"doc(Read-only array of values memory-mapped from a file, see
+`Population::getAttributeView`.
+
+Copies share the mapping, which is released when the last one is
+destroyed.)doc";
+
+static const char *__doc_bbp_sonata_MappedArray_MappedArray = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MappedArray_MappedArray_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MappedArray_begin = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MappedArray_data = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MappedArray_empty = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MappedArray_end = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MappedArray_operator_array = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MappedArray_size = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader =
+R"doc(Used to read the spikes of several populations, possibly in several
+files, as one sorted stream)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_Cursor = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_MergedSpikeReader =
+R"doc(Merge the spikes of `sources`, sorted 'by_time' or 'by_id' according
+to `sorting`.
+
+Spikes with the same sorting key are ordered as their sources, then as
+in their source. The sources sorted accordingly are read `blockSize`
+spikes at a time as they are merged, the others are loaded and sorted
+when opened.)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_MergedSpikeReader_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_after =
+R"doc(Does the next spike of cursor `lhs` come after the next spike of
+cursor `rhs`?)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_cursors = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_done = R"doc(Return true once all the spikes have been read.)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_getSources = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_heap =
+R"doc(Heap of the cursors with spikes left, whose next spike comes first at
+the top)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_next =
+R"doc(Return the next spikes, `maxSpikes` at most; none once all of them
+have been read.)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_operator_assign = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_reset = R"doc(Go back to the first spike.)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_sorting = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikeReader_sources = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikes = R"doc(Spikes of several populations and their population)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikes_node_ids = R"doc()doc";
+
+static const char *__doc_bbp_sonata_MergedSpikes_sources = R"doc(Index in the sources of the population of each spike)doc";
+
+static const char *__doc_bbp_sonata_MergedSpikes_timestamps = R"doc()doc";
+
 static const char *__doc_bbp_sonata_NodePopulation = R"doc()doc";
 
 static const char *__doc_bbp_sonata_NodePopulationProperties = R"doc(Node population-specific network information.)doc";
@@ -667,6 +819,23 @@ Parameter ``default``:
 Throws:
     if there is no such attribute for the population)doc";
 
+static const char *__doc_bbp_sonata_Population_getAttributeView =
+R"doc(Get a read-only view of all the values of an attribute, memory-mapped
+from the file without any copy.
+
+Only attributes stored contiguously (i.e. neither chunked nor
+compressed), with exactly the type `T` and aligned in the file can be
+viewed; use `getAttribute` for the others.
+
+Parameter ``name``:
+    is a string to allow attributes not defined in spec
+
+Throws:
+    if there is no such attribute for the population
+
+Throws:
+    if the attribute can't be memory-mapped)doc";
+
 static const char *__doc_bbp_sonata_Population_getDynamicsAttribute =
 R"doc(Get dynamics attribute values for given {element} Selection
 
@@ -725,10 +894,127 @@ static const char *__doc_bbp_sonata_Population_selectAll = R"doc(Selection cover
 
 static const char *__doc_bbp_sonata_Population_size = R"doc(Total number of elements)doc";
 
+static const char *__doc_bbp_sonata_ReportReadBuffer =
+R"doc(Scratch space for the blocks read by
+`ReportReader::Population::getInto`, kept between calls so that
+polling the same selection doesn't allocate it again)doc";
+
+static const char *__doc_bbp_sonata_ReportReadBuffer_encoded =
+R"doc(The values read from 'data' stored as float16 or int16, before they
+are decoded)doc";
+
+static const char *__doc_bbp_sonata_ReportReadBuffer_values = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportEncoding =
+R"doc(Type of the values of the 'data' dataset of a report, decoded to
+float32 when read.
+
+- float32: the values as is. - float16: IEEE 754 half precision
+floats, accurate to about 3 decimal digits. - int16: integers v
+standing for v * scale_factor + add_offset, given by the attributes of
+the dataset of the same names (1 and 0 if missing).)doc";
+
+static const char *__doc_bbp_sonata_ReportEncoding_float16 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportEncoding_float32 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportEncoding_int16 = R"doc()doc";
+
 static const char *__doc_bbp_sonata_ReportReader = R"doc()doc";
 
+static const char *__doc_bbp_sonata_ReportReader_n_threads = R"doc()doc";
+
 static const char *__doc_bbp_sonata_ReportReader_Population = R"doc()doc";
 
+static const char *__doc_bbp_sonata_ReportReader_Population_computeCompartmentSetLayout =
+R"doc(Compute the layout of the columns of the locations of
+`compartment_set`, see `getCompartmentSet`. Consecutive columns of
+consecutive locations share a range.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_computeNodeIdElementLayout =
+R"doc(Compute the layout returned by `getNodeIdElementLayout`, bypassing the
+cache.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator =
+R"doc(Iterator over consecutive DataFrames of a report, see
+`Population::iterate`.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_FrameIterator = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_FrameIterator_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_Prefetcher = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_buffer = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_frames_per_chunk = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_hasNext = R"doc(Return true if there are timesteps left.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_index_next = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_index_stop = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_layout = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_next =
+R"doc(Return the DataFrame of the next (at most `frames_per_chunk`)
+timesteps.
+
+When prefetching, wait for it to be read by the background thread,
+rethrowing its error if it failed.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_operator_assign = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_population = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_prefetcher = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_FrameIterator_stride = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_iterate =
+R"doc(Iterate over the report in time order, returning DataFrames of at
+most `frames_per_chunk` timesteps each, so that the memory used does
+not depend on the length of the simulation. The layout of the selected
+nodes is computed only once. The iterator holds its own copy of the
+population, so it may outlive the reader.
+
+Parameter ``node_ids``:
+    limit the report to the given selection.
+
+Parameter ``tstart``:
+    return voltages occurring on or after tstart.
+    tstart=nonstd::nullopt indicates no limit.
+
+Parameter ``tstop``:
+    return voltages occurring on or before tstop.
+    tstop=nonstd::nullopt indicates no limit.
+
+Parameter ``frames_per_chunk``:
+    maximum number of timesteps per DataFrame.
+    frames_per_chunk=nonstd::nullopt uses as many as fit in 64MB (at
+    least one).
+
+Parameter ``tstride``:
+    indicates every how many timesteps we read data.
+    tstride=nonstd::nullopt indicates that all timesteps are read.
+
+Parameter ``block_gap_limit``:
+    gap limit between each IO block while fetching data from storage.
+
+Parameter ``prefetch``:
+    number of DataFrames read ahead by a background thread while the
+    previous ones are consumed, so that reading and consuming overlap.
+    0 reads each DataFrame when it is requested. The reads of the
+    background thread are serialized with those of the other threads
+    by the lock of the library on HDF5.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_layout_cache = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_n_threads = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_n_times = R"doc()doc";
+
 static const char *__doc_bbp_sonata_ReportReader_Population_NodeIdElementLayout = R"doc()doc";
 
 static const char *__doc_bbp_sonata_ReportReader_Population_NodeIdElementLayout_ids = R"doc()doc";
@@ -741,7 +1027,12 @@ static const char *__doc_bbp_sonata_ReportReader_Population_NodeIdElementLayout_
 
 static const char *__doc_bbp_sonata_ReportReader_Population_NodeIdElementLayout_node_ranges = R"doc()doc";
 
-static const char *__doc_bbp_sonata_ReportReader_Population_Population = R"doc()doc";
+static const char *__doc_bbp_sonata_ReportReader_Population_NodeMapping = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_Population =
+R"doc(Open the population `populationName` of `file`, reading only its
+times, units and attributes: the mapping of its nodes is read on first
+use, see `getNodeMapping`.)doc";
 
 static const char *__doc_bbp_sonata_ReportReader_Population_data_units = R"doc()doc";
 
@@ -762,12 +1053,45 @@ Parameter ``tstride``:
     tstride=nonstd::nullopt indicates that all timesteps are read.
 
 Parameter ``block_gap_limit``:
-    gap limit between each IO block while fetching data from storage.)doc";
+    gap limit between each IO block while fetching data from storage.
+
+Parameter ``max_read_size``:
+    upper bound, in bytes, of the buffer used for each read from
+    storage; as many timesteps as fit are fetched with a single read
+    (at least one). max_read_size=nonstd::nullopt uses 64MB.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_getCompartmentSet =
+R"doc(Same as `get`, for the compartments of `compartment_set`, which must
+be of this population: the DataFrame has a column per compartment
+location, in the order of the set. Each location is resolved to a
+column of its node whose element id is its section, the n columns of a
+section splitting it evenly from offset 0 to 1.
+
+Only the columns of the locations are read, in {min,max} blocks as for
+`get`. Throws if the set is of another population, or a node or
+section of the set is not in the report.)doc";
 
 static const char *__doc_bbp_sonata_ReportReader_Population_getDataUnits = R"doc(Return the unit of data.)doc";
 
 static const char *__doc_bbp_sonata_ReportReader_Population_getIndex = R"doc()doc";
 
+static const char *__doc_bbp_sonata_ReportReader_Population_getInto =
+R"doc(Same as `get`, reading into `data_frame`, whose vectors are reused:
+once they are large enough, polling the same selection doesn't
+allocate. The blocks read from the file go through `buffer`, unless
+the selection is a single block of contiguous columns, read straight
+into the data.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_getInto_2 =
+R"doc(Same as `getInto`, reading only the values, into the `n_frames` rows
+of `n_ids` values of `data`, laid out as data[times][ids]: the ids are
+those of `getNodeIdElementIdMapping`, and the times those of the
+timesteps from tstart.
+
+Return the number of timesteps read. Throws if `n_ids` isn't the
+number of ids of the selection, or `n_frames` is less than the number
+of timesteps.)doc";
+
 static const char *__doc_bbp_sonata_ReportReader_Population_getNodeIdElementIdMapping =
 R"doc(Return the ElementIds for the passed Node. The return type will depend
 on the report reader: - For Soma report reader, the return value will
@@ -789,6 +1113,9 @@ node pointers and the range of positions where they fit in the file.
 This latter two are necessary for performance to understand how and
 where to retrieve the data from storage.
 
+Recently used layouts are cached, so that repeated queries over the
+same selection don't read 'mapping/element_ids' again.
+
 Parameter ``node_ids``:
     limit the report to the given selection. If nullptr, all nodes in
     the report are used
@@ -798,27 +1125,107 @@ Parameter ``block_gap_limit``:
 
 static const char *__doc_bbp_sonata_ReportReader_Population_getNodeIds = R"doc(Return all the node ids.)doc";
 
+static const char *__doc_bbp_sonata_ReportReader_Population_getNodeMapping =
+R"doc(Return the node ids of the mapping, with the range of the columns of
+each node and their index sorted by node id, reading them on first
+use.
+
+The index is read from 'mapping/node_index' when written by
+`ReportWriter::writeNodeIndex`, instead of sorting the node ids,
+unless they are sorted in the file.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_getReducedByNode =
+R"doc(Same as `get`, with the values of the elements of each node reduced
+to a single one per timestep with `reduction`: the ids of the
+DataFrame are the node ids, nodes without elements being left out.
+
+The timesteps are read and reduced a block at a time, so that the
+values of all the elements are never held in memory.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_getReducedByWindow =
+R"doc(Same as `get`, with the values of each element reduced with
+`reduction` over windows of `window` consecutive timesteps (after
+`tstride`), the last one possibly shorter. The times of the DataFrame
+are those of the first timestep of each window.
+
+The timesteps are read and reduced a block at a time, as for
+`getReducedByNode`.)doc";
+
 static const char *__doc_bbp_sonata_ReportReader_Population_getSorted = R"doc(Return true if the data is sorted.)doc";
 
+static const char *__doc_bbp_sonata_ReportReader_Population_getSummary =
+R"doc(Return the min, max and mean of each element over windows of
+timesteps between tstart and tstop, for an overview of the report at
+the time resolution `resolution`.
+
+The windows are those of the coarsest level of the summary pyramid
+whose windows last at most `resolution`, so that long time ranges are
+summarized from a few values; the first and last windows may extend
+beyond tstart and tstop. Without such a level, the values of each
+timestep are returned, as min, max and mean alike.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_getSummaryWindows =
+R"doc(Return the number of timesteps per window of each level of the
+summary pyramid written by `ReportWriter::writeSummaryPyramid`, from
+the finest; empty without one, or if it was computed from a previous
+generation of 'data', or if it is outdated by writes to 'data' in
+place, as far as its fingerprint of 'data' tells.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_getTime = R"doc(Return the time of the timestep `index`.)doc";
+
 static const char *__doc_bbp_sonata_ReportReader_Population_getTimeUnits = R"doc(Return the unit of time)doc";
 
 static const char *__doc_bbp_sonata_ReportReader_Population_getTimes = R"doc(Return (tstart, tstop, tstep) of the population)doc";
 
+static const char *__doc_bbp_sonata_ReportReader_Population_has_transposed_data = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_hasTransposedData =
+R"doc(Return true if the population has a transposed copy of its data,
+written by `ReportWriter::writeTransposedData`. Queries then read it
+instead of 'data' whenever it is expected to be cheaper, e.g. for the
+long traces of a few nodes. Transposed data of a previous generation
+of 'data' is ignored, as is, on a best-effort basis, transposed data
+outdated by writes to 'data' in place (see
+`ReportWriter::writeTransposedData`).)doc";
+
 static const char *__doc_bbp_sonata_ReportReader_Population_is_node_ids_sorted = R"doc()doc";
 
-static const char *__doc_bbp_sonata_ReportReader_Population_node_ids = R"doc()doc";
+static const char *__doc_bbp_sonata_ReportReader_Population_node_mapping = R"doc()doc";
 
-static const char *__doc_bbp_sonata_ReportReader_Population_node_index = R"doc()doc";
+static const char *__doc_bbp_sonata_ReportReader_Population_pop_group = R"doc()doc";
 
-static const char *__doc_bbp_sonata_ReportReader_Population_node_offsets = R"doc()doc";
+static const char *__doc_bbp_sonata_ReportReader_Population_preferTransposedData =
+R"doc(Return true if reading the timesteps [index_start, index_stop] of
+`layout` from 'data_transposed' is estimated to be cheaper than from
+'data'.)doc";
 
-static const char *__doc_bbp_sonata_ReportReader_Population_node_ranges = R"doc()doc";
+static const char *__doc_bbp_sonata_ReportReader_Population_readDataFrame =
+R"doc(Fill the times and data of `data_frame` for the timesteps
+[index_start, index_stop] with the given stride. The ids are left
+untouched.)doc";
 
-static const char *__doc_bbp_sonata_ReportReader_Population_pop_group = R"doc()doc";
+static const char *__doc_bbp_sonata_ReportReader_Population_readFrames =
+R"doc(Read the timesteps [index_start, index_stop] with the given stride
+into `out`, laid out as data[times][ids] according to `layout`.
 
-static const char *__doc_bbp_sonata_ReportReader_Population_time_units = R"doc()doc";
+Each {min,max} block is fetched in 2D tiles spanning several
+timesteps, so that the number of reads from storage does not grow
+with the number of timesteps. The tiles are read into `buffer`, reused
+between tiles and calls, unless their columns are those of `out`.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_readFramesParallel =
+R"doc(Same as `readFrames`, for a contiguous 'data' dataset of `n_cols`
+columns stored at byte `offset` of `filename`: the tiles are read
+directly from the file, concurrently by `n_threads_` threads.)doc";
 
-static const char *__doc_bbp_sonata_ReportReader_Population_times_index = R"doc()doc";
+static const char *__doc_bbp_sonata_ReportReader_Population_readFramesTransposed =
+R"doc(Same as `readFrames`, from 'data_transposed': the elements of
+consecutive nodes are read together, as many timesteps at a time as
+fit in `max_read_size`.)doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_summary_windows = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReader_Population_time_units = R"doc()doc";
 
 static const char *__doc_bbp_sonata_ReportReader_Population_tstart = R"doc()doc";
 
@@ -826,7 +1233,14 @@ static const char *__doc_bbp_sonata_ReportReader_Population_tstep = R"doc()doc";
 
 static const char *__doc_bbp_sonata_ReportReader_Population_tstop = R"doc()doc";
 
-static const char *__doc_bbp_sonata_ReportReader_ReportReader = R"doc()doc";
+static const char *__doc_bbp_sonata_ReportReader_ReportReader =
+R"doc(Open the report `filename`.
+
+Parameter ``n_threads``:
+    number of threads used to read the data of each query. Reports
+    stored contiguously, i.e. neither chunked nor compressed, are then
+    read directly from the file, concurrently by `n_threads` threads;
+    other reports are read as with a single thread.)doc";
 
 static const char *__doc_bbp_sonata_ReportReader_file = R"doc()doc";
 
@@ -836,6 +1250,203 @@ static const char *__doc_bbp_sonata_ReportReader_openPopulation = R"doc()doc";
 
 static const char *__doc_bbp_sonata_ReportReader_populations = R"doc()doc";
 
+static const char *__doc_bbp_sonata_ReportReduction = R"doc(Reduction of report values, see `ReportReader::Population::getReducedByNode`)doc";
+
+static const char *__doc_bbp_sonata_ReportReduction_max = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReduction_mean = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReduction_min = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportReduction_sum = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportSummary =
+R"doc(Summary of report values over windows of timesteps, see
+`ReportReader::Population::getSummary`)doc";
+
+static const char *__doc_bbp_sonata_ReportSummary_ids = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportSummary_max = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportSummary_mean = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportSummary_min = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportSummary_times = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportSummary_window = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter = R"doc(Used to write soma and element reports, streaming their frames in)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_ChunkShape =
+R"doc(Shape of the chunks of the 'data' dataset, whose rows are frames and
+columns elements.
+
+- contiguous: not chunked, the fastest to read whole frames and the
+only layout read directly from the file by several threads; it can't
+be compressed. - time_major: chunks span all the elements of a few
+frames, for readers of all (or most) of the nodes over short time
+windows. - element_major: chunks span all the frames of a few
+elements, for readers of the whole trace of a few nodes. - balanced:
+square chunks, for mixed access patterns.
+
+The frames of a row of chunks are buffered until it is complete:
+chunks span fewer frames than their shape asks for if their row would
+take more than 64MB of frames.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_ChunkShape_balanced = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_ChunkShape_contiguous = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_ChunkShape_element_major = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_ChunkShape_time_major = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_Population = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_buffer = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_add_offset = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_data = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_encoded = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_encoding = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_flush = R"doc(Write the buffered frames to the file)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_frames_per_chunk = R"doc(Frames are written to the file a row of chunks at a time)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_getElementCount = R"doc(Return the number of elements of each frame.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_getFrameCount = R"doc(Return the number of frames of the population.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_getWrittenFrameCount =
+R"doc(Return the number of frames written so far, buffered ones included.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_n_buffered = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_n_elements = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_n_frames = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_n_written = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_scale_factor = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_writeFrames =
+R"doc(Append `n_frames` frames of `getElementCount()` values each, stored
+row-major in `data`.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_writeFrames_2 =
+R"doc(Same as above, for frames stored row-major in `data`, whose size must
+be a multiple of `getElementCount()`.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_Population_writeRows =
+R"doc(Write `n_rows` frames to the rows of 'data' from `row`, encoded)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_ReportWriter = R"doc(Create the report `filename`, overwriting it if it exists.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_ReportWriter_2 = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_addPopulation =
+R"doc(Add a population, writing its mapping and laying out its data.
+
+The columns of the report are given by `node_ids` and `element_ids`,
+where the columns of a node must be contiguous; the mapping is flagged
+'sorted' if the nodes are increasing. Frames are those of the reader
+for `times` = (tstart, tstop, tstep).
+
+Parameter ``chunkShape``:
+    shape of the chunks of the 'data' dataset, see `ChunkShape`.
+
+Parameter ``chunkSize``:
+    number of values per chunk.
+
+Parameter ``compressionLevel``:
+    deflate level of the chunks, not compressed if 0.
+
+Parameter ``encoding``:
+    type of the values of 'data', see `ReportEncoding`: the frames are
+    converted as they are written, rounding to the nearest value.
+
+Parameter ``scaleFactor``:
+    for int16, the values are stored as (value - addOffset) /
+    scaleFactor, clamped to the range of int16.
+
+Parameter ``addOffset``:
+    for int16, see `scaleFactor`.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_close =
+R"doc(Write the buffered frames and close the file.
+
+Throws if the frames of a population were not all written.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_file = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_getPopulation = R"doc(Return a population added with `addPopulation`.)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_operator_assign = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_populations = R"doc()doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_writeNodeIndex =
+R"doc(Write 'mapping/node_index' to a population of the report `filename`:
+the positions of its node ids in 'mapping/node_ids', sorted by node
+id. `ReportReader` then reads it instead of sorting the node ids when
+they aren't sorted in the file.
+
+Populations added by `addPopulation` with unsorted node ids already
+have one.
+
+Parameter ``overwrite``:
+    replaces an existing index, instead of throwing)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_writeSummaryPyramid =
+R"doc(Write a summary pyramid next to the 'data' of a population of the
+report `filename`, read by `ReportReader::Population::getSummary`:
+level k holds the min, max and mean of each element over windows of
+2^k timesteps, up to a single window.
+
+Each level is computed from the previous one, a block of rows at a
+time, so that the data is read once and memory use doesn't depend on
+the size of the report. As with `writeTransposedData`, the pyramid is
+ignored once the fingerprint of 'data' changes.
+
+Parameter ``compressionLevel``:
+    deflate level of the chunks, not compressed if 0.
+
+Parameter ``overwrite``:
+    replaces an existing summary pyramid, instead of throwing)doc";
+
+static const char *__doc_bbp_sonata_ReportWriter_writeTransposedData =
+R"doc(Write 'data_transposed' next to the 'data' of a population of the
+report `filename`: a copy of the data stored as data[element][time],
+in chunks of `elementsPerChunk` elements by `framesPerChunk` frames,
+picked up by `ReportReader` for per-trace queries.
+
+The data is copied in tiles of whole chunks, so that memory use
+doesn't depend on the size of the report. Values stored as float16 or
+int16 are copied decoded, as float32.
+
+The copy records a fingerprint of 'data', and is ignored by readers
+once it differs: the random 'generation' attribute set by
+`addPopulation` (and here if missing), the dimensions, the
+modification time of the dataset, if HDF5 tracks it, and a few of its
+values. Writes in place keep the generation, and HDF5 doesn't update
+the modification time on writes of values, so only those changing the
+sampled values are detected: programs rewriting 'data' in place should
+give it a new generation, or write the copy again.
+
+Parameter ``compressionLevel``:
+    deflate level of the chunks, not compressed if 0.
+
+Parameter ``overwrite``:
+    replaces existing transposed data, instead of throwing)doc";
+
 static const char *__doc_bbp_sonata_Selection = R"doc()doc";
 
 static const char *__doc_bbp_sonata_Selection_Selection =
@@ -1593,6 +2204,8 @@ static const char *__doc_bbp_sonata_SpikeReader = R"doc(Used to read spike files
 
 static const char *__doc_bbp_sonata_SpikeReader_Population = R"doc()doc";
 
+static const char *__doc_bbp_sonata_SpikeReader_Population_LazySpikes = R"doc()doc";
+
 static const char *__doc_bbp_sonata_SpikeReader_Population_Population = R"doc()doc";
 
 static const char *__doc_bbp_sonata_SpikeReader_Population_Sorting = R"doc()doc";
@@ -1603,19 +2216,37 @@ static const char *__doc_bbp_sonata_SpikeReader_Population_Sorting_by_time = R"d
 
 static const char *__doc_bbp_sonata_SpikeReader_Population_Sorting_none = R"doc()doc";
 
-static const char *__doc_bbp_sonata_SpikeReader_Population_createSpikes = R"doc(Create the spikes from the vectors of node_ids and timestamps)doc";
+static const char *__doc_bbp_sonata_SpikeReader_Population_SpikeIndex = R"doc()doc";
 
-static const char *__doc_bbp_sonata_SpikeReader_Population_filterNode = R"doc()doc";
+static const char *__doc_bbp_sonata_SpikeReader_Population_binnedCounts =
+R"doc(Return the number of spikes of `node_ids` (all nodes if not given) in
+each bin of `binSize` splitting [tstart, tstop), the last bin being
+cut at `tstop`.
 
-static const char *__doc_bbp_sonata_SpikeReader_Population_filterTimestamp = R"doc()doc";
+Counting is split between up to `n_threads` threads.)doc";
+
+static const char *__doc_bbp_sonata_SpikeReader_Population_firingRates =
+R"doc(Return the number of spikes per unit of time of each of `node_ids`, in
+order, between 'tstart' and 'tstop' (those of the population if not
+given).)doc";
 
 static const char *__doc_bbp_sonata_SpikeReader_Population_get = R"doc(Return spikes with all those node_ids between 'tstart' and 'tstop')doc";
 
 static const char *__doc_bbp_sonata_SpikeReader_Population_getArrays =
 R"doc(Return the node_ids and timestamps vectors with all node_ids between
-'tstart' and 'tstop')doc";
+'tstart' and 'tstop'
+
+Spikes are returned in the order of the file. Indices by node ID and
+by time are built on the first filtered query, so that later ones only
+visit the matching spikes. Lazy populations are instead searched and
+read in the file.)doc";
 
-static const char *__doc_bbp_sonata_SpikeReader_Population_getRawArrays = R"doc(Return the raw node_ids and timestamps vectors)doc";
+static const char *__doc_bbp_sonata_SpikeReader_Population_getArrays_2 =
+R"doc(Same as `getArrays`, replacing the content of `spikes`, whose memory
+is reused)doc";
+
+static const char *__doc_bbp_sonata_SpikeReader_Population_getRawArrays =
+R"doc(Return the raw node_ids and timestamps vectors, without copying them)doc";
 
 static const char *__doc_bbp_sonata_SpikeReader_Population_getSorting = R"doc(Return the way data are sorted ('none', 'by_id', 'by_time'))doc";
 
@@ -1623,8 +2254,20 @@ static const char *__doc_bbp_sonata_SpikeReader_Population_getTimeUnits = R"doc(
 
 static const char *__doc_bbp_sonata_SpikeReader_Population_getTimes = R"doc(Return (tstart, tstop) of the population)doc";
 
+static const char *__doc_bbp_sonata_SpikeReader_Population_index = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeReader_Population_isiStats =
+R"doc(Return the statistics of the intervals between the spikes of each of
+`node_ids`, in order, between 'tstart' and 'tstop'.)doc";
+
+static const char *__doc_bbp_sonata_SpikeReader_Population_lazy = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeReader_Population_nodeSpikes = R"doc(Positions in the index by node of the spikes of `node_id` in [tstart, tstop])doc";
+
 static const char *__doc_bbp_sonata_SpikeReader_Population_sorting = R"doc()doc";
 
+static const char *__doc_bbp_sonata_SpikeReader_Population_spikeTimes = R"doc(All the spikes, read from the file on first use for lazy populations)doc";
+
 static const char *__doc_bbp_sonata_SpikeReader_Population_spike_times = R"doc()doc";
 
 static const char *__doc_bbp_sonata_SpikeReader_Population_time_units = R"doc()doc";
@@ -1635,10 +2278,18 @@ static const char *__doc_bbp_sonata_SpikeReader_Population_tstop = R"doc()doc";
 
 static const char *__doc_bbp_sonata_SpikeReader_SpikeReader = R"doc()doc";
 
+static const char *__doc_bbp_sonata_SpikeReader_SpikeReader_2 =
+R"doc(With `lazy`, populations sorted 'by_time' or 'by_id' are not loaded
+in memory when opened. Instead, `get` and `getArrays` binary-search
+the datasets in the file and only read the spikes which can match.
+Other populations are loaded in memory as usual.)doc";
+
 static const char *__doc_bbp_sonata_SpikeReader_filename = R"doc()doc";
 
 static const char *__doc_bbp_sonata_SpikeReader_getPopulationNames = R"doc(Return a list of all population names.)doc";
 
+static const char *__doc_bbp_sonata_SpikeReader_lazy = R"doc()doc";
+
 static const char *__doc_bbp_sonata_SpikeReader_openPopulation = R"doc()doc";
 
 static const char *__doc_bbp_sonata_SpikeReader_populations = R"doc()doc";
@@ -1649,6 +2300,53 @@ static const char *__doc_bbp_sonata_SpikeTimes_node_ids = R"doc()doc";
 
 static const char *__doc_bbp_sonata_SpikeTimes_timestamps = R"doc()doc";
 
+static const char *__doc_bbp_sonata_SpikeWriter = R"doc(Used to write spike files)doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_PopulationSpikes = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_PopulationSpikes_sorting = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_PopulationSpikes_spikes = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_PopulationSpikes_time_units = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_SpikeWriter = R"doc(Spikes are sorted with up to `n_threads` threads when written.)doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_addPopulation =
+R"doc(Declare a population, whose spikes are written sorted according to
+`sorting`.
+
+Throws if the population was already added, or once the file is
+written.)doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_addSpikes =
+R"doc(Add a batch of spikes to a population declared with `addPopulation`.
+
+Batches can be added from several threads at the same time, until the
+file is written.)doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_filename = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_mutex = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_n_threads = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_populations = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_written = R"doc()doc";
+
+static const char *__doc_bbp_sonata_SpikeWriter_write =
+R"doc(Sort the spikes of each population and write them to the file, which
+is overwritten.
+
+The datasets are split in chunks of `chunkSize` spikes, compressed
+with deflate if `compressionLevel` is positive. With a `chunkSize` of
+0, they are stored contiguously and can't be compressed. The spikes
+are dropped from the writer once written.
+
+The file can only be written once: the writer throws on any later
+call.)doc";
+
 static const char *__doc_bbp_sonata_detail_CompartmentSet = R"doc()doc";
 
 static const char *__doc_bbp_sonata_detail_CompartmentSetFilteredIterator = R"doc()doc";
@@ -13,8 +13,13 @@ from libsonata._libsonata import (
     ElementDataFrame,
     ElementReportPopulation,
     ElementReportReader,
+    ElementReportSummary,
+    MergedSpikeReader,
     NodePopulation,
     NodeSets,
+    ReportReadBuffer,
+    ReportWriter,
+    ReportWriterPopulation,
     CompartmentLocation,
     CompartmentSet,
     CompartmentSets,
@@ -23,9 +28,11 @@ from libsonata._libsonata import (
     SomaDataFrame,
     SomaReportPopulation,
     SomaReportReader,
+    SomaReportSummary,
     SonataError,
     SpikePopulation,
     SpikeReader,
+    SpikeWriter,
     version,
     Hdf5Reader,
 )
@@ -42,8 +49,13 @@ __all__ = [
     "ElementDataFrame",
     "ElementReportPopulation",
     "ElementReportReader",
+    "ElementReportSummary",
+    "MergedSpikeReader",
     "NodePopulation",
     "NodeSets",
+    "ReportReadBuffer",
+    "ReportWriter",
+    "ReportWriterPopulation",
     "CompartmentLocation",
     "CompartmentSet",
     "CompartmentSets",
@@ -52,9 +64,11 @@ __all__ = [
     "SomaDataFrame",
     "SomaReportPopulation",
     "SomaReportReader",
+    "SomaReportSummary",
     "SonataError",
     "SpikePopulation",
     "SpikeReader",
+    "SpikeWriter",
     "version",
     "Hdf5Reader",
 ]
@@ -10,6 +10,7 @@ from libsonata import (
     EdgePopulation,
     EdgeStorage,
     ElementReportReader,
+    Hdf5Reader,
     NodePopulation,
     NodeSets,
     NodeStorage,
@@ -145,6 +146,25 @@ class TestNodePopulation(unittest.TestCase):
 
         self.assertRaises(SonataError, self.test_obj.get_attribute, 'no-such-attribute', 0)
 
+    def test_get_attribute_view(self):
+        view = self.test_obj.get_attribute_view('attr-X')
+        self.assertEqual(view.tolist(), [11., 12., 13., 14., 15., 16.])
+        self.assertEqual(view.dtype, np.float64)
+        self.assertFalse(view.flags.writeable)
+        self.assertFalse(view.flags.owndata)
+
+        self.assertEqual(self.test_obj.get_attribute_view('attr-Y').tolist(), list(range(21, 27)))
+
+        self.assertRaises(SonataError, self.test_obj.get_attribute_view, 'attr-Z')
+        self.assertRaises(SonataError, self.test_obj.get_attribute_view, 'no-such-attribute')
+
+    def test_mapped_reader(self):
+        path = os.path.join(PATH, 'nodes1.h5')
+        mapped = NodeStorage(path, hdf5_reader=Hdf5Reader.memory_mapped()).open_population('nodes-A')
+        for name in ('attr-X', 'attr-Y', 'attr-Z'):
+            self.assertEqual(mapped.get_attribute(name, Selection([0, 2, 5])).tolist(),
+                             self.test_obj.get_attribute(name, Selection([0, 2, 5])).tolist())
+
     def test_get_dynamics_attribute(self):
         self.assertEqual(self.test_obj.get_dynamics_attribute('dparam-X', 0), 1011.)
         self.assertEqual(self.test_obj.get_dynamics_attribute('dparam-X', Selection([0, 5])).tolist(), [1011., 1016.])
@@ -219,6 +239,26 @@ class TestNodePopulation(unittest.TestCase):
             0
         )
 
+    def test_edges_per_node(self):
+        offsets, ranges = self.test_obj.afferent_edges_per_node([1, 3, 2])
+        self.assertEqual(offsets.tolist(), [0, 2, 2, 4])
+        self.assertEqual(ranges.tolist(), [[0, 1], [2, 4], [1, 2], [5, 6]])
+
+        offsets, ranges = self.test_obj.efferent_edges_per_node([0, 1])
+        self.assertEqual(offsets.tolist(), [0, 0, 1])
+        self.assertEqual(ranges.tolist(), [[0, 2]])
+
+    def test_preload_indices(self):
+        self.assertFalse(self.test_obj.has_preloaded_indices)
+        self.test_obj.preload_indices()
+        self.assertTrue(self.test_obj.has_preloaded_indices)
+        self.assertEqual(self.test_obj.afferent_edges([1, 2]).ranges, [(0, 4), (5, 6)])
+        self.assertEqual(self.test_obj.efferent_edges([1, 2]).ranges, [(0, 4)])
+        self.assertEqual(self.test_obj.connecting_edges([1, 2], [1, 2]).ranges, [(0, 4)])
+        offsets, ranges = self.test_obj.afferent_edges_per_node([1, 3, 2])
+        self.assertEqual(offsets.tolist(), [0, 2, 2, 4])
+        self.assertEqual(ranges.tolist(), [[0, 1], [2, 4], [1, 2], [5, 6]])
+
     def test_select_all(self):
         self.assertEqual(self.test_obj.select_all().flat_size, 6)
 
@@ -1,15 +1,24 @@
 import os
+import tempfile
+import threading
 import unittest
 
+import json
+
 import numpy as np
 
-from libsonata import (ElementReportPopulation,
+from libsonata import (CompartmentSet,
+                       ElementReportPopulation,
                        ElementReportReader,
+                       MergedSpikeReader,
+                       ReportReadBuffer,
+                       ReportWriter,
                        SomaReportPopulation,
                        SomaReportReader,
                        SonataError,
                        SpikePopulation,
                        SpikeReader,
+                       SpikeWriter,
                        )
 
 
@@ -62,9 +71,236 @@ class TestSpikeReader(unittest.TestCase):
         self.assertTrue((dict_data_filtered_nodes["node_ids"] == np.asarray([5, 2, 2])).all())
         self.assertTrue((dict_data_filtered_nodes["timestamps"] == np.asarray([0.1, 0.2, 0.7])).all())
 
+    def test_statistics(self):
+        population = self.test_obj['spikes2']
+        counts = population.binned_counts(None, 0., 1.5, 0.5, n_threads=2)
+        self.assertEqual(counts.tolist(), [3, 1, 1])
+        self.assertEqual(population.binned_counts([2, 3], 0., 1.5, 0.5).tolist(), [2, 1, 1])
+        rates = population.firing_rates([2, 3, 5, 7], tstart=0., tstop=2.)
+        self.assertEqual(rates.tolist(), [1., 1., 0.5, 0.])
+        stats = population.isi_stats([2, 5])
+        self.assertEqual(stats['node_ids'].tolist(), [2, 5])
+        self.assertEqual(stats['counts'].tolist(), [1, 0])
+        self.assertAlmostEqual(stats['means'][0], 0.5)
+        self.assertTrue(np.isnan(stats['cvs'][1]))
+        self.assertRaises(SonataError, population.binned_counts, None, 0., 1., 0.)
+
+    def test_get_dict_views(self):
+        population = self.test_obj['All']
+        dict_data = population.get_dict()
+        self.assertFalse(dict_data["node_ids"].flags.writeable)
+        self.assertFalse(dict_data["timestamps"].flags.writeable)
+        # The views keep the population alive
+        del population, self.test_obj
+        self.assertTrue((dict_data["node_ids"] == np.asarray([5, 2, 3, 2, 3])).all())
+
     def test_getTimes_from_population(self):
         self.assertEqual(self.test_obj['All'].times, (0.1, 1.3))
 
+    def test_lazy(self):
+        lazy = SpikeReader(os.path.join(PATH, "spikes.h5"), lazy=True)
+        for name in self.test_obj.get_population_names():
+            expected, actual = self.test_obj[name], lazy[name]
+            self.assertEqual(actual.times, expected.times)
+            self.assertEqual(actual.get(), expected.get())
+            self.assertEqual(actual.get((2, 5)), expected.get((2, 5)))
+            self.assertEqual(actual.get(tstart=0.2, tstop=1.0), expected.get(tstart=0.2, tstop=1.0))
+            for kwargs in ({}, {'node_ids': [5, 3], 'tstart': 0.2}, {'tstart': 0.2, 'tstop': 1.0}):
+                expected_dict, actual_dict = expected.get_dict(**kwargs), actual.get_dict(**kwargs)
+                self.assertTrue((actual_dict["node_ids"] == expected_dict["node_ids"]).all())
+                self.assertTrue((actual_dict["timestamps"] == expected_dict["timestamps"]).all())
+
+
+class TestSpikeWriter(unittest.TestCase):
+    def test_write(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, 'spikes.h5')
+            writer = SpikeWriter(path, n_threads=2)
+            writer.add_population('by_time')
+            writer.add_population('by_id', sorting='by_id', time_units='s')
+            for name in ('by_time', 'by_id'):
+                writer.add_spikes(name, [5, 2, 3], [0.1, 0.7, 0.3])
+                writer.add_spikes(name, np.array([2, 3], dtype=np.uint64), np.array([0.2, 1.3]))
+            self.assertRaises(SonataError, writer.add_population, 'none', sorting='unknown')
+            self.assertRaises(SonataError, writer.add_spikes, 'unknown', [1], [0.1])
+            writer.write(chunk_size=2, compression_level=4)
+            self.assertRaises(SonataError, writer.write)
+            self.assertRaises(SonataError, writer.add_spikes, 'by_time', [1], [0.1])
+
+            reader = SpikeReader(path)
+            self.assertEqual(reader.get_population_names(), ['by_id', 'by_time'])
+            self.assertEqual(reader['by_time'].sorting, 'by_time')
+            self.assertEqual(reader['by_time'].time_units, 'ms')
+            self.assertEqual(reader['by_time'].get(), [(5, 0.1), (2, 0.2), (3, 0.3), (2, 0.7), (3, 1.3)])
+            self.assertEqual(reader['by_id'].sorting, 'by_id')
+            self.assertEqual(reader['by_id'].time_units, 's')
+            self.assertEqual(reader['by_id'].get(), [(2, 0.2), (2, 0.7), (3, 0.3), (3, 1.3), (5, 0.1)])
+
+
+class TestMergedSpikeReader(unittest.TestCase):
+    def test_merge(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, 'spikes.h5')
+            writer = SpikeWriter(path)
+            writer.add_population('by_time')
+            writer.add_population('none', sorting='none')
+            writer.add_spikes('by_time', [5, 2, 3], [0.1, 0.7, 0.3])
+            writer.add_spikes('none', [4, 1, 2], [0.3, 0.9, 0.2])
+            writer.write()
+
+            sources = [(path, 'by_time'), (path, 'none')]
+            self.assertRaises(SonataError, MergedSpikeReader, sources, sorting='none')
+
+            merged = MergedSpikeReader(sources, block_size=2)
+            self.assertEqual(merged.sources, sources)
+            spikes = merged.next(4)
+            self.assertFalse(merged.done)
+            self.assertEqual(spikes['node_ids'].tolist(), [5, 2, 3, 4])
+            self.assertEqual(spikes['timestamps'].tolist(), [0.1, 0.2, 0.3, 0.3])
+            self.assertEqual(spikes['sources'].tolist(), [0, 1, 0, 1])
+            spikes = merged.next(4)
+            self.assertTrue(merged.done)
+            self.assertEqual(spikes['node_ids'].tolist(), [2, 1])
+            self.assertEqual(len(merged.next(4)['node_ids']), 0)
+
+            merged = MergedSpikeReader(sources, sorting='by_id')
+            spikes = merged.next(10)
+            self.assertEqual(spikes['node_ids'].tolist(), [1, 2, 2, 3, 4, 5])
+            self.assertEqual(spikes['sources'].tolist(), [1, 0, 1, 0, 1, 0])
+            merged.reset()
+            self.assertEqual(merged.next(1)['node_ids'].tolist(), [1])
+
+
+class TestReportWriter(unittest.TestCase):
+    def test_write(self):
+        data = np.arange(30, dtype=np.float32).reshape(10, 3)
+        for chunk_shape in ('contiguous', 'time_major', 'element_major', 'balanced'):
+            with tempfile.TemporaryDirectory() as tmpdir:
+                path = os.path.join(tmpdir, 'elements.h5')
+                writer = ReportWriter(path)
+                population = writer.add_population('All', [2, 1, 1], [0, 0, 1], (0., 1., 0.1),
+                                                   chunk_shape=chunk_shape, chunk_size=4)
+                self.assertEqual(population.frame_count, 10)
+                self.assertEqual(population.element_count, 3)
+                population.write_frames(data[:3])
+                population.write_frames(data[3])
+                writer['All'].write_frames(data[4:].astype(np.float64))
+                self.assertEqual(population.written_frame_count, 10)
+                self.assertRaises(SonataError, population.write_frames, data[:1])
+                writer.close()
+
+                population = ElementReportReader(path)['All']
+                self.assertEqual(population.times, (0., 1., 0.1))
+                self.assertFalse(population.sorted)
+                frames = population.get()
+                np.testing.assert_array_equal(frames.ids, [[1, 0], [1, 1], [2, 0]])
+                np.testing.assert_array_equal(frames.data, data[:, [1, 2, 0]])
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            writer = ReportWriter(os.path.join(tmpdir, 'elements.h5'))
+            self.assertRaises(SonataError, writer.add_population, 'All', [1], [0], (0., 1., 0.1),
+                              chunk_shape='unknown')
+            population = writer.add_population('All', [1], [0], (0., 1., 0.1))
+            self.assertRaises(SonataError, population.write_frames, np.zeros((2, 2)))
+            self.assertRaises(SonataError, writer.close)
+
+    def test_write_encoded(self):
+        data = np.linspace(-80., 40., 600, dtype=np.float32).reshape(200, 3)
+        float16_tolerance = np.maximum(np.abs(data), 1.) / 2048
+        for encoding, tolerance in (('float16', float16_tolerance), ('int16', 0.0025)):
+            with tempfile.TemporaryDirectory() as tmpdir:
+                path = os.path.join(tmpdir, 'elements.h5')
+                writer = ReportWriter(path)
+                writer.add_population('All', [1, 1, 2], [0, 1, 0], (0., 20., 0.1),
+                                      chunk_shape='contiguous', encoding=encoding,
+                                      scale_factor=0.005, add_offset=-20.).write_frames(data)
+                writer.close()
+
+                for n_threads in (1, 4):
+                    frames = ElementReportReader(path, n_threads=n_threads)['All'].get()
+                    self.assertEqual(frames.data.dtype, np.float32)
+                    self.assertTrue(np.all(np.abs(frames.data - data) <= tolerance))
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            writer = ReportWriter(os.path.join(tmpdir, 'elements.h5'))
+            self.assertRaises(SonataError, writer.add_population, 'All', [1], [0], (0., 1., 0.1),
+                              encoding='float64')
+            self.assertRaises(SonataError, writer.add_population, 'All', [1], [0], (0., 1., 0.1),
+                              encoding='int16', scale_factor=0.)
+
+    def test_write_transposed_data(self):
+        data = np.arange(600, dtype=np.float32).reshape(200, 3)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, 'elements.h5')
+            writer = ReportWriter(path)
+            writer.add_population('All', [1, 1, 2], [0, 1, 0], (0., 20., 0.1),
+                                  chunk_shape='contiguous').write_frames(data)
+            writer.close()
+            self.assertFalse(ElementReportReader(path)['All'].has_transposed_data)
+
+            ReportWriter.write_transposed_data(path, 'All', elements_per_chunk=2,
+                                               frames_per_chunk=64)
+            self.assertRaises(SonataError, ReportWriter.write_transposed_data, path, 'All')
+            ReportWriter.write_transposed_data(path, 'All', compression_level=4, overwrite=True)
+
+            population = ElementReportReader(path)['All']
+            self.assertTrue(population.has_transposed_data)
+            np.testing.assert_array_equal(population.get(node_ids=[2]).data, data[:, 2:])
+            np.testing.assert_array_equal(population.get(tstart=1., tstop=2.).data, data[10:21])
+
+    def test_write_node_index(self):
+        data = np.arange(60, dtype=np.float32).reshape(10, 6)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, 'elements.h5')
+            writer = ReportWriter(path)
+            writer.add_population('All', [3, 3, 1, 1, 1, 2], [0, 1, 0, 1, 2, 0],
+                                  (0., 1., 0.1)).write_frames(data)
+            writer.close()
+            expected = ElementReportReader(path)['All'].get(node_ids=[1, 2])
+
+            self.assertRaises(SonataError, ReportWriter.write_node_index, path, 'All')
+            ReportWriter.write_node_index(path, 'All', overwrite=True)
+            population = ElementReportReader(path)['All']
+            self.assertEqual(population.get_node_ids(), [3, 1, 2])
+            frames = population.get(node_ids=[1, 2])
+            np.testing.assert_array_equal(frames.ids, expected.ids)
+            np.testing.assert_array_equal(frames.data, data[:, 2:])
+
+    def test_write_summary_pyramid(self):
+        data = np.arange(600, dtype=np.float32).reshape(200, 3)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            path = os.path.join(tmpdir, 'elements.h5')
+            writer = ReportWriter(path)
+            writer.add_population('All', [1, 1, 2], [0, 1, 0], (0., 20., 0.1),
+                                  chunk_shape='contiguous').write_frames(data)
+            writer.close()
+            population = ElementReportReader(path)['All']
+            self.assertEqual(population.summary_windows, [])
+            summary = population.get_summary(1.)
+            self.assertEqual(summary.window, 1)
+            np.testing.assert_array_equal(summary.min, data)
+            np.testing.assert_array_equal(summary.mean, data)
+
+            ReportWriter.write_summary_pyramid(path, 'All')
+            self.assertRaises(SonataError, ReportWriter.write_summary_pyramid, path, 'All')
+            ReportWriter.write_summary_pyramid(path, 'All', compression_level=4, overwrite=True)
+
+            population = ElementReportReader(path)['All']
+            self.assertEqual(population.summary_windows, [2, 4, 8, 16, 32, 64, 128, 256])
+            summary = population.get_summary(resolution=0.4)
+            self.assertEqual(summary.window, 4)
+            np.testing.assert_allclose(summary.times, np.arange(0., 20., 0.4))
+            np.testing.assert_array_equal(summary.ids, [[1, 0], [1, 1], [2, 0]])
+            np.testing.assert_array_equal(summary.min, data[::4])
+            np.testing.assert_array_equal(summary.max, data[3::4])
+            np.testing.assert_allclose(summary.mean, data.reshape(50, 4, 3).mean(axis=1))
+
+            summary = population.get_summary(resolution=100., node_ids=[2])
+            self.assertEqual(summary.window, 256)
+            np.testing.assert_array_equal(summary.min, [[2.]])
+            np.testing.assert_array_equal(summary.max, [[599.]])
+            np.testing.assert_allclose(summary.mean, [[300.5]])
+
 
 class TestSomaReportReader(unittest.TestCase):
     def setUp(self):
@@ -166,6 +402,66 @@ class TestElementReportReader(unittest.TestCase):
         with self.assertRaises(SonataError):
             self.test_obj['All'].get(tstart=5.)  # tstart out of range
 
+    def test_get_into(self):
+        population = self.test_obj['All']
+        sel = population.get(node_ids=[13, 14], tstart=0.8, tstop=1.2)
+        out = np.full((4, 10), -1, dtype=np.float32)
+        buffer = ReportReadBuffer()
+        for _ in range(2):
+            self.assertEqual(population.get_into(out, node_ids=[13, 14], tstart=0.8, tstop=1.2,
+                                                 buffer=buffer), 3)
+            np.testing.assert_array_equal(out[:3], sel.data)
+            np.testing.assert_array_equal(out[3], -1)
+
+        self.assertEqual(population.get_into(out[:1], node_ids=[13, 14], tstart=0.8, tstop=0.8), 1)
+        self.assertRaises(SonataError, population.get_into, out[:2], node_ids=[13, 14])
+        self.assertRaises(SonataError, population.get_into, out, node_ids=[13])
+        self.assertRaises(TypeError, population.get_into, out.astype(np.float64), node_ids=[13, 14])
+
+    def test_get_compartment_set(self):
+        population = self.test_obj['All']
+        # Node 3 has sections [5, 5, 6, 6, 7], node 4 sections [7, 8, 8, 9, 9]
+        compartment_set = CompartmentSet(json.dumps({
+            'population': 'All',
+            'compartment_set': [[3, 5, 0.25], [3, 5, 0.75], [3, 7, 0.5], [4, 7, 0.], [4, 9, 1.]],
+        }))
+        sel = population.get(node_ids=[3, 4], tstart=0.2, tstop=3.0, tstride=3)
+        data = population.get_compartment_set(compartment_set, tstart=0.2, tstop=3.0, tstride=3)
+        columns = [0, 1, 4, 5, 9]
+        np.testing.assert_array_equal(data.ids, np.asarray(sel.ids)[columns])
+        np.testing.assert_allclose(data.times, sel.times)
+        np.testing.assert_array_equal(data.data, np.asarray(sel.data)[:, columns])
+
+        missing = CompartmentSet(json.dumps({'population': 'All',
+                                             'compartment_set': [[3, 8, 0.5]]}))
+        self.assertRaises(SonataError, population.get_compartment_set, missing)
+        other = CompartmentSet(json.dumps({'population': 'Other',
+                                           'compartment_set': [[3, 5, 0.25]]}))
+        self.assertRaises(SonataError, population.get_compartment_set, other)
+
+    def test_get_reduced(self):
+        population = self.test_obj['All']
+        sel = population.get(node_ids=[13, 14], tstart=0.8, tstop=1.2)
+        data = np.asarray(sel.data)
+
+        by_node = population.get_reduced_by_node(node_ids=[13, 14], tstart=0.8, tstop=1.2)
+        np.testing.assert_array_equal(by_node.ids, [13, 14])
+        np.testing.assert_allclose(by_node.times, sel.times)
+        np.testing.assert_allclose(by_node.data,
+                                   np.stack([data[:, :5].mean(axis=1),
+                                             data[:, 5:].mean(axis=1)], axis=1), rtol=1e-6)
+        by_node = population.get_reduced_by_node(node_ids=[13, 14], tstart=0.8, tstop=1.2,
+                                                 reduction='max')
+        np.testing.assert_array_equal(by_node.data[:, 1], data[:, 5:].max(axis=1))
+
+        by_window = population.get_reduced_by_window(2, node_ids=[13, 14], tstart=0.8,
+                                                     tstop=1.2, reduction='sum')
+        np.testing.assert_array_equal(by_window.ids, sel.ids)
+        np.testing.assert_allclose(by_window.times, [sel.times[0], sel.times[2]])
+        np.testing.assert_allclose(by_window.data, [data[:2].sum(axis=0), data[2]], rtol=1e-6)
+
+        self.assertRaises(SonataError, population.get_reduced_by_node, reduction='median')
+
         # tstart should be <= tstop
         np.testing.assert_allclose(self.test_obj['All'].get(node_ids=[1, 2], tstart=3., tstop=3.).data[0],
                                    [150.0, 150.1, 150.2, 150.3, 150.4, 150.5, 150.6, 150.7, 150.8, 150.9])
@@ -189,3 +485,59 @@ class TestElementReportReader(unittest.TestCase):
 
         with self.assertRaises(SonataError):
             self.test_obj['All'].get_node_id_element_id_mapping([[3, 5]], block_gap_limit=4194303) # < 1 x GPFS block
+
+    def test_max_read_size(self):
+        pop = self.test_obj['All']
+        ref = pop.get(node_ids=[3, 4], tstride=3)
+        # one timestep per read
+        sel = pop.get(node_ids=[3, 4], tstride=3, max_read_size=1)
+        np.testing.assert_array_equal(sel.data, ref.data)
+        np.testing.assert_array_equal(sel.times, ref.times)
+
+    def test_iterate(self):
+        pop = self.test_obj['All']
+        ref = pop.get(node_ids=[3, 4], tstart=0.4, tstop=3.0)
+        frames = list(pop.iterate(node_ids=[3, 4], tstart=0.4, tstop=3.0, frames_per_chunk=4))
+        self.assertEqual([len(frame.times) for frame in frames], [4, 4, 4, 2])
+        for frame in frames:
+            np.testing.assert_array_equal(frame.ids, ref.ids)
+        np.testing.assert_array_equal(np.concatenate([frame.times for frame in frames]), ref.times)
+        np.testing.assert_array_equal(np.concatenate([frame.data for frame in frames]), ref.data)
+
+        prefetched = list(pop.iterate(node_ids=[3, 4], tstart=0.4, tstop=3.0, frames_per_chunk=1,
+                                      prefetch=3))
+        self.assertEqual(len(prefetched), len(ref.times))
+        np.testing.assert_array_equal(np.concatenate([frame.data for frame in prefetched]),
+                                      ref.data)
+
+        # the population is read by other threads while prefetching
+        other = pop.get(node_ids=[1, 2, 7])
+        results = []
+        thread = threading.Thread(
+            target=lambda: results.extend(pop.get(node_ids=[1, 2, 7]).data for _ in range(20)))
+        thread.start()
+        prefetched = []
+        for frame in pop.iterate(node_ids=[3, 4], tstart=0.4, tstop=3.0, frames_per_chunk=1,
+                                 prefetch=3):
+            np.testing.assert_array_equal(pop.get(node_ids=[1, 2, 7]).data, other.data)
+            prefetched.append(frame.data)
+        thread.join()
+        np.testing.assert_array_equal(np.concatenate(prefetched), ref.data)
+        self.assertEqual(len(results), 20)
+        for data in results:
+            np.testing.assert_array_equal(data, other.data)
+
+        self.assertEqual(list(pop.iterate(node_ids=[])), [])
+        with self.assertRaises(SonataError):
+            pop.iterate(frames_per_chunk=0)
+
+    def test_n_threads(self):
+        reader = ElementReportReader(os.path.join(PATH, 'elements.h5'), n_threads=4)
+        parallel = reader['All']
+        pop = self.test_obj['All']
+        for node_ids in (None, [3, 4], [1, 7, 12]):
+            ref = pop.get(node_ids=node_ids, tstride=2)
+            data = parallel.get(node_ids=node_ids, tstride=2)
+            np.testing.assert_array_equal(data.ids, ref.ids)
+            np.testing.assert_array_equal(data.times, ref.times)
+            np.testing.assert_array_equal(data.data, ref.data)
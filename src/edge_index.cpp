@@ -10,13 +10,15 @@
 #include "edge_index.h"
 
 #include <bbp/sonata/common.h>
+#include <bbp/sonata/optional.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
-#include <set>
-#include <unordered_map>
+#include <numeric>  // std::partial_sum
 #include <vector>
 
+#include "parallel_read.hpp"
 #include "read_bulk.hpp"
 
 namespace bbp {
@@ -54,9 +56,9 @@ const HighFive::Group targetIndex(const HighFive::Group& h5Root) {
     return h5Root.getGroup(TARGET_INDEX_GROUP);
 }
 
-Selection resolve(const HighFive::Group& indexGroup,
-                  const std::vector<NodeID>& nodeIDs,
-                  const Hdf5Reader& reader) {
+Selection::Ranges nodeRanges(const HighFive::Group& indexGroup,
+                             const std::vector<NodeID>& nodeIDs,
+                             const Hdf5Reader& reader) {
     auto node2ranges_dset = indexGroup.getDataSet(NODE_ID_TO_RANGES_DSET);
     auto node_dim = node2ranges_dset.getSpace().getDimensions()[0];
     auto sortedNodeIds = nodeIDs;
@@ -77,8 +79,12 @@ Selection resolve(const HighFive::Group& indexGroup,
         return range[0] >= range[1];
     });
 
-    primaryRange = bulk_read::sortAndMerge(primaryRange);
+    return bulk_read::sortAndMerge(primaryRange);
+}
 
+Selection resolveRanges(const HighFive::Group& indexGroup,
+                        const Selection::Ranges& primaryRange,
+                        const Hdf5Reader& reader) {
     auto secondaryRange = reader.readSelection<std::array<uint64_t, 2>>(
         indexGroup.getDataSet(RANGE_TO_EDGE_ID_DSET), primaryRange, RawIndex{{0, 2}});
 
@@ -88,82 +94,334 @@ Selection resolve(const HighFive::Group& indexGroup,
     return Selection(std::move(secondaryRange));
 }
 
-namespace {
-
-std::unordered_map<NodeID, RawIndex> _groupNodeRanges(const std::vector<NodeID>& nodeIDs) {
-    std::unordered_map<NodeID, RawIndex> result;
+Selection resolve(const HighFive::Group& indexGroup,
+                  const std::vector<NodeID>& nodeIDs,
+                  const Hdf5Reader& reader) {
+    return resolveRanges(indexGroup, nodeRanges(indexGroup, nodeIDs, reader), reader);
+}
 
-    if (nodeIDs.empty()) {
-        return result;
+Preloaded preload(const HighFive::Group& indexGroup, const Hdf5Reader& reader) {
+    const auto node2ranges_dset = indexGroup.getDataSet(NODE_ID_TO_RANGES_DSET);
+    const auto range2edges_dset = indexGroup.getDataSet(RANGE_TO_EDGE_ID_DSET);
+    const auto node_dim = node2ranges_dset.getSpace().getDimensions()[0];
+    const auto range_dim = range2edges_dset.getSpace().getDimensions()[0];
+
+    const auto primaryRange = reader.readSelection<std::array<uint64_t, 2>>(
+        node2ranges_dset, Selection(RawIndex{{0, node_dim}}), Selection(RawIndex{{0, 2}}));
+    const auto secondaryRange = reader.readSelection<std::array<uint64_t, 2>>(
+        range2edges_dset, Selection(RawIndex{{0, range_dim}}), Selection(RawIndex{{0, 2}}));
+
+    Preloaded index;
+    index.nodeOffsets.reserve(node_dim + 1);
+    index.nodeOffsets.push_back(0);
+    index.edgeRanges.reserve(secondaryRange.size());
+    for (const auto& range : primaryRange) {
+        if (range[0] < range[1]) {
+            if (range[1] > secondaryRange.size()) {
+                throw SonataError("Invalid index: 'node_id_to_ranges' is out of bounds");
+            }
+            const RawIndex nodeRanges(secondaryRange.begin() + static_cast<ptrdiff_t>(range[0]),
+                                      secondaryRange.begin() + static_cast<ptrdiff_t>(range[1]));
+            for (const auto& edges : bulk_read::sortAndMerge(nodeRanges)) {
+                index.edgeRanges.push_back(edges);
+            }
+        }
+        index.nodeOffsets.push_back(index.edgeRanges.size());
     }
+    index.edgeRanges.shrink_to_fit();
 
-    uint64_t rangeStart = 0;
-    NodeID lastNodeID = nodeIDs[rangeStart];
-    for (uint64_t i = 1; i < nodeIDs.size(); ++i) {
-        if (nodeIDs[i] != lastNodeID) {
-            result[lastNodeID].push_back({rangeStart, i});
-            rangeStart = i;
-            lastNodeID = nodeIDs[rangeStart];
+    return index;
+}
+
+Selection resolve(const Preloaded& index, const std::vector<NodeID>& nodeIDs) {
+    const size_t node_dim = index.nodeOffsets.size() - 1;
+    RawIndex edgeRanges;
+    for (const auto id : nodeIDs) {
+        // Out-of-range `nodeId`s have no edges, as with the on-disk index
+        if (id < node_dim) {
+            edgeRanges.insert(edgeRanges.end(),
+                              index.edgeRanges.begin() +
+                                  static_cast<ptrdiff_t>(index.nodeOffsets[id]),
+                              index.edgeRanges.begin() +
+                                  static_cast<ptrdiff_t>(index.nodeOffsets[id + 1]));
         }
     }
 
-    result[lastNodeID].push_back({rangeStart, nodeIDs.size()});
+    return Selection(bulk_read::sortAndMerge(edgeRanges));
+}
+
+EdgesPerNode resolvePerNode(const HighFive::Group& indexGroup,
+                            const std::vector<NodeID>& nodeIDs,
+                            const Hdf5Reader& reader) {
+    auto node2ranges_dset = indexGroup.getDataSet(NODE_ID_TO_RANGES_DSET);
+    auto node_dim = node2ranges_dset.getSpace().getDimensions()[0];
+    auto sortedNodeIds = nodeIDs;
+    bulk_read::detail::erase_if(sortedNodeIds, [node_dim](auto id) { return id >= node_dim; });
+    std::sort(sortedNodeIds.begin(), sortedNodeIds.end());
+    sortedNodeIds.erase(std::unique(sortedNodeIds.begin(), sortedNodeIds.end()),
+                        sortedNodeIds.end());
+
+    // One row of 'node_id_to_ranges' per node of `sortedNodeIds`
+    const auto primaryRange = reader.readSelection<std::array<uint64_t, 2>>(
+        node2ranges_dset, Selection::fromValues(sortedNodeIds), Selection(RawIndex{{0, 2}}));
+
+    // The rows of 'range_to_edge_id' of all nodes, read at once
+    const auto mergedPrimaryRange = bulk_read::sortAndMerge(primaryRange);
+    const auto secondaryRange = reader.readSelection<std::array<uint64_t, 2>>(
+        indexGroup.getDataSet(RANGE_TO_EDGE_ID_DSET), mergedPrimaryRange, RawIndex{{0, 2}});
+
+    // Where each range of `mergedPrimaryRange` starts in `secondaryRange`
+    std::vector<uint64_t> mergedOffsets;
+    mergedOffsets.reserve(mergedPrimaryRange.size());
+    uint64_t offset = 0;
+    for (const auto& range : mergedPrimaryRange) {
+        mergedOffsets.push_back(offset);
+        offset += range[1] - range[0];
+    }
+
+    const auto nodeEdges = [&](NodeID id) {
+        const auto it = std::lower_bound(sortedNodeIds.begin(), sortedNodeIds.end(), id);
+        if (it == sortedNodeIds.end() || *it != id) {
+            return RawIndex{};
+        }
+        const auto& range = primaryRange[static_cast<size_t>(it - sortedNodeIds.begin())];
+        if (range[0] >= range[1]) {
+            return RawIndex{};
+        }
+        // The merged range which contains `range`
+        const auto merged = std::upper_bound(mergedPrimaryRange.begin(),
+                                             mergedPrimaryRange.end(),
+                                             range[0],
+                                             [](uint64_t value, const std::array<uint64_t, 2>& r) {
+                                                 return value < r[0];
+                                             }) -
+                            1;
+        const auto begin = mergedOffsets[static_cast<size_t>(merged - mergedPrimaryRange.begin())] +
+                           (range[0] - (*merged)[0]);
+        return bulk_read::sortAndMerge(
+            RawIndex(secondaryRange.begin() + static_cast<ptrdiff_t>(begin),
+                     secondaryRange.begin() + static_cast<ptrdiff_t>(begin + range[1] - range[0])));
+    };
+
+    EdgesPerNode result;
+    result.offsets.reserve(nodeIDs.size() + 1);
+    result.offsets.push_back(0);
+    for (const auto id : nodeIDs) {
+        const auto edges = nodeEdges(id);
+        result.ranges.insert(result.ranges.end(), edges.begin(), edges.end());
+        result.offsets.push_back(result.ranges.size());
+    }
 
     return result;
 }
 
+EdgesPerNode resolvePerNode(const Preloaded& index, const std::vector<NodeID>& nodeIDs) {
+    const size_t node_dim = index.nodeOffsets.size() - 1;
+    EdgesPerNode result;
+    result.offsets.reserve(nodeIDs.size() + 1);
+    result.offsets.push_back(0);
+    for (const auto id : nodeIDs) {
+        if (id < node_dim) {
+            result.ranges.insert(result.ranges.end(),
+                                 index.edgeRanges.begin() +
+                                     static_cast<ptrdiff_t>(index.nodeOffsets[id]),
+                                 index.edgeRanges.begin() +
+                                     static_cast<ptrdiff_t>(index.nodeOffsets[id + 1]));
+        }
+        result.offsets.push_back(result.ranges.size());
+    }
 
-// Use only in the writing code below. General purpose reading should use the
-// Hdf5Reader interface.
-std::vector<NodeID> _readNodeIDs(const HighFive::Group& h5Root, const std::string& name) {
-    std::vector<NodeID> result;
-    h5Root.getDataSet(name).read(result);
     return result;
 }
 
+namespace {
+
+// Number of node IDs held in memory at once while writing the indices
+constexpr size_t NODE_ID_BLOCK_SIZE = size_t(1) << 22;
+// Number of rows of 'node_id_to_ranges' held in memory at once while writing the indices
+constexpr uint64_t RANGE_BLOCK_SIZE = uint64_t(1) << 24;
+// Number of rows of 'range_to_edge_id' buffered before they are written, scattered
+constexpr size_t RANGE_WRITE_BUFFER_SIZE = size_t(1) << 20;
+
+// A maximal range of consecutive edges `[start, end)` with the same node
+struct NodeRun {
+    NodeID node;
+    uint64_t start;
+    uint64_t end;
+};
+
+// A row of 'range_to_edge_id', holding the edges `[start, end)`
+struct RangeRow {
+    uint64_t row;
+    uint64_t start;
+    uint64_t end;
+};
+
+
+/** Write the buffered `rows` of 'range_to_edge_id' to `dset`, and clear them.
+ *
+ * The rows are sorted: if they are consecutive, as for edges sorted by the indexed node, they're
+ * written as a single block, otherwise as a set of elements.
+ */
+void _writeRangeRows(HighFive::DataSet& dset, std::vector<RangeRow>& rows) {
+    if (rows.empty()) {
+        return;
+    }
 
-void _writeIndexDataset(const RawIndex& data, const std::string& name, HighFive::Group& h5Group) {
-    auto dset = h5Group.createDataSet<uint64_t>(name, HighFive::DataSpace::From(data));
-    dset.write(data);
+    std::sort(rows.begin(), rows.end(), [](const RangeRow& lhs, const RangeRow& rhs) {
+        return lhs.row < rhs.row;
+    });
+    std::vector<uint64_t> values;
+    values.reserve(2 * rows.size());
+    for (const auto& row : rows) {
+        values.push_back(row.start);
+        values.push_back(row.end);
+    }
+
+    const uint64_t first = rows.front().row;
+    if (rows.back().row - first + 1 == rows.size()) {
+        dset.select({first, 0}, {rows.size(), 2}).write_raw(values.data());
+    } else {
+        std::vector<size_t> coordinates;
+        coordinates.reserve(4 * rows.size());
+        for (const auto& row : rows) {
+            const auto index = static_cast<size_t>(row.row);
+            coordinates.insert(coordinates.end(), {index, 0, index, 1});
+        }
+        dset.select(HighFive::ElementSet(coordinates)).write_raw(values.data());
+    }
+    rows.clear();
 }
 
 
-void _writeIndexGroup(const std::vector<NodeID>& nodeIDs,
-                      uint64_t nodeCount,
-                      HighFive::Group& h5Root,
-                      const std::string& name) {
-    auto indexGroup = h5Root.createGroup(name);
+/** Call `f(run)` for all `NodeRun`s of the nodes in `[nodeBegin, nodeEnd)`, in edge order.
+ *
+ * The node IDs of `dset` are streamed in blocks of `NODE_ID_BLOCK_SIZE`, and each block is
+ * scanned by up to `n_threads` threads. `f` is only called from the calling thread.
+ */
+template <class F>
+void _forEachNodeRun(const HighFive::DataSet& dset,
+                     NodeID nodeBegin,
+                     NodeID nodeEnd,
+                     size_t n_threads,
+                     F f) {
+    const uint64_t edgeCount = dset.getElementCount();
+    const size_t n_tasks = std::max(n_threads, size_t(1));
+
+    std::vector<NodeID> nodeIDs;
+    std::vector<std::vector<NodeRun>> taskRuns(n_tasks);
+    // The last run of the previous block, which might continue in the next one
+    nonstd::optional<NodeRun> pending;
+    NodeID previous = 0;
+
+    for (uint64_t offset = 0; offset < edgeCount; offset += NODE_ID_BLOCK_SIZE) {
+        const size_t count = static_cast<size_t>(
+            std::min<uint64_t>(NODE_ID_BLOCK_SIZE, edgeCount - offset));
+        dset.select({offset}, {count}).read(nodeIDs);
+
+        const auto isStart = [&](size_t i) {
+            if (i == 0) {
+                return offset == 0 || nodeIDs[0] != previous;
+            }
+            return nodeIDs[i] != nodeIDs[i - 1];
+        };
+
+        parallel_read::parallelFor(n_tasks, n_threads, [&](size_t task) {
+            auto& runs = taskRuns[task];
+            runs.clear();
+            const size_t begin = count * task / n_tasks;
+            const size_t end = count * (task + 1) / n_tasks;
+            for (size_t i = begin; i < end; ++i) {
+                const NodeID node = nodeIDs[i];
+                if (node < nodeBegin || node >= nodeEnd || !isStart(i)) {
+                    continue;
+                }
+                size_t j = i + 1;
+                while (j < count && nodeIDs[j] == node) {
+                    ++j;
+                }
+                runs.push_back({node, offset + i, offset + j});
+            }
+        });
+
+        if (pending) {
+            if (!isStart(0)) {
+                // Runs of other nodes than `pending->node` start at the first change, if any
+                size_t firstStart = 1;
+                while (firstStart < count && !isStart(firstStart)) {
+                    ++firstStart;
+                }
+                pending->end = offset + firstStart;
+            }
+            if (pending->end < offset + count) {
+                f(*pending);
+                pending = nonstd::nullopt;
+            }
+        }
 
-    auto nodeToRanges = _groupNodeRanges(nodeIDs);
-    const auto rangeCount =
-        std::accumulate(nodeToRanges.begin(),
-                        nodeToRanges.end(),
-                        uint64_t{0},
-                        [](uint64_t total, decltype(nodeToRanges)::const_reference item) {
-                            return total + item.second.size();
-                        });
+        for (const auto& runs : taskRuns) {
+            for (const auto& run : runs) {
+                if (run.end == offset + count && run.end < edgeCount) {
+                    pending = run;
+                } else {
+                    f(run);
+                }
+            }
+        }
 
-    RawIndex primaryIndex;
-    RawIndex secondaryIndex;
+        previous = nodeIDs.back();
+    }
 
-    primaryIndex.reserve(nodeCount);
-    secondaryIndex.reserve(rangeCount);
+    if (pending) {
+        f(*pending);
+    }
+}
 
-    uint64_t offset = 0;
-    for (NodeID nodeID = 0; nodeID < nodeCount; ++nodeID) {
-        const auto it = nodeToRanges.find(nodeID);
-        if (it == nodeToRanges.end()) {
-            primaryIndex.push_back({offset, offset});
-        } else {
-            auto& ranges = it->second;
-            primaryIndex.push_back({offset, offset + ranges.size()});
-            offset += ranges.size();
-            std::move(ranges.begin(), ranges.end(), std::back_inserter(secondaryIndex));
+
+void _writeIndexGroup(const HighFive::DataSet& nodeIDsDset,
+                      uint64_t nodeCount,
+                      size_t n_threads,
+                      HighFive::Group& h5Root,
+                      const std::string& name) {
+    // Node IDs out of `[0, nodeCount)` are left out of the index
+    std::vector<uint64_t> nodeOffsets(nodeCount + 1, 0);
+    _forEachNodeRun(nodeIDsDset, 0, nodeCount, n_threads, [&nodeOffsets](const NodeRun& run) {
+        ++nodeOffsets[run.node + 1];
+    });
+    std::partial_sum(nodeOffsets.begin(), nodeOffsets.end(), nodeOffsets.begin());
+    const uint64_t rangeCount = nodeOffsets.back();
+
+    auto indexGroup = h5Root.createGroup(name);
+    auto primaryDset = indexGroup.createDataSet<uint64_t>(NODE_ID_TO_RANGES_DSET,
+                                                          HighFive::DataSpace({nodeCount, 2}));
+    auto secondaryDset = indexGroup.createDataSet<uint64_t>(RANGE_TO_EDGE_ID_DSET,
+                                                            HighFive::DataSpace({rangeCount, 2}));
+
+    {
+        RawIndex buffer;
+        for (uint64_t nodeID = 0; nodeID < nodeCount; nodeID += RANGE_BLOCK_SIZE) {
+            const uint64_t count = std::min(RANGE_BLOCK_SIZE, nodeCount - nodeID);
+            buffer.resize(count);
+            for (uint64_t i = 0; i < count; ++i) {
+                buffer[i] = {nodeOffsets[nodeID + i], nodeOffsets[nodeID + i + 1]};
+            }
+            primaryDset.select({nodeID, 0}, {count, 2}).write(buffer);
         }
     }
 
-    _writeIndexDataset(primaryIndex, NODE_ID_TO_RANGES_DSET, indexGroup);
-    _writeIndexDataset(secondaryIndex, RANGE_TO_EDGE_ID_DSET, indexGroup);
+    // 'range_to_edge_id' is filled streaming the node IDs a second (and last) time: the row of
+    // each run is the next one of its node, starting from its offset. The rows are buffered, up
+    // to `RANGE_WRITE_BUFFER_SIZE`, and written together.
+    auto& cursors = nodeOffsets;  // No longer needed as such
+    std::vector<RangeRow> rows;
+    rows.reserve(static_cast<size_t>(std::min<uint64_t>(RANGE_WRITE_BUFFER_SIZE, rangeCount)));
+    _forEachNodeRun(nodeIDsDset, 0, nodeCount, n_threads, [&](const NodeRun& run) {
+        rows.push_back({cursors[run.node]++, run.start, run.end});
+        if (rows.size() == RANGE_WRITE_BUFFER_SIZE) {
+            _writeRangeRows(secondaryDset, rows);
+        }
+    });
+    _writeRangeRows(secondaryDset, rows);
 }
 
 }  // unnamed namespace
@@ -172,28 +430,32 @@ void _writeIndexGroup(const std::vector<NodeID>& nodeIDs,
 void write(HighFive::Group& h5Root,
            uint64_t sourceNodeCount,
            uint64_t targetNodeCount,
-           bool overwrite) {
+           bool overwrite,
+           size_t n_threads) {
     if (h5Root.exist(INDEX_GROUP)) {
-        if (overwrite) {
-            // TODO: remove INDEX_GROUP
-            throw SonataError("Index overwrite not implemented yet");
-        } else {
+        if (!overwrite) {
             throw SonataError("Index group already exists");
         }
+        h5Root.unlink(INDEX_GROUP);
     }
 
     try {
-        _writeIndexGroup(_readNodeIDs(h5Root, SOURCE_NODE_ID_DSET),
+        _writeIndexGroup(h5Root.getDataSet(SOURCE_NODE_ID_DSET),
                          sourceNodeCount,
+                         n_threads,
                          h5Root,
                          SOURCE_INDEX_GROUP);
-        _writeIndexGroup(_readNodeIDs(h5Root, TARGET_NODE_ID_DSET),
+        _writeIndexGroup(h5Root.getDataSet(TARGET_NODE_ID_DSET),
                          targetNodeCount,
+                         n_threads,
                          h5Root,
                          TARGET_INDEX_GROUP);
     } catch (...) {
         try {
-            // TODO: remove INDEX_GROUP
+            // Don't leave a partial index behind
+            if (h5Root.exist(INDEX_GROUP)) {
+                h5Root.unlink(INDEX_GROUP);
+            }
         } catch (...) {
         }
         throw;
@@ -9,7 +9,7 @@
 
 #pragma once
 
-#include <bbp/sonata/population.h>
+#include <bbp/sonata/edges.h>
 
 #include <highfive/H5File.hpp>
 #include <highfive/H5Group.hpp>
@@ -26,10 +26,44 @@ Selection resolve(const HighFive::Group& indexGroup,
                   const std::vector<NodeID>& nodeIDs,
                   const Hdf5Reader& reader);
 
+/** The sorted and merged rows of 'range_to_edge_id' listing the edges of `nodeIDs`.
+ *
+ * Their total size is the number of ranges `resolve` would read, without reading them.
+ */
+Selection::Ranges nodeRanges(const HighFive::Group& indexGroup,
+                             const std::vector<NodeID>& nodeIDs,
+                             const Hdf5Reader& reader);
+
+/** The edges listed in the rows `primaryRange` of 'range_to_edge_id', see `nodeRanges`.
+ */
+Selection resolveRanges(const HighFive::Group& indexGroup,
+                        const Selection::Ranges& primaryRange,
+                        const Hdf5Reader& reader);
+
+/** An index group held in memory, as compressed sparse rows.
+ *
+ * The edges of node `i` are `edgeRanges[nodeOffsets[i]:nodeOffsets[i + 1]]`, sorted and merged.
+ */
+struct Preloaded {
+    std::vector<uint64_t> nodeOffsets;
+    Selection::Ranges edgeRanges;
+};
+
+Preloaded preload(const HighFive::Group& indexGroup, const Hdf5Reader& reader);
+Selection resolve(const Preloaded& index, const std::vector<NodeID>& nodeIDs);
+
+/** The edges of each of `nodeIDs`, in order, reading the index group once.
+ */
+EdgesPerNode resolvePerNode(const HighFive::Group& indexGroup,
+                            const std::vector<NodeID>& nodeIDs,
+                            const Hdf5Reader& reader);
+EdgesPerNode resolvePerNode(const Preloaded& index, const std::vector<NodeID>& nodeIDs);
+
 void write(HighFive::Group& h5Root,
            uint64_t sourceNodeCount,
            uint64_t targetNodeCount,
-           bool overwrite);
+           bool overwrite,
+           size_t n_threads);
 
 }  // namespace edge_index
 }  // namespace sonata
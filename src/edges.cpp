@@ -7,6 +7,7 @@
  * See top-level COPYING.LESSER and COPYING files for details.
  *************************************************************************/
 
+#include "../extlib/filesystem.hpp"
 #include "edge_index.h"
 #include "hdf5_mutex.hpp"
 #include "population.hpp"
@@ -18,6 +19,12 @@
 #include <highfive/H5File.hpp>
 
 #include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <system_error>
+#include <tuple>
 
 
 namespace {
@@ -32,6 +39,90 @@ const char* const NODE_POPULATION_ATTR = "node_population";
 namespace bbp {
 namespace sonata {
 
+namespace {
+
+namespace fs = ghc::filesystem;
+
+// The node->edge indices loaded by `EdgePopulation::preloadIndices` so far, as long as some
+// population uses them, by file, population and what tells rewrites of the indices apart
+template <typename Indices>
+struct PreloadedIndicesCache {
+    // The canonical path of the file (which may be opened by several, relative, names), the path
+    // of the population group, the modification times of its source and target index groups
+    // (to the second, if HDF5 tracks them), the modification time (to the resolution of the file
+    // system) and size of the file, and the sizes of the index datasets
+    using Key = std::tuple<std::string,
+                           std::string,
+                           std::time_t,
+                           std::time_t,
+                           fs::file_time_type,
+                           std::uintmax_t,
+                           std::vector<size_t>>;
+
+    std::mutex mutex;
+    std::map<Key, std::weak_ptr<const Indices>> loaded;
+
+    static PreloadedIndicesCache& instance() {
+        static PreloadedIndicesCache cache;
+        return cache;
+    }
+
+    static std::string canonicalPath(const std::string& filename) {
+        return fs::weakly_canonical(fs::absolute(filename)).string();
+    }
+
+    // Forget the indices of the population `group` of `filename`, e.g. as they are written anew
+    void invalidate(const std::string& filename, const std::string& group) {
+        const auto path = canonicalPath(filename);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = loaded.begin(); it != loaded.end();) {
+            const bool match = std::get<0>(it->first) == path &&
+                               std::get<1>(it->first) == group;
+            it = match ? loaded.erase(it) : std::next(it);
+        }
+    }
+};
+
+// Return the number of elements of each dataset of the node->edge index group `index`
+std::vector<size_t> indexSizes(const HighFive::Group& index) {
+    std::vector<size_t> sizes;
+    for (const auto& name : index.listObjectNames()) {
+        if (index.getObjectType(name) == HighFive::ObjectType::Dataset) {
+            sizes.push_back(index.getDataSet(name).getElementCount());
+        }
+    }
+    return sizes;
+}
+
+// Keep the edges of `selection` whose node ID, listed in `nodeIDs`, is in `sortedNodeIDs`
+Selection _filterEdges(const Selection& selection,
+                       const std::vector<NodeID>& nodeIDs,
+                       const std::vector<NodeID>& sortedNodeIDs) {
+    Selection::Ranges result;
+    size_t i = 0;
+    for (const auto& range : selection.ranges()) {
+        for (auto edgeID = range[0]; edgeID < range[1]; ++edgeID, ++i) {
+            if (!std::binary_search(sortedNodeIDs.begin(), sortedNodeIDs.end(), nodeIDs[i])) {
+                continue;
+            }
+            if (!result.empty() && result.back()[1] == edgeID) {
+                ++result.back()[1];
+            } else {
+                result.push_back({edgeID, edgeID + 1});
+            }
+        }
+    }
+
+    return Selection(std::move(result));
+}
+
+}  // unnamed namespace
+
+struct EdgePopulation::PreloadedIndices {
+    edge_index::Preloaded source;
+    edge_index::Preloaded target;
+};
+
 //--------------------------------------------------------------------------------------------------
 //
 EdgePopulation::EdgePopulation(const std::string& h5FilePath,
@@ -77,12 +168,18 @@ std::vector<NodeID> EdgePopulation::targetNodeIDs(const Selection& selection) co
 
 
 Selection EdgePopulation::afferentEdges(const std::vector<NodeID>& target) const {
+    if (preloaded_) {
+        return edge_index::resolve(preloaded_->target, target);
+    }
     HDF5_LOCK_GUARD
     return edge_index::resolve(edge_index::targetIndex(impl_->h5Root), target, impl_->hdf5_reader);
 }
 
 
 Selection EdgePopulation::efferentEdges(const std::vector<NodeID>& source) const {
+    if (preloaded_) {
+        return edge_index::resolve(preloaded_->source, source);
+    }
     HDF5_LOCK_GUARD
     return edge_index::resolve(edge_index::sourceIndex(impl_->h5Root), source, impl_->hdf5_reader);
 }
@@ -90,14 +187,121 @@ Selection EdgePopulation::efferentEdges(const std::vector<NodeID>& source) const
 
 Selection EdgePopulation::connectingEdges(const std::vector<NodeID>& source,
                                           const std::vector<NodeID>& target) const {
-    // TODO optimize: range intersection
-    const auto pre = efferentEdges(source).flatten();
-    const auto post = afferentEdges(target).flatten();
-    assert(std::is_sorted(pre.begin(), pre.end()));  // return result of _resolveIndex is sorted
-    assert(std::is_sorted(post.begin(), post.end()));
-    Selection::Values result;
-    set_intersection(pre.begin(), pre.end(), post.begin(), post.end(), std::back_inserter(result));
-    return Selection::fromValues(result);
+    if (preloaded_) {
+        return edge_index::resolve(preloaded_->source, source) &
+               edge_index::resolve(preloaded_->target, target);
+    }
+
+    HDF5_LOCK_GUARD
+    const auto& reader = impl_->hdf5_reader;
+    const auto sourceIndex = edge_index::sourceIndex(impl_->h5Root);
+    const auto targetIndex = edge_index::targetIndex(impl_->h5Root);
+    const auto sourceDset = impl_->h5Root.getDataSet(SOURCE_NODE_ID_DSET);
+    const auto targetDset = impl_->h5Root.getDataSet(TARGET_NODE_ID_DSET);
+
+    // Instead of flattening the edges of both sides, only the side with fewer ranges is
+    // resolved. Its edges are then either filtered on their other node ID, if there are fewer
+    // of them than the other side has ranges, or intersected with the ranges of the other side.
+    //
+    // To keep this MPI-collective, every read happens regardless of the branch taken, with an
+    // empty selection when it's not needed.
+    const auto sourceRanges = edge_index::nodeRanges(sourceIndex, source, reader);
+    const auto targetRanges = edge_index::nodeRanges(targetIndex, target, reader);
+    const size_t sourceRangeCount = Selection(sourceRanges).flatSize();
+    const size_t targetRangeCount = Selection(targetRanges).flatSize();
+    const bool sourceIsSmaller = sourceRangeCount <= targetRangeCount;
+
+    const Selection::Ranges none;
+    const auto sourceEdges =
+        edge_index::resolveRanges(sourceIndex, sourceIsSmaller ? sourceRanges : none, reader);
+    const auto targetEdges =
+        edge_index::resolveRanges(targetIndex, sourceIsSmaller ? none : targetRanges, reader);
+    const auto& edges = sourceIsSmaller ? sourceEdges : targetEdges;
+
+    const bool filter = edges.flatSize() <= (sourceIsSmaller ? targetRangeCount
+                                                             : sourceRangeCount);
+    const auto sourceIDs = reader.readSelection<NodeID>(
+        sourceDset, filter && !sourceIsSmaller ? edges : Selection({}));
+    const auto targetIDs = reader.readSelection<NodeID>(
+        targetDset, filter && sourceIsSmaller ? edges : Selection({}));
+
+    const auto otherSourceEdges = edge_index::resolveRanges(
+        sourceIndex, !filter && !sourceIsSmaller ? sourceRanges : none, reader);
+    const auto otherTargetEdges = edge_index::resolveRanges(
+        targetIndex, !filter && sourceIsSmaller ? targetRanges : none, reader);
+
+    if (filter) {
+        auto sortedNodeIDs = sourceIsSmaller ? target : source;
+        std::sort(sortedNodeIDs.begin(), sortedNodeIDs.end());
+        return _filterEdges(edges, sourceIsSmaller ? targetIDs : sourceIDs, sortedNodeIDs);
+    }
+
+    return edges & (sourceIsSmaller ? otherTargetEdges : otherSourceEdges);
+}
+
+
+EdgesPerNode EdgePopulation::afferentEdgesPerNode(const std::vector<NodeID>& target) const {
+    if (preloaded_) {
+        return edge_index::resolvePerNode(preloaded_->target, target);
+    }
+    HDF5_LOCK_GUARD
+    return edge_index::resolvePerNode(edge_index::targetIndex(impl_->h5Root),
+                                      target,
+                                      impl_->hdf5_reader);
+}
+
+
+EdgesPerNode EdgePopulation::efferentEdgesPerNode(const std::vector<NodeID>& source) const {
+    if (preloaded_) {
+        return edge_index::resolvePerNode(preloaded_->source, source);
+    }
+    HDF5_LOCK_GUARD
+    return edge_index::resolvePerNode(edge_index::sourceIndex(impl_->h5Root),
+                                      source,
+                                      impl_->hdf5_reader);
+}
+
+
+void EdgePopulation::preloadIndices() {
+    using Cache = PreloadedIndicesCache<PreloadedIndices>;
+    auto& cache = Cache::instance();
+
+    HDF5_LOCK_GUARD
+    const auto sourceIndex = edge_index::sourceIndex(impl_->h5Root);
+    const auto targetIndex = edge_index::targetIndex(impl_->h5Root);
+    // Indices rewritten in place, e.g. by another process, are told apart by the times and sizes
+    // of the file and of the indices; those of the file are the same error values each time if
+    // it can't be read
+    const auto path = Cache::canonicalPath(impl_->h5File.getName());
+    std::error_code error;
+    auto sizes = indexSizes(sourceIndex);
+    const auto targetSizes = indexSizes(targetIndex);
+    sizes.insert(sizes.end(), targetSizes.begin(), targetSizes.end());
+    const Cache::Key key{path,
+                         impl_->h5Root.getPath(),
+                         sourceIndex.getInfo().getModificationTime(),
+                         targetIndex.getInfo().getModificationTime(),
+                         fs::last_write_time(path, error),
+                         fs::file_size(path, error),
+                         std::move(sizes)};
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto& loaded = cache.loaded;
+    auto indices = loaded[key].lock();
+    if (!indices) {
+        for (auto it = loaded.begin(); it != loaded.end();) {
+            it = it->second.expired() ? loaded.erase(it) : std::next(it);
+        }
+        indices = std::make_shared<const PreloadedIndices>(
+            PreloadedIndices{edge_index::preload(sourceIndex, impl_->hdf5_reader),
+                             edge_index::preload(targetIndex, impl_->hdf5_reader)});
+        loaded[key] = indices;
+    }
+    preloaded_ = std::move(indices);
+}
+
+
+bool EdgePopulation::hasPreloadedIndices() const {
+    return preloaded_ != nullptr;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -106,11 +310,13 @@ void EdgePopulation::writeIndices(const std::string& h5FilePath,
                                   const std::string& population,
                                   uint64_t sourceNodeCount,
                                   uint64_t targetNodeCount,
-                                  bool overwrite) {
+                                  bool overwrite,
+                                  size_t n_threads) {
     HDF5_LOCK_GUARD
     HighFive::File h5File(h5FilePath, HighFive::File::ReadWrite);
     auto h5Root = h5File.getGroup(fmt::format("/edges/{}", population));
-    edge_index::write(h5Root, sourceNodeCount, targetNodeCount, overwrite);
+    edge_index::write(h5Root, sourceNodeCount, targetNodeCount, overwrite, n_threads);
+    PreloadedIndicesCache<PreloadedIndices>::instance().invalidate(h5FilePath, h5Root.getPath());
 }
 
 
@@ -44,5 +44,20 @@ HighFive::File Hdf5Reader::openFile(const std::string& filename) const {
     return impl->openFile(filename);
 }
 
+Hdf5Reader makeParallelHdf5Reader(size_t n_threads) {
+    if (n_threads <= 1) {
+        return Hdf5Reader();
+    }
+
+    return Hdf5Reader(
+        std::make_shared<Hdf5PluginParallel<Hdf5Reader::supported_1D_types,
+                                            Hdf5Reader::supported_2D_types>>(n_threads));
+}
+
+Hdf5Reader makeMappedHdf5Reader() {
+    return Hdf5Reader(std::make_shared<Hdf5PluginMapped<Hdf5Reader::supported_1D_types,
+                                                        Hdf5Reader::supported_2D_types>>());
+}
+
 }  // namespace sonata
 }  // namespace bbp
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "mapped_file.hpp"
+#include "parallel_read.hpp"
 #include "read_canonical_selection.hpp"
 
+#include <type_traits>
+
 namespace bbp {
 namespace sonata {
 HighFive::File openHDF5withoutLock(const std::string& path);
@@ -18,6 +22,59 @@ HighFive::HyperSlab _makeHyperslab(const std::vector<Range>& ranges) {
 
     return slab;
 }
+
+template <class T>
+std::vector<T> readSelectionParallel(const HighFive::DataSet& dset,
+                                     const Selection& selection,
+                                     size_t n_threads,
+                                     std::true_type /* is_arithmetic */) {
+    const auto& ranges = selection.ranges();
+    const auto dims = dset.getDimensions();
+    // Out of bounds selections are left to HDF5, which reports them
+    if (dims.size() == 1 && (ranges.empty() || std::get<1>(ranges.back()) <= dims[0])) {
+        const auto location = parallel_read::getRawLocation(dset, HighFive::create_datatype<T>());
+        if (location) {
+            const parallel_read::RawFile file(location->filename);
+            return parallel_read::readRanges<T>(file, location->offset, ranges, n_threads);
+        }
+    }
+
+    return readCanonicalSelection<T>(dset, selection);
+}
+
+template <class T>
+std::vector<T> readSelectionParallel(const HighFive::DataSet& dset,
+                                     const Selection& selection,
+                                     size_t /* n_threads */,
+                                     std::false_type /* is_arithmetic */) {
+    return readCanonicalSelection<T>(dset, selection);
+}
+
+template <class T>
+std::vector<T> readSelectionMapped(const HighFive::DataSet& dset,
+                                   const Selection& selection,
+                                   MappedFiles& files,
+                                   std::true_type /* is_arithmetic */) {
+    const auto& ranges = selection.ranges();
+    const auto dims = dset.getDimensions();
+    // Out of bounds selections are left to HDF5, which reports them
+    if (dims.size() == 1 && (ranges.empty() || std::get<1>(ranges.back()) <= dims[0])) {
+        const auto location = parallel_read::getRawLocation(dset, HighFive::create_datatype<T>());
+        if (location) {
+            return readMappedRanges<T>(*files.open(location->filename), location->offset, ranges);
+        }
+    }
+
+    return readCanonicalSelection<T>(dset, selection);
+}
+
+template <class T>
+std::vector<T> readSelectionMapped(const HighFive::DataSet& dset,
+                                   const Selection& selection,
+                                   MappedFiles& /* files */,
+                                   std::false_type /* is_arithmetic */) {
+    return readCanonicalSelection<T>(dset, selection);
+}
 }  // namespace detail
 
 template <class T>
@@ -40,6 +97,50 @@ class Hdf5PluginRead2DDefault: virtual public Hdf5PluginRead2DInterface<T>
         return detail::readCanonicalSelection<T>(dset, xsel, ysel);
     }
 };
+
+/// Reads contiguous datasets of numbers directly from the file, with several threads.
+///
+/// Anything else (chunked or compressed datasets, strings, ...) is read like
+/// `Hdf5PluginRead1DDefault` does.
+template <class T>
+class Hdf5PluginRead1DParallel: virtual public Hdf5PluginRead1DInterface<T>
+{
+  public:
+    explicit Hdf5PluginRead1DParallel(size_t n_threads)
+        : n_threads_(n_threads) { }
+
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& selection) const override {
+        return detail::readSelectionParallel<T>(dset,
+                                                selection,
+                                                n_threads_,
+                                                std::is_arithmetic<T>{});
+    }
+
+  private:
+    size_t n_threads_;
+};
+
+/// Reads contiguous datasets of numbers straight from a memory mapping of the file.
+///
+/// Anything else (chunked or compressed datasets, strings, ...) is read like
+/// `Hdf5PluginRead1DDefault` does.
+template <class T>
+class Hdf5PluginRead1DMapped: virtual public Hdf5PluginRead1DInterface<T>
+{
+  public:
+    explicit Hdf5PluginRead1DMapped(std::shared_ptr<MappedFiles> files)
+        : files_(std::move(files)) { }
+
+    std::vector<T> readSelection(const HighFive::DataSet& dset,
+                                 const Selection& selection) const override {
+        return detail::readSelectionMapped<T>(dset, selection, *files_, std::is_arithmetic<T>{});
+    }
+
+  private:
+    std::shared_ptr<MappedFiles> files_;
+};
+
 template <class T, class U>
 class Hdf5PluginDefault;
 
@@ -55,6 +156,42 @@ class Hdf5PluginDefault<std::tuple<Ts...>, std::tuple<Us...>>
     }
 };
 
+template <class T, class U>
+class Hdf5PluginParallel;
+
+template <class... Ts, class... Us>
+class Hdf5PluginParallel<std::tuple<Ts...>, std::tuple<Us...>>
+    : virtual public Hdf5PluginInterface<std::tuple<Ts...>, std::tuple<Us...>>,
+      virtual public Hdf5PluginRead1DParallel<Ts>...,
+      virtual public Hdf5PluginRead2DDefault<Us>...
+{
+  public:
+    explicit Hdf5PluginParallel(size_t n_threads)
+        : Hdf5PluginRead1DParallel<Ts>(n_threads)... { }
+
+    HighFive::File openFile(const std::string& path) const override {
+        return openHDF5withoutLock(path);
+    }
+};
+
+template <class T, class U>
+class Hdf5PluginMapped;
+
+template <class... Ts, class... Us>
+class Hdf5PluginMapped<std::tuple<Ts...>, std::tuple<Us...>>
+    : virtual public Hdf5PluginInterface<std::tuple<Ts...>, std::tuple<Us...>>,
+      virtual public Hdf5PluginRead1DMapped<Ts>...,
+      virtual public Hdf5PluginRead2DDefault<Us>...
+{
+  public:
+    // The mappings are shared by all types, and kept as long as the plugin
+    explicit Hdf5PluginMapped(std::shared_ptr<MappedFiles> files = std::make_shared<MappedFiles>())
+        : Hdf5PluginRead1DMapped<Ts>(files)... { }
+
+    HighFive::File openFile(const std::string& path) const override {
+        return openHDF5withoutLock(path);
+    }
+};
 
 }  // namespace sonata
 }  // namespace bbp
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <highfive/H5DataSet.hpp>
+
+namespace bbp {
+namespace sonata {
+namespace io_planner {
+
+/** How a dataset is stored in the file, as far as planning reads is concerned.
+ */
+struct StorageLayout {
+    /// True if the dataset is split into chunks, false for contiguous (or compact) datasets.
+    bool chunked = false;
+    /// True if a filter (e.g. compression) is applied to the chunks.
+    bool filtered = false;
+    /// Size of a chunk along each dimension; empty unless `chunked`.
+    std::vector<size_t> chunk_dims;
+
+    /** Number of elements of a chunk along dimension `dim`; 1 if the dataset is not chunked.
+     */
+    size_t chunkSize(size_t dim) const {
+        return (chunked && dim < chunk_dims.size()) ? chunk_dims[dim] : 1;
+    }
+
+    /** Number of elements along dimension `dim` that reads shouldn't split: the chunk size if
+     * the chunks are filtered, as each read touching one then decompresses all of it; 1
+     * otherwise, since HDF5 reads just the selected part of unfiltered chunks.
+     */
+    size_t filteredChunkSize(size_t dim) const {
+        return filtered ? chunkSize(dim) : 1;
+    }
+};
+
+/** Query the storage layout of `dset` from its creation property list.
+ */
+inline StorageLayout getStorageLayout(const HighFive::DataSet& dset) {
+    StorageLayout layout;
+
+    const hid_t plist = H5Dget_create_plist(dset.getId());
+    if (plist < 0) {
+        return layout;
+    }
+
+    if (H5Pget_layout(plist) == H5D_CHUNKED) {
+        const int rank = H5Pget_chunk(plist, 0, nullptr);
+        if (rank > 0) {
+            std::vector<hsize_t> dims(static_cast<size_t>(rank));
+            H5Pget_chunk(plist, rank, dims.data());
+
+            layout.chunked = true;
+            layout.filtered = H5Pget_nfilters(plist) > 0;
+            layout.chunk_dims.assign(dims.begin(), dims.end());
+        }
+    }
+
+    H5Pclose(plist);
+    return layout;
+}
+
+}  // namespace io_planner
+}  // namespace sonata
+}  // namespace bbp
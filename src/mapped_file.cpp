@@ -0,0 +1,95 @@
+#include "mapped_file.hpp"
+
+#include <cerrno>
+#include <cstring>  // std::strerror
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SONATA_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bbp {
+namespace sonata {
+
+#ifdef SONATA_HAS_MMAP
+MappedFile::MappedFile(const std::string& filename)
+    : filename_(filename)
+    , data_(nullptr)
+    , size_(0) {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw SonataError(
+            fmt::format("Unable to open '{}' for reading: {}", filename_, std::strerror(errno)));
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw SonataError(fmt::format("Unable to stat '{}': {}", filename_, std::strerror(error)));
+    }
+
+    size_ = static_cast<size_t>(status.st_size);
+    device_ = static_cast<uint64_t>(status.st_dev);
+    inode_ = static_cast<uint64_t>(status.st_ino);
+    mtime_ = static_cast<int64_t>(status.st_mtime);
+    if (size_ > 0) {
+        void* const data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            const int error = errno;
+            ::close(fd);
+            throw SonataError(
+                fmt::format("Unable to map '{}': {}", filename_, std::strerror(error)));
+        }
+        data_ = static_cast<const char*>(data);
+    }
+
+    // The mapping stays valid after closing the file
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+bool MappedFile::isCurrent() const {
+    struct stat status;
+    return ::stat(filename_.c_str(), &status) == 0 &&
+           static_cast<uint64_t>(status.st_dev) == device_ &&
+           static_cast<uint64_t>(status.st_ino) == inode_ &&
+           static_cast<size_t>(status.st_size) == size_ &&
+           static_cast<int64_t>(status.st_mtime) == mtime_;
+}
+#else
+MappedFile::MappedFile(const std::string& filename)
+    : filename_(filename)
+    , data_(nullptr)
+    , size_(0) {
+    throw SonataError("Memory-mapped files are not supported on this platform");
+}
+
+MappedFile::~MappedFile() = default;
+
+bool MappedFile::isCurrent() const {
+    return false;
+}
+#endif
+
+const char* MappedFile::bytes(uint64_t offset, size_t count) const {
+    if (offset > size_ || count > size_ - offset) {
+        throw SonataError(fmt::format("Unable to read {} bytes at offset {} of '{}': out of bounds",
+                                      count,
+                                      offset,
+                                      filename_));
+    }
+
+    return data_ + offset;
+}
+
+}  // namespace sonata
+}  // namespace bbp
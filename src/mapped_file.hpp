@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>  // std::memcpy
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <highfive/H5DataSet.hpp>
+
+#include <bbp/sonata/population.h>
+
+#include "parallel_read.hpp"
+#include "read_bulk.hpp"
+
+namespace bbp {
+namespace sonata {
+
+/** A read-only memory mapping of a whole file.
+ */
+class MappedFile
+{
+  public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    /** Return `count` bytes at byte `offset`, throw if they are not all in the file.
+     */
+    const char* bytes(uint64_t offset, size_t count) const;
+
+    /** Whether the filename still names the mapped file, unchanged: same device, inode, size and
+     * modification time.
+     */
+    bool isCurrent() const;
+
+  private:
+    std::string filename_;
+    const char* data_;
+    size_t size_;
+    // Identity of the mapped file, see `isCurrent`
+    uint64_t device_ = 0;
+    uint64_t inode_ = 0;
+    int64_t mtime_ = 0;
+};
+
+/** The mappings of the files read so far, kept until this object is destroyed.
+ *
+ * A file replaced, or modified, since it was mapped is mapped anew; the previous mapping is
+ * released once no longer used.
+ */
+class MappedFiles
+{
+  public:
+    std::shared_ptr<const MappedFile> open(const std::string& filename) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& file = files_[filename];
+        if (!file || !file->isCurrent()) {
+            file = std::make_shared<const MappedFile>(filename);
+        }
+        return file;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<const MappedFile>> files_;
+};
+
+/** Return a view of all the values of the one-dimensional dataset `dset`, mapped from its file.
+ *
+ * \throw if the dataset is not stored contiguously with exactly the type `T`, or if its values
+ * are not aligned in the file.
+ */
+template <class T>
+MappedArray<T> mapDataSet(const HighFive::DataSet& dset) {
+    const auto dims = dset.getDimensions();
+    if (dims.size() != 1) {
+        throw SonataError(fmt::format("Dataset '{}' is not one-dimensional", dset.getPath()));
+    }
+    if (dims[0] == 0) {
+        return MappedArray<T>();
+    }
+
+    const auto location = parallel_read::getRawLocation(dset, HighFive::create_datatype<T>());
+    if (!location) {
+        throw SonataError(
+            fmt::format("Dataset '{}' can't be memory-mapped: it must be stored contiguously, "
+                        "uncompressed and with the requested type",
+                        dset.getPath()));
+    }
+
+    auto file = std::make_shared<const MappedFile>(location->filename);
+    const char* const bytes = file->bytes(location->offset, dims[0] * sizeof(T));
+    if (reinterpret_cast<uintptr_t>(bytes) % alignof(T) != 0) {
+        throw SonataError(fmt::format("Dataset '{}' can't be memory-mapped: its values are not "
+                                      "aligned in the file",
+                                      dset.getPath()));
+    }
+
+    return MappedArray<T>(std::move(file), reinterpret_cast<const T*>(bytes), dims[0]);
+}
+
+/** Copy the elements of `ranges` of a one-dimensional dataset stored at `offset` in `file`.
+ */
+template <class T>
+std::vector<T> readMappedRanges(const MappedFile& file,
+                                uint64_t offset,
+                                const Selection::Ranges& ranges) {
+    std::vector<T> values(bulk_read::detail::flatSize(ranges));
+    size_t i = 0;
+    for (const auto& range : ranges) {
+        const size_t count = std::get<1>(range) - std::get<0>(range);
+        // The values might not be aligned in the file, hence the memcpy
+        std::memcpy(values.data() + i,
+                    file.bytes(offset + std::get<0>(range) * sizeof(T), count * sizeof(T)),
+                    count * sizeof(T));
+        i += count;
+    }
+
+    return values;
+}
+
+}  // namespace sonata
+}  // namespace bbp
@@ -0,0 +1,138 @@
+#include "parallel_read.hpp"
+
+#include <cerrno>
+#include <cstring>  // std::strerror
+#include <system_error>
+
+#include <fmt/format.h>
+#include <hdf5.h>
+
+#include <bbp/sonata/common.h>
+
+#include "../extlib/filesystem.hpp"
+#include "io_planner.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SONATA_HAS_PREAD 1
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bbp {
+namespace sonata {
+namespace parallel_read {
+
+nonstd::optional<RawLocation> getRawLocation(const HighFive::DataSet& dset,
+                                             const HighFive::DataType& mem_type) {
+#ifdef SONATA_HAS_PREAD
+    if (io_planner::getStorageLayout(dset).chunked || dset.getDataType() != mem_type) {
+        return nonstd::nullopt;
+    }
+
+    // Undefined for compact, external or not yet allocated datasets
+    const haddr_t offset = H5Dget_offset(dset.getId());
+    if (offset == HADDR_UNDEF) {
+        return nonstd::nullopt;
+    }
+
+    const hid_t file_id = H5Iget_file_id(dset.getId());
+    if (file_id < 0) {
+        return nonstd::nullopt;
+    }
+
+    // Other drivers (e.g. family, core) don't map addresses to offsets in a single file
+    bool is_sec2 = false;
+    const hid_t fapl = H5Fget_access_plist(file_id);
+    if (fapl >= 0) {
+        is_sec2 = H5Pget_driver(fapl) == H5FD_SEC2;
+        H5Pclose(fapl);
+    }
+
+    std::string filename;
+    const ssize_t length = H5Fget_name(file_id, nullptr, 0);
+    if (length > 0) {
+        std::vector<char> buffer(static_cast<size_t>(length) + 1);
+        H5Fget_name(file_id, buffer.data(), buffer.size());
+        filename.assign(buffer.data(), static_cast<size_t>(length));
+    }
+
+    // The name is the one the file was opened by, possibly relative to another working directory
+    // than the current one, or the file since replaced: it is made absolute, and used only if it
+    // still names the file read by HDF5
+    bool is_same_file = false;
+    if (is_sec2 && !filename.empty()) {
+        std::error_code error;
+        filename = ghc::filesystem::absolute(filename, error).string();
+        void* handle = nullptr;
+        struct stat opened = {};
+        struct stat named = {};
+        if (H5Fget_vfd_handle(file_id, H5P_DEFAULT, &handle) >= 0 && handle != nullptr &&
+            ::fstat(*static_cast<int*>(handle), &opened) == 0 &&
+            ::stat(filename.c_str(), &named) == 0) {
+            is_same_file = opened.st_dev == named.st_dev && opened.st_ino == named.st_ino;
+        }
+    }
+    H5Fclose(file_id);
+
+    if (!is_same_file) {
+        return nonstd::nullopt;
+    }
+
+    return RawLocation{filename, static_cast<uint64_t>(offset)};
+#else
+    (void) dset;
+    (void) mem_type;
+    return nonstd::nullopt;
+#endif
+}
+
+#ifdef SONATA_HAS_PREAD
+RawFile::RawFile(const std::string& filename)
+    : filename_(filename)
+    , fd_(::open(filename.c_str(), O_RDONLY)) {
+    if (fd_ < 0) {
+        throw SonataError(
+            fmt::format("Unable to open '{}' for reading: {}", filename_, std::strerror(errno)));
+    }
+}
+
+RawFile::~RawFile() {
+    ::close(fd_);
+}
+
+void RawFile::read(void* buffer, size_t size, uint64_t offset) const {
+    auto* out = static_cast<char*>(buffer);
+    while (size > 0) {
+        const ssize_t n = ::pread(fd_, out, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw SonataError(fmt::format("Unable to read {} bytes at offset {} of '{}'",
+                                          size,
+                                          offset,
+                                          filename_));
+        }
+        out += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+#else
+RawFile::RawFile(const std::string& filename)
+    : filename_(filename)
+    , fd_(-1) {
+    throw SonataError("Positional reads are not supported on this platform");
+}
+
+RawFile::~RawFile() = default;
+
+void RawFile::read(void*, size_t, uint64_t) const {
+    LIBSONATA_THROW_IF_REACHED
+}
+#endif
+
+}  // namespace parallel_read
+}  // namespace sonata
+}  // namespace bbp
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <highfive/H5DataSet.hpp>
+
+#include <bbp/sonata/optional.hpp>
+#include <bbp/sonata/selection.h>
+
+namespace bbp {
+namespace sonata {
+namespace parallel_read {
+
+/** Where the raw bytes of a dataset are found on disk.
+ */
+struct RawLocation {
+    /// Absolute path of the file.
+    std::string filename;
+    /// Byte offset of the first element of the dataset in `filename`.
+    uint64_t offset;
+};
+
+/** Return where the raw bytes of `dset` are, if they can be read directly from the file.
+ *
+ * That is the case if the dataset is stored contiguously (hence unfiltered) in a file opened
+ * with the default driver, and its datatype is `mem_type`, i.e. the bytes on disk are the values
+ * in memory. The name the file was opened by, made absolute, must also still name that file: it
+ * may be relative to a former working directory, or the file replaced. Otherwise, or if the
+ * platform doesn't support positional reads, return `nonstd::nullopt` and the dataset must be
+ * read through HDF5.
+ *
+ * The HDF5 calls needed are not thread-safe, but nothing else is: the bytes can be read
+ * concurrently from as many threads as needed.
+ */
+nonstd::optional<RawLocation> getRawLocation(const HighFive::DataSet& dset,
+                                             const HighFive::DataType& mem_type);
+
+/** A read-only file which can be read from several threads at the same time.
+ */
+class RawFile
+{
+  public:
+    explicit RawFile(const std::string& filename);
+    ~RawFile();
+
+    RawFile(const RawFile&) = delete;
+    RawFile& operator=(const RawFile&) = delete;
+
+    /** Read `size` bytes at byte `offset` into `buffer`.
+     */
+    void read(void* buffer, size_t size, uint64_t offset) const;
+
+  private:
+    std::string filename_;
+    int fd_;
+};
+
+/** Call `f(i)` for all `i` in `[0, n_tasks)`, using up to `n_threads` threads.
+ *
+ * The calling thread is one of them. If any call throws, the remaining tasks are skipped and
+ * the first exception is rethrown.
+ */
+template <class F>
+void parallelFor(size_t n_tasks, size_t n_threads, F f) {
+    n_threads = std::min(n_threads, n_tasks);
+    if (n_threads <= 1) {
+        for (size_t i = 0; i < n_tasks; ++i) {
+            f(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_task{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    const auto worker = [&]() {
+        for (size_t i = next_task++; i < n_tasks; i = next_task++) {
+            try {
+                f(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next_task = n_tasks;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads - 1);
+    for (size_t i = 1; i < n_threads; ++i) {
+        try {
+            threads.emplace_back(worker);
+        } catch (const std::system_error&) {
+            break;  // Carry on with the threads we have
+        }
+    }
+    worker();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/** Read the elements of `ranges` of a one-dimensional dataset stored at `offset` in `file`.
+ *
+ * The ranges are split into blocks of about `block_size` bytes, read by up to `n_threads`
+ * threads.
+ */
+template <class T>
+std::vector<T> readRanges(const RawFile& file,
+                          uint64_t offset,
+                          const Selection::Ranges& ranges,
+                          size_t n_threads,
+                          size_t block_size = 4 * (1 << 20)) {
+    struct Piece {
+        uint64_t begin;
+        size_t count;
+        size_t out;
+    };
+
+    const size_t max_count = std::max<size_t>(1, block_size / sizeof(T));
+
+    // Cut large ranges, then group small ones, so that each task reads about `block_size` bytes
+    std::vector<Piece> pieces;
+    std::vector<size_t> tasks{0};
+    size_t size = 0;
+    size_t task_size = 0;
+    for (const auto& range : ranges) {
+        for (uint64_t begin = std::get<0>(range); begin < std::get<1>(range);) {
+            const size_t count = std::min<size_t>(max_count, std::get<1>(range) - begin);
+            if (task_size > 0 && task_size + count > max_count) {
+                tasks.push_back(pieces.size());
+                task_size = 0;
+            }
+            pieces.push_back({begin, count, size});
+            begin += count;
+            size += count;
+            task_size += count;
+        }
+    }
+    tasks.push_back(pieces.size());
+
+    std::vector<T> values(size);
+    parallelFor(tasks.size() - 1, n_threads, [&](size_t task) {
+        for (size_t i = tasks[task]; i < tasks[task + 1]; ++i) {
+            const auto& piece = pieces[i];
+            file.read(values.data() + piece.out,
+                      piece.count * sizeof(T),
+                      offset + piece.begin * sizeof(T));
+        }
+    });
+
+    return values;
+}
+
+}  // namespace parallel_read
+}  // namespace sonata
+}  // namespace bbp
@@ -16,6 +16,7 @@
 #include <fmt/format.h>
 #include <highfive/H5File.hpp>
 
+#include "mapped_file.hpp"
 #include "population.hpp"
 #include "read_bulk.hpp"
 
@@ -117,6 +118,13 @@ std::vector<T> Population::getAttribute(const std::string& name, const Selection
 }
 
 
+template <typename T>
+MappedArray<T> Population::getAttributeView(const std::string& name) const {
+    HDF5_LOCK_GUARD
+    return mapDataSet<T>(impl_->getAttributeDataSet(name));
+}
+
+
 template <>
 std::vector<std::string> Population::getAttribute<std::string>(const std::string& name,
                                                                const Selection& selection) const {
@@ -237,6 +245,7 @@ Selection Population::filterAttribute(const std::string& name,
     template std::vector<T> Population::getAttribute<T>(const std::string&,                     \
                                                         const Selection&,                       \
                                                         const T&) const;                        \
+    template MappedArray<T> Population::getAttributeView<T>(const std::string&) const;          \
     template std::vector<T> Population::getEnumeration<T>(const std::string&, const Selection&) \
         const;                                                                                  \
     template std::vector<T> Population::getDynamicsAttribute<T>(const std::string&,             \
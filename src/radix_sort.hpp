@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "parallel_read.hpp"
+
+namespace bbp {
+namespace sonata {
+namespace radix_sort {
+
+/** Map a double to an unsigned integer, preserving their order.
+ *
+ * Negative numbers have all their bits flipped, positive ones only the sign bit.
+ */
+inline uint64_t toOrderedBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    constexpr uint64_t sign = uint64_t(1) << 63;
+    return (bits & sign) != 0 ? ~bits : bits | sign;
+}
+
+/** Inverse of `toOrderedBits`.
+ */
+inline double fromOrderedBits(uint64_t bits) {
+    constexpr uint64_t sign = uint64_t(1) << 63;
+    bits = (bits & sign) != 0 ? bits & ~sign : ~bits;
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/** Stably sort `keys` and reorder `values` alike, using up to `n_threads` threads.
+ *
+ * This is a least significant digit radix sort on bytes: each pass counts the bytes of a slice
+ * of the keys per thread, then scatters each slice to its offsets. Bytes which are the same in
+ * all the keys are skipped.
+ */
+inline void sortByKey(std::vector<uint64_t>& keys,
+                      std::vector<uint64_t>& values,
+                      size_t n_threads) {
+    constexpr size_t RADIX = 256;
+    const size_t size = keys.size();
+    const size_t n_slices = std::max<size_t>(1, std::min(n_threads, size / RADIX));
+    const size_t slice_size = (size + n_slices - 1) / n_slices;
+    const auto sliceBounds = [&](size_t slice) {
+        return std::make_pair(std::min(size, slice * slice_size),
+                              std::min(size, (slice + 1) * slice_size));
+    };
+
+    // The bits which differ between keys
+    std::vector<uint64_t> slice_or(n_slices, 0);
+    std::vector<uint64_t> slice_and(n_slices, ~uint64_t(0));
+    parallel_read::parallelFor(n_slices, n_threads, [&](size_t slice) {
+        const auto bounds = sliceBounds(slice);
+        for (size_t i = bounds.first; i < bounds.second; ++i) {
+            slice_or[slice] |= keys[i];
+            slice_and[slice] &= keys[i];
+        }
+    });
+    uint64_t varying = 0;
+    for (size_t slice = 0; slice < n_slices; ++slice) {
+        varying |= slice_or[slice] ^ slice_and[slice];
+    }
+    if (varying == 0) {
+        return;
+    }
+
+    std::vector<uint64_t> keys_buffer(size);
+    std::vector<uint64_t> values_buffer(size);
+    std::vector<std::array<size_t, RADIX>> offsets(n_slices);
+
+    for (unsigned shift = 0; shift < 64; shift += 8) {
+        if (((varying >> shift) & (RADIX - 1)) == 0) {
+            continue;
+        }
+
+        parallel_read::parallelFor(n_slices, n_threads, [&](size_t slice) {
+            auto& counts = offsets[slice];
+            counts.fill(0);
+            const auto bounds = sliceBounds(slice);
+            for (size_t i = bounds.first; i < bounds.second; ++i) {
+                ++counts[(keys[i] >> shift) & (RADIX - 1)];
+            }
+        });
+
+        // Keys with a smaller byte go first, then those of earlier slices
+        size_t offset = 0;
+        for (size_t digit = 0; digit < RADIX; ++digit) {
+            for (size_t slice = 0; slice < n_slices; ++slice) {
+                const size_t count = offsets[slice][digit];
+                offsets[slice][digit] = offset;
+                offset += count;
+            }
+        }
+
+        parallel_read::parallelFor(n_slices, n_threads, [&](size_t slice) {
+            auto& next = offsets[slice];
+            const auto bounds = sliceBounds(slice);
+            for (size_t i = bounds.first; i < bounds.second; ++i) {
+                const size_t position = next[(keys[i] >> shift) & (RADIX - 1)]++;
+                keys_buffer[position] = keys[i];
+                values_buffer[position] = values[i];
+            }
+        });
+
+        keys.swap(keys_buffer);
+        values.swap(values_buffer);
+    }
+}
+
+}  // namespace radix_sort
+}  // namespace sonata
+}  // namespace bbp
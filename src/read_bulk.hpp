@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <fmt/format.h>
 
 #include <bbp/sonata/population.h>
@@ -110,6 +111,39 @@ inline Selection sortAndMerge(const Selection& selection, size_t min_gap_size =
     return Selection(sortAndMerge(selection.ranges(), min_gap_size));
 }
 
+/** Merge consecutive ranges that touch the same chunk.
+ *
+ * The ranges must be canonical. For datasets with filtered (e.g. compressed)
+ * chunks, each read touching a chunk decompresses all of it: two separate
+ * reads that touch the same chunk pay for it twice. This merges such ranges,
+ * so that each chunk of `chunk_size` elements is read once, as long as the
+ * current range is smaller than `max_aggregated_block_size` (as in
+ * `sortAndMerge`). A `chunk_size` of `0` or `1` returns `ranges` unchanged.
+ */
+template <class Range>
+std::vector<Range> mergeSharedChunks(const std::vector<Range>& ranges,
+                                     size_t chunk_size,
+                                     size_t max_aggregated_block_size = size_t(-1)) {
+    if (chunk_size <= 1 || ranges.empty()) {
+        return ranges;
+    }
+
+    std::vector<Range> ret;
+    ret.push_back(ranges.front());
+    for (auto it = std::next(ranges.cbegin()); it != ranges.cend(); ++it) {
+        auto& last = std::get<1>(ret.back());
+        const size_t current_range_size = last - std::get<0>(ret.back());
+        if ((last - 1) / chunk_size == std::get<0>(*it) / chunk_size &&
+            current_range_size < max_aggregated_block_size) {
+            last = std::max(last, std::get<1>(*it));
+        } else {
+            ret.push_back(*it);
+        }
+    }
+
+    return ret;
+}
+
 
 /** Extract a slice of values from a block.
  *
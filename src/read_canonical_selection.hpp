@@ -3,6 +3,7 @@
 #include <highfive/H5File.hpp>
 #include <vector>
 
+#include "io_planner.hpp"
 #include "read_bulk.hpp"
 
 namespace bbp {
@@ -24,11 +25,17 @@ std::vector<T> readCanonicalSelection(const HighFive::DataSet& dset, const Selec
         dset.select({i_begin}, {i_end - i_begin}).read(buffer);
     };
 
+    // Reads shouldn't split filtered chunks, otherwise they're decompressed more than once.
+    const auto chunk_size = io_planner::getStorageLayout(dset).filteredChunkSize(0);
+    const auto super_ranges = bulk_read::mergeSharedChunks(
+        bulk_read::sortAndMerge(selection.ranges(), min_gap_size, max_aggregated_block_size),
+        chunk_size,
+        max_aggregated_block_size);
+
     return bulk_read::bulkRead<T>([&readBlock](auto& buffer,
                                                const auto& range) { readBlock(buffer, range); },
-                                  selection.ranges(),
-                                  min_gap_size,
-                                  max_aggregated_block_size);
+                                  super_ranges,
+                                  selection.ranges());
 }
 
 template <class T>
@@ -53,11 +60,16 @@ std::vector<T> readCanonicalSelection(const HighFive::DataSet& dset,
         dset.select({i_begin, j_begin}, {i_end - i_begin, j_end - j_begin}).read(buffer);
     };
 
+    const auto chunk_size = io_planner::getStorageLayout(dset).filteredChunkSize(0);
+    const auto super_ranges = bulk_read::mergeSharedChunks(
+        bulk_read::sortAndMerge(xranges, min_gap_size, max_aggregated_block_size),
+        chunk_size,
+        max_aggregated_block_size);
+
     return bulk_read::bulkRead<T>([&readBlock](auto& buffer,
                                                const auto& range) { readBlock(buffer, range); },
-                                  xranges,
-                                  min_gap_size,
-                                  max_aggregated_block_size);
+                                  super_ranges,
+                                  xranges);
 }
 
 }  // namespace detail
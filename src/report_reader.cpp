@@ -1,13 +1,74 @@
+#include "hdf5_mutex.hpp"
 #include "hdf5_reader.hpp"
+#include "io_planner.hpp"
+#include "parallel_read.hpp"
+#include "radix_sort.hpp"
+#include "read_bulk.hpp"
+#include "read_canonical_selection.hpp"
+#include <bbp/sonata/compartment_sets.h>
 #include <bbp/sonata/report_reader.h>
 #include <fmt/format.h>
-
-#include <algorithm>      // std::copy, std::find, std::lower_bound, std::upper_bound
-#include <iterator>       // std::advance, std::next
-#include <unordered_set>  // std::unordered_set
+#include <fmt/ranges.h>
+#include <hdf5.h>
+
+#include <algorithm>           // std::find_if, std::lower_bound, std::max, std::min, std::push_heap
+#include <array>               // std::array
+#include <cmath>               // std::ceil, std::floor, std::sqrt
+#include <condition_variable>  // std::condition_variable
+#include <cstring>             // std::memcpy
+#include <deque>               // std::deque
+#include <exception>           // std::exception_ptr
+#include <limits>              // std::numeric_limits
+#include <list>                // std::list
+#include <memory>              // std::make_shared, std::shared_ptr
+#include <mutex>               // std::call_once, std::lock_guard, std::mutex, std::once_flag
+#include <numeric>             // std::accumulate, std::iota
+#include <random>              // std::random_device
+#include <thread>              // std::thread
 
 constexpr double EPSILON = 1e-6;
 
+// Bounds of the per population cache of NodeIdElementLayouts: number of layouts and total
+// number of element IDs held (16M, i.e. 256MB for an element report)
+constexpr size_t LAYOUT_CACHE_MAX_ENTRIES = 16;
+constexpr size_t LAYOUT_CACHE_MAX_IDS = 16777216;
+
+// The node ids of a report mapping are looked up in a table indexed by node id if they span less
+// than `NODE_ROWS_DENSE_FACTOR` times their number, in a hash table otherwise
+constexpr size_t NODE_ROWS_DENSE_FACTOR = 4;
+
+// Lazy spike populations: the binary searches read blocks of `SPIKE_PROBE_BLOCK_SIZE` values,
+// the last `SPIKE_PROBE_CACHE_SIZE` of which are kept per dataset; the selected spikes are read
+// `SPIKE_READ_BLOCK_SIZE` at a time
+constexpr size_t SPIKE_PROBE_BLOCK_SIZE = 4096;
+constexpr size_t SPIKE_PROBE_CACHE_SIZE = 16;
+constexpr size_t SPIKE_READ_BLOCK_SIZE = 1 << 20;
+
+// Number of nodes per task of the per node spike statistics
+constexpr size_t SPIKE_STATS_NODE_BLOCK_SIZE = 1024;
+
+// Reports are read `DEFAULT_MAX_READ_SIZE` bytes at a time (at least one frame of the selection),
+// unless queries give another `max_read_size`; likewise for the DataFrames of their iteration
+constexpr size_t DEFAULT_MAX_READ_SIZE = 1 << 26;
+
+// Reports: when choosing between 'data' and 'data_transposed', each read of a chunk, or of a run
+// of contiguous values, costs as much as reading `REPORT_READ_OPERATION_COST` bytes. The
+// transposed data is written in tiles of `REPORT_TRANSPOSE_TILE_SIZE` bytes at most
+constexpr size_t REPORT_READ_OPERATION_COST = 1 << 20;
+constexpr size_t REPORT_TRANSPOSE_TILE_SIZE = 1 << 26;
+
+// Reductions of reports read the timesteps `REPORT_REDUCTION_READ_SIZE` bytes at a time
+constexpr size_t REPORT_REDUCTION_READ_SIZE = 1 << 26;
+
+// Summary pyramids of reports are written, and read, `REPORT_SUMMARY_READ_SIZE` bytes at a time;
+// when compressed, in chunks of `REPORT_SUMMARY_CHUNK_SIZE` values
+constexpr size_t REPORT_SUMMARY_READ_SIZE = 1 << 26;
+constexpr size_t REPORT_SUMMARY_CHUNK_SIZE = 1 << 18;
+
+// ReportWriter buffers the frames of a row of chunks until it is complete: the chunks of its
+// 'data' span at most `REPORT_WRITE_BUFFER_SIZE` bytes of frames
+constexpr size_t REPORT_WRITE_BUFFER_SIZE = 1 << 26;
+
 HighFive::EnumType<bbp::sonata::SpikeReader::Population::Sorting> create_enum_sorting() {
     using bbp::sonata::SpikeReader;
     return HighFive::EnumType<SpikeReader::Population::Sorting>(
@@ -23,65 +84,160 @@ namespace {
 using bbp::sonata::CompartmentID;
 using bbp::sonata::ElementID;
 using bbp::sonata::NodeID;
+using bbp::sonata::ReportEncoding;
+using bbp::sonata::ReportReduction;
+using bbp::sonata::ReportWriter;
 using bbp::sonata::Selection;
+using bbp::sonata::SonataError;
 using bbp::sonata::Spike;
 using bbp::sonata::Spikes;
+using bbp::sonata::SpikeTimes;
 
-void filterNodeIDUnsorted(Spikes& spikes, const Selection& node_ids) {
-    const auto values = node_ids.flatten();
-    const auto selected_values = std::unordered_set<Selection::Value>(values.begin(), values.end());
-    const auto new_end =
-        std::remove_if(spikes.begin(), spikes.end(), [&selected_values](const Spike& spike) {
-            return selected_values.find(spike.first) == selected_values.end();
-        });
-    spikes.erase(new_end, spikes.end());
-}
-
-void filterNodeIDSorted(Spikes& spikes, const Selection& node_ids) {
-    Spikes _spikes;
-    for (const auto& range : node_ids.ranges()) {
-        const auto begin = std::lower_bound(spikes.begin(),
-                                            spikes.end(),
-                                            std::make_pair(std::get<0>(range), 0.),
-                                            [](const Spike& spike1, const Spike& spike2) {
-                                                return spike1.first < spike2.first;
-                                            });
-        const auto end = std::upper_bound(spikes.begin(),
-                                          spikes.end(),
-                                          std::make_pair(std::get<1>(range) - 1, 0.),
-                                          [](const Spike& spike1, const Spike& spike2) {
-                                              return spike1.first < spike2.first;
-                                          });
-
-        std::move(begin, end, std::back_inserter(_spikes));
-        spikes.erase(begin, end);  // have to erase, because otherwise it is no more sorted
-    }
-    spikes = std::move(_spikes);
-}
-
-void filterTimestampUnsorted(Spikes& spikes, double tstart, double tstop) {
-    auto new_end =
-        std::remove_if(spikes.begin(), spikes.end(), [&tstart, &tstop](const Spike& spike) {
-            return (spike.second < tstart - EPSILON) || (spike.second > tstop + EPSILON);
-        });
-    spikes.erase(new_end, spikes.end());
-}
-
-void filterTimestampSorted(Spikes& spikes, double tstart, double tstop) {
-    const auto end = std::upper_bound(spikes.begin(),
-                                      spikes.end(),
-                                      std::make_pair(0UL, tstop + EPSILON),
-                                      [](const Spike& spike1, const Spike& spike2) {
-                                          return spike1.second < spike2.second;
-                                      });
-    spikes.erase(end, spikes.end());
-    const auto begin = std::lower_bound(spikes.begin(),
-                                        spikes.end(),
-                                        std::make_pair(0UL, tstart - EPSILON),
-                                        [](const Spike& spike1, const Spike& spike2) {
-                                            return spike1.second < spike2.second;
-                                        });
-    spikes.erase(spikes.begin(), begin);
+inline void appendSpike(Spikes& spikes, NodeID node_id, double timestamp) {
+    spikes.emplace_back(node_id, timestamp);
+}
+
+inline void appendSpike(SpikeTimes& spikes, NodeID node_id, double timestamp) {
+    spikes.node_ids.push_back(node_id);
+    spikes.timestamps.push_back(timestamp);
+}
+
+inline void reserveSpikes(Spikes& spikes, size_t count) {
+    spikes.reserve(spikes.size() + count);
+}
+
+inline void reserveSpikes(SpikeTimes& spikes, size_t count) {
+    spikes.node_ids.reserve(spikes.node_ids.size() + count);
+    spikes.timestamps.reserve(spikes.timestamps.size() + count);
+}
+
+// Is `node_id` in the sorted and merged `ranges`?
+bool containsNodeID(const Selection::Ranges& ranges, NodeID node_id) {
+    const auto it = std::upper_bound(ranges.begin(),
+                                     ranges.end(),
+                                     node_id,
+                                     [](NodeID id, const Selection::Range& range) {
+                                         return id < std::get<0>(range);
+                                     });
+    return it != ranges.begin() && node_id < std::get<1>(*(it - 1));
+}
+
+/**
+ * Append to `out` the spikes at positions [first, last) of `spikes` with a timestamp in
+ * [lower, upper] and, if given, a node ID in `node_ids`.
+ *
+ * The spikes are appended in the order of `spikes`, unless `sorted_by_id`: `spikes` are then
+ * sorted by node ID and appended range by range, in the order of the ranges of `node_ids`.
+ */
+template <typename Out>
+void selectSpikes(const SpikeTimes& spikes,
+                  size_t first,
+                  size_t last,
+                  const nonstd::optional<Selection>& node_ids,
+                  double lower,
+                  double upper,
+                  bool sorted_by_id,
+                  Out& out) {
+    const auto& ids = spikes.node_ids;
+    const auto& timestamps = spikes.timestamps;
+    const auto append = [&](size_t i) {
+        if (!(timestamps[i] < lower || timestamps[i] > upper)) {
+            appendSpike(out, ids[i], timestamps[i]);
+        }
+    };
+
+    if (!node_ids) {
+        reserveSpikes(out, last - first);
+        for (size_t i = first; i < last; ++i) {
+            append(i);
+        }
+    } else if (sorted_by_id) {
+        // With overlapping ranges, each spike goes with the first range holding its node ID
+        const bool disjoint = bulk_read::detail::isCanonical(node_ids->ranges());
+        std::vector<bool> appended(disjoint ? 0 : last - first);
+        const auto begin = ids.begin() + static_cast<ptrdiff_t>(first);
+        const auto end = ids.begin() + static_cast<ptrdiff_t>(last);
+        for (const auto& range : node_ids->ranges()) {
+            const auto range_begin = std::lower_bound(begin, end, range[0]);
+            const auto range_end = std::lower_bound(range_begin, end, range[1]);
+            for (auto i = static_cast<size_t>(range_begin - ids.begin());
+                 i < static_cast<size_t>(range_end - ids.begin());
+                 ++i) {
+                if (!disjoint) {
+                    if (appended[i - first]) {
+                        continue;
+                    }
+                    appended[i - first] = true;
+                }
+                append(i);
+            }
+        }
+    } else {
+        const auto selected = bulk_read::sortAndMerge(node_ids->ranges());
+        for (size_t i = first; i < last; ++i) {
+            if (containsNodeID(selected, ids[i])) {
+                append(i);
+            }
+        }
+    }
+}
+
+/**
+ * Least recently used cache of the blocks of a one-dimensional dataset read by binary searches
+ */
+template <typename T>
+class ProbeCache
+{
+  public:
+    T at(const HighFive::DataSet& dataset, size_t size, size_t i) {
+        const size_t block = i / SPIKE_PROBE_BLOCK_SIZE;
+        const size_t first = block * SPIKE_PROBE_BLOCK_SIZE;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = std::find_if(blocks_.begin(),
+                                     blocks_.end(),
+                                     [block](const std::pair<size_t, std::vector<T>>& entry) {
+                                         return entry.first == block;
+                                     });
+        if (it != blocks_.end()) {
+            blocks_.splice(blocks_.begin(), blocks_, it);
+        } else {
+            std::vector<T> values;
+            dataset.select({first}, {std::min(SPIKE_PROBE_BLOCK_SIZE, size - first)})
+                .read(values);
+            blocks_.emplace_front(block, std::move(values));
+            if (blocks_.size() > SPIKE_PROBE_CACHE_SIZE) {
+                blocks_.pop_back();
+            }
+        }
+        return blocks_.front().second[i - first];
+    }
+
+  private:
+    std::mutex mutex_;
+    std::list<std::pair<size_t, std::vector<T>>> blocks_;  // Most recently used first
+};
+
+// Sort `spikes` by time, or by node ID then time if `by_id`, using up to `n_threads` threads
+void sortSpikes(SpikeTimes& spikes, bool by_id, size_t n_threads) {
+    std::vector<uint64_t> times(spikes.timestamps.size());
+    std::transform(spikes.timestamps.begin(),
+                   spikes.timestamps.end(),
+                   times.begin(),
+                   bbp::sonata::radix_sort::toOrderedBits);
+    spikes.timestamps = std::vector<double>();
+
+    bbp::sonata::radix_sort::sortByKey(times, spikes.node_ids, n_threads);
+    if (by_id) {
+        // Stable, so that the spikes of each node stay sorted by time
+        bbp::sonata::radix_sort::sortByKey(spikes.node_ids, times, n_threads);
+    }
+
+    spikes.timestamps.resize(times.size());
+    std::transform(times.begin(),
+                   times.end(),
+                   spikes.timestamps.begin(),
+                   bbp::sonata::radix_sort::fromOrderedBits);
 }
 
 inline void emplace_ids(NodeID& key, NodeID node_id, ElementID /* element_id */) {
@@ -93,341 +249,1911 @@ inline void emplace_ids(CompartmentID& key, NodeID node_id, ElementID element_id
     key[1] = element_id;
 }
 
-}  // anonymous namespace
-
-namespace bbp {
-namespace sonata {
-
-SpikeReader::SpikeReader(std::string filename)
-    : filename_(std::move(filename)) { }
+inline NodeID keyNodeID(NodeID key) {
+    return key;
+}
 
-std::vector<std::string> SpikeReader::getPopulationNames() const {
-    HighFive::File file = openHDF5withoutLock(filename_);
-    return file.getGroup("/spikes").listObjectNames();
+inline NodeID keyNodeID(const CompartmentID& key) {
+    return key[0];
 }
 
-auto SpikeReader::openPopulation(const std::string& populationName) const -> const Population& {
-    if (populations_.find(populationName) == populations_.end()) {
-        populations_.emplace(populationName, Population{filename_, populationName});
-    }
+// Soma reports have a single element per node, the soma, which is section 0
+inline uint64_t keyElementID(NodeID /* key */) {
+    return 0;
+}
 
-    return populations_.at(populationName);
+inline uint64_t keyElementID(const CompartmentID& key) {
+    return key[1];
 }
 
-std::tuple<double, double> SpikeReader::Population::getTimes() const {
-    return std::tie(tstart_, tstop_);
+// Type of the values of a report 'data' dataset: int16 values v stand for v * scale + offset
+struct DataEncoding {
+    ReportEncoding type = ReportEncoding::float32;
+    float scale = 1.f;
+    float offset = 0.f;
+};
+
+inline float bitsToFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
-Spikes SpikeReader::Population::createSpikes() const {
-    Spikes spikes;
-    std::transform(spike_times_.node_ids.begin(),
-                   spike_times_.node_ids.end(),
-                   spike_times_.timestamps.begin(),
-                   std::back_inserter(spikes),
-                   [](Spike::first_type node_id, Spike::second_type timestamp) {
-                       return std::make_pair(node_id, timestamp);
-                   });
-    return spikes;
+inline uint32_t floatToBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
 }
 
-Spikes SpikeReader::Population::get(const nonstd::optional<Selection>& node_ids,
-                                    const nonstd::optional<double>& tstart,
-                                    const nonstd::optional<double>& tstop) const {
-    const double start = tstart.value_or(tstart_);
-    const double stop = tstop.value_or(tstop_);
+// Decode an IEEE 754 half precision float. The exponent is rebased by a multiplication, which
+// also normalizes denormals, so that there are no branches and the loops calling it vectorize
+inline float halfToFloat(uint16_t half) {
+    const float rebase = bitsToFloat(uint32_t(254 - 15) << 23);
+    const float inf_nan = bitsToFloat(uint32_t(127 + 16) << 23);
+    const float magnitude = bitsToFloat(uint32_t(half & 0x7fffu) << 13) * rebase;
+    uint32_t bits = floatToBits(magnitude);
+    bits |= magnitude >= inf_nan ? uint32_t(255) << 23 : 0;
+    bits |= uint32_t(half & 0x8000u) << 16;
+    return bitsToFloat(bits);
+}
 
-    if (start < 0 - EPSILON || stop < 0 - EPSILON) {
-        throw SonataError("Times cannot be negative");
-    }
+// Encode a float as an IEEE 754 half precision float, rounding to the nearest even
+inline uint16_t floatToHalf(float value) {
+    const uint32_t bits = floatToBits(value);
+    const uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t magnitude = bits & 0x7fffffffu;
 
-    if (start > stop) {
-        throw SonataError("tstart should be <= to tstop");
+    if (magnitude >= (uint32_t(127 + 16) << 23)) {  // Too large: infinity, or NaN
+        const uint32_t inf_nan = magnitude > (uint32_t(255) << 23) ? 0x7e00u : 0x7c00u;
+        return static_cast<uint16_t>(sign | inf_nan);
     }
-
-    if (node_ids and node_ids->empty()) {
-        return Spikes{};
+    if (magnitude < (uint32_t(127 - 14) << 23)) {
+        // Denormal: adding 0.5 aligns the mantissa on its last 10 bits, rounded by the addition
+        const float denormal = bitsToFloat(uint32_t(127 - 1) << 23);
+        const float aligned = bitsToFloat(magnitude) + denormal;
+        return static_cast<uint16_t>(sign | (floatToBits(aligned) - floatToBits(denormal)));
     }
+    const uint32_t odd = (magnitude >> 13) & 1;
+    magnitude += (uint32_t(15 - 127) << 23) + 0xfff + odd;
+    return static_cast<uint16_t>(sign | (magnitude >> 13));
+}
 
-    auto spikes = createSpikes();
-    filterTimestamp(spikes, start, stop);
-
-    if (node_ids) {
-        filterNode(spikes, node_ids.value());
+// Encode a value as an int16 of `encoding`, rounding it and clamping it to the range of int16
+inline int16_t encodeInt16(float value, const DataEncoding& encoding) {
+    const float scaled = std::round((value - encoding.offset) / encoding.scale);
+    if (!(scaled > std::numeric_limits<int16_t>::min())) {  // NaN included
+        return scaled != scaled ? 0 : std::numeric_limits<int16_t>::min();
     }
-
-    return spikes;
+    return scaled < std::numeric_limits<int16_t>::max() ? static_cast<int16_t>(scaled)
+                                                          : std::numeric_limits<int16_t>::max();
 }
 
-const SpikeTimes& SpikeReader::Population::getRawArrays() const {
-    return spike_times_;
+// Is `type` the IEEE 754 half precision float type, in the byte order of the machine?
+bool isNativeHalfType(const HighFive::DataType& type) {
+    if (type.getClass() != HighFive::DataTypeClass::Float || type.getSize() != 2) {
+        return false;
+    }
+    const hid_t id = type.getId();
+    size_t spos = 0, epos = 0, esize = 0, mpos = 0, msize = 0;
+    return H5Tget_order(id) == H5Tget_order(H5T_NATIVE_FLOAT) &&
+           H5Tget_fields(id, &spos, &epos, &esize, &mpos, &msize) >= 0 && spos == 15 &&
+           epos == 10 && esize == 5 && mpos == 0 && msize == 10 && H5Tget_ebias(id) == 15;
 }
 
-SpikeTimes SpikeReader::Population::getArrays(const nonstd::optional<Selection>& node_ids,
-                                              const nonstd::optional<double>& tstart,
-                                              const nonstd::optional<double>& tstop) const {
-    SpikeTimes filtered_spikes;
-    const auto& node_ids_selection = node_ids ? node_ids.value().flatten() : std::vector<NodeID>{};
-    // Create arrays directly for required data based on conditions
-    for (size_t i = 0; i < spike_times_.node_ids.size(); ++i) {
-        const auto& node_id = spike_times_.node_ids[i];
-        const auto& timestamp = spike_times_.timestamps[i];
-
-        // Check if node_id is found in node_ids_selection
-        bool node_ids_found = true;
-        if (node_ids) {
-            node_ids_found = std::find(node_ids_selection.begin(),
-                                       node_ids_selection.end(),
-                                       node_id) != node_ids_selection.end();
+// Return the encoding of a report 'data' dataset, throwing unless it is a `ReportEncoding`
+DataEncoding readDataEncoding(const HighFive::DataSet& dataset) {
+    const auto dataset_type = dataset.getDataType();
+    DataEncoding encoding;
+    if (dataset_type.getClass() == HighFive::DataTypeClass::Float &&
+        dataset_type.getSize() == 4) {
+        return encoding;
+    }
+    if (isNativeHalfType(dataset_type)) {
+        encoding.type = ReportEncoding::float16;
+        return encoding;
+    }
+    if (dataset_type.getClass() == HighFive::DataTypeClass::Integer &&
+        dataset_type.getSize() == 2 && H5Tget_sign(dataset_type.getId()) == H5T_SGN_2) {
+        encoding.type = ReportEncoding::int16;
+        if (dataset.hasAttribute("scale_factor")) {
+            dataset.getAttribute("scale_factor").read(encoding.scale);
         }
-
-        // Check if timestamp is within valid range
-        bool valid_timestamp = (!tstart || timestamp >= tstart.value()) &&
-                               (!tstop || timestamp <= tstop.value());
-
-        // Include data if both conditions are satisfied
-        if (node_ids_found && valid_timestamp) {
-            filtered_spikes.node_ids.emplace_back(node_id);
-            filtered_spikes.timestamps.emplace_back(timestamp);
+        if (dataset.hasAttribute("add_offset")) {
+            dataset.getAttribute("add_offset").read(encoding.offset);
         }
+        return encoding;
     }
-    return filtered_spikes;
+    throw SonataError(fmt::format(
+        "DataType of dataset 'data' should be Float32, Float16 or Int16 ('{}' was found)",
+        dataset_type.string()));
 }
 
-SpikeReader::Population::Sorting SpikeReader::Population::getSorting() const {
-    return sorting_;
+// Throw unless the values of a report 'data' dataset are of a `ReportEncoding`
+void checkReportDataType(const HighFive::DataSet& dataset) {
+    readDataEncoding(dataset);
 }
 
-std::string SpikeReader::Population::getTimeUnits() const {
-    return time_units_;
+// Return the type of the values of a report 'data' dataset once read in memory, before they are
+// decoded: half precision floats are read as is
+HighFive::DataType encodedMemoryType(const HighFive::DataSet& dataset,
+                                     const DataEncoding& encoding) {
+    if (encoding.type == ReportEncoding::float16) {
+        return dataset.getDataType();
+    } else if (encoding.type == ReportEncoding::int16) {
+        return HighFive::create_datatype<int16_t>();
+    }
+    return HighFive::create_datatype<float>();
 }
 
-SpikeReader::Population::Population(const std::string& filename,
-                                    const std::string& populationName) {
-    HighFive::File file = openHDF5withoutLock(filename);
-
-    const auto pop_path = std::string("/spikes/") + populationName;
-    const auto pop = file.getGroup(pop_path);
-    auto& node_ids = spike_times_.node_ids;
-    auto& timestamps = spike_times_.timestamps;
-
-    pop.getDataSet("node_ids").read(node_ids);
-    pop.getDataSet("timestamps").read(timestamps);
-    pop.getDataSet("timestamps").getAttribute("units").read(time_units_);
-
-    if (node_ids.size() != timestamps.size()) {
-        throw SonataError(
-            "In spikes file, 'node_ids' and 'timestamps' does not have the same size.");
+// Call `f` with the function decoding a value of `encoding` other than float32, so that its
+// loops are specialized, and vectorized, for each of them
+template <typename F>
+void withDecoder(const DataEncoding& encoding, F&& f) {
+    if (encoding.type == ReportEncoding::float16) {
+        f([](int16_t value) { return halfToFloat(static_cast<uint16_t>(value)); });
+    } else {
+        const float scale = encoding.scale;
+        const float offset = encoding.offset;
+        f([scale, offset](int16_t value) { return static_cast<float>(value) * scale + offset; });
     }
+}
 
-    if (pop.hasAttribute("sorting")) {
-        pop.getAttribute("sorting").read(sorting_);
-    }
+// Decode the `n` values of `encoding` of `values` to `out`
+void decodeValues(const DataEncoding& encoding, const int16_t* values, size_t n, float* out) {
+    withDecoder(encoding, [&](const auto& decode) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = decode(values[i]);
+        }
+    });
+}
 
-    if (sorting_ == Sorting::by_time) {
-        tstart_ = timestamps.empty() ? 0 : timestamps.front();
-        tstop_ = timestamps.empty() ? 0 : timestamps.back();
-    } else {
-        tstart_ = timestamps.empty() ? 0 : *min_element(timestamps.cbegin(), timestamps.cend());
-        tstop_ = timestamps.empty() ? 0 : *max_element(timestamps.cbegin(), timestamps.cend());
+// Read the values of `selection` of a report 'data' dataset to `out`, decoded; `encoded` holds
+// the values before they are decoded
+void readDecodedValues(const HighFive::Selection& selection,
+                       const HighFive::DataSet& dataset,
+                       const DataEncoding& encoding,
+                       size_t n,
+                       float* out,
+                       std::vector<int16_t>& encoded) {
+    if (encoding.type == ReportEncoding::float32) {
+        selection.read_raw(out);
+        return;
     }
+    encoded.resize(n);
+    selection.read_raw(encoded.data(), encodedMemoryType(dataset, encoding));
+    decodeValues(encoding, encoded.data(), n, out);
 }
 
-void SpikeReader::Population::filterNode(Spikes& spikes, const Selection& node_ids) const {
-    if (sorting_ == Sorting::by_id) {
-        filterNodeIDSorted(spikes, node_ids);
-    } else {
-        filterNodeIDUnsorted(spikes, node_ids);
+// Create the dataset `name` of little-endian IEEE 754 half precision floats in `group`, the type
+// HDF5 has no predefined name for (and h5py writes for numpy.float16)
+HighFive::DataSet createHalfDataSet(HighFive::Group& group,
+                                    const std::string& name,
+                                    const HighFive::DataSpace& space,
+                                    const HighFive::DataSetCreateProps& props) {
+    const hid_t type = H5Tcopy(H5T_IEEE_F32LE);
+    hid_t dataset = -1;
+    if (type >= 0 && H5Tset_fields(type, 15, 10, 5, 0, 10) >= 0 && H5Tset_size(type, 2) >= 0 &&
+        H5Tset_ebias(type, 15) >= 0) {
+        dataset = H5Dcreate2(group.getId(),
+                             name.c_str(),
+                             type,
+                             space.getId(),
+                             H5P_DEFAULT,
+                             props.getId(),
+                             H5P_DEFAULT);
+    }
+    if (type >= 0) {
+        H5Tclose(type);
+    }
+    if (dataset < 0) {
+        throw SonataError(fmt::format("Unable to create the float16 dataset '{}'", name));
     }
+    H5Dclose(dataset);
+    return group.getDataSet(name);
 }
 
-void SpikeReader::Population::filterTimestamp(Spikes& spikes, double tstart, double tstop) const {
-    if (sorting_ == Sorting::by_time) {
-        filterTimestampSorted(spikes, tstart, tstop);
+// Assign the ids of `layout` to `ids`: moved out of the layout if it is held by no one else, i.e.
+// it wasn't cached, else copied (reusing the storage of `ids`). The layouts are created non-const
+// by `getNodeIdElementLayout`, hence can be modified.
+template <typename Layout, typename Ids>
+void assignLayoutIds(const std::shared_ptr<const Layout>& layout, Ids& ids) {
+    if (layout.use_count() == 1) {
+        ids = std::move(const_cast<Layout&>(*layout).ids);
     } else {
-        filterTimestampUnsorted(spikes, tstart, tstop);
+        ids = layout->ids;
     }
 }
 
-template <typename T>
-ReportReader<T>::ReportReader(const std::string& filename)
-    : file_(openHDF5withoutLock(filename)) { }
+// Return the {min,max} positions in 'data' of a {min,max} block of `layout`
+template <typename Layout>
+Selection::Range blockBounds(const Layout& layout, const Selection::Range& min_max_block) {
+    const auto first_index = layout.node_index[std::get<0>(min_max_block)];
+    const auto last_index = layout.node_index[std::get<1>(min_max_block) - 1];
+    return {std::get<0>(layout.node_ranges[first_index]),
+            std::get<1>(layout.node_ranges[last_index])};
+}
 
-template <typename T>
-std::vector<std::string> ReportReader<T>::getPopulationNames() const {
-    return file_.getGroup("/report").listObjectNames();
+// Fill the {min,max} blocks of `layout`, whose `node_index` is sorted by range, splitting them
+// at the gaps over `block_gap_limit` columns
+template <typename Layout>
+void computeMinMaxBlocks(Layout& layout, size_t block_gap_limit) {
+    size_t offset = 0;
+    for (size_t i = 0; (i + 1) < layout.node_index.size(); i++) {
+        const auto index = layout.node_index[i];
+        const auto index_next = layout.node_index[i + 1];
+        const auto max = std::get<1>(layout.node_ranges[index]);
+        const auto min_next = std::get<0>(layout.node_ranges[index_next]);
+
+        if (min_next > max && (min_next - max) > block_gap_limit) {
+            layout.min_max_blocks.push_back({offset, (i + 1)});
+            offset = (i + 1);
+        }
+    }
+    layout.min_max_blocks.push_back({offset, layout.node_index.size()});
 }
 
-template <typename T>
-auto ReportReader<T>::openPopulation(const std::string& populationName) const -> const Population& {
-    if (populations_.find(populationName) == populations_.end()) {
-        populations_.emplace(populationName, Population{file_, populationName});
+// Copy `n_frames` rows of a {min,max} block, read into `buffer`, to the rows of `out`
+template <typename Layout>
+void copyBlockFrames(const Layout& layout,
+                     const Selection::Range& min_max_block,
+                     const float* buffer,
+                     size_t n_frames,
+                     float* out) {
+    const auto bounds = blockBounds(layout, min_max_block);
+    const size_t block_size = std::get<1>(bounds) - std::get<0>(bounds);
+    const size_t element_ids_count = layout.ids.size();
+
+    for (size_t f = 0; f < n_frames; ++f) {
+        const float* const buffer_start = buffer + f * block_size;
+        float* const data_start = out + f * element_ids_count;
+        for (size_t i = std::get<0>(min_max_block); i < std::get<1>(min_max_block); ++i) {
+            const auto index = layout.node_index[i];
+            const auto begin = std::get<0>(layout.node_ranges[index]) - std::get<0>(bounds);
+            const auto end = std::get<1>(layout.node_ranges[index]) - std::get<0>(bounds);
+
+            std::copy(buffer_start + begin,
+                      buffer_start + end,
+                      data_start + layout.node_offsets[index]);
+        }
     }
+}
 
-    return populations_.at(populationName);
+// Same as `copyBlockFrames`, for the values of `encoding` of a block, decoded as they are copied
+template <typename Layout>
+void decodeBlockFrames(const Layout& layout,
+                       const Selection::Range& min_max_block,
+                       const DataEncoding& encoding,
+                       const int16_t* buffer,
+                       size_t n_frames,
+                       float* out) {
+    const auto bounds = blockBounds(layout, min_max_block);
+    const size_t block_size = std::get<1>(bounds) - std::get<0>(bounds);
+    const size_t element_ids_count = layout.ids.size();
+
+    withDecoder(encoding, [&](const auto& decode) {
+        for (size_t f = 0; f < n_frames; ++f) {
+            const int16_t* const buffer_start = buffer + f * block_size;
+            float* const data_start = out + f * element_ids_count;
+            for (size_t i = std::get<0>(min_max_block); i < std::get<1>(min_max_block); ++i) {
+                const auto index = layout.node_index[i];
+                const auto begin = std::get<0>(layout.node_ranges[index]) - std::get<0>(bounds);
+                const auto end = std::get<1>(layout.node_ranges[index]) - std::get<0>(bounds);
+
+                std::transform(buffer_start + begin,
+                               buffer_start + end,
+                               data_start + layout.node_offsets[index],
+                               decode);
+            }
+        }
+    });
 }
 
-template <typename T>
-ReportReader<T>::Population::Population(const HighFive::File& file,
-                                        const std::string& populationName)
-    : pop_group_(file.getGroup(std::string("/report/") + populationName))
-    , is_node_ids_sorted_(false) {
-    const auto mapping_group = pop_group_.getGroup("mapping");
-    mapping_group.getDataSet("node_ids").read(node_ids_);
+// Are the columns of a {min,max} block of `layout` those of the frames, in the same order? The
+// block can then be read straight into the frames
+template <typename Layout>
+bool isFramesBlock(const Layout& layout, const Selection::Range& min_max_block) {
+    const auto bounds = blockBounds(layout, min_max_block);
+    if (std::get<1>(bounds) - std::get<0>(bounds) != layout.ids.size()) {
+        return false;
+    }
+    for (size_t i = std::get<0>(min_max_block); i < std::get<1>(min_max_block); ++i) {
+        const auto index = layout.node_index[i];
+        if (std::get<0>(layout.node_ranges[index]) - std::get<0>(bounds) !=
+            layout.node_offsets[index]) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    std::vector<uint64_t> index_pointers;
-    mapping_group.getDataSet("index_pointers").read(index_pointers);
+// Read `n_rows` rows from `row` of the columns of `layout` in `dataset`, which has the columns of
+// 'data', e.g. a level of a summary pyramid, to the rows of `out`
+template <typename Layout>
+void readLayoutRows(const HighFive::DataSet& dataset,
+                    const Layout& layout,
+                    size_t row,
+                    size_t n_rows,
+                    size_t max_read_size,
+                    float* out) {
+    std::vector<float> buffer;
+    for (const auto& min_max_block : layout.min_max_blocks) {
+        const auto bounds = blockBounds(layout, min_max_block);
+        const auto min = std::get<0>(bounds);
+        const size_t block_size = std::get<1>(bounds) - min;
+        if (block_size == 0) {
+            continue;
+        }
 
-    if (index_pointers.size() != (node_ids_.size() + 1)) {
-        throw SonataError("'index_pointers' dataset size must be 'node_ids' size plus one");
+        const size_t rows_per_read =
+            std::max<size_t>(1, max_read_size / (block_size * sizeof(float)));
+        for (size_t r = 0; r < n_rows; r += rows_per_read) {
+            const size_t count = std::min(rows_per_read, n_rows - r);
+            buffer.resize(count * block_size);
+            dataset.select({row + r, min}, {count, block_size}).read_raw(buffer.data());
+            copyBlockFrames(
+                layout, min_max_block, buffer.data(), count, out + r * layout.ids.size());
+        }
     }
+}
 
-    // Expand the pointers into tuples that define the range of each GID
-    size_t element_ids_count = 0;
-    for (size_t i = 0; i < node_ids_.size(); ++i) {
-        node_ranges_.push_back({index_pointers[i], index_pointers[i + 1]});  // Range of GID
-        node_offsets_.emplace_back(element_ids_count);                       // Offset in output
-        node_index_.emplace_back(i);                                         // Index of previous
-
-        element_ids_count += (index_pointers[i + 1] - index_pointers[i]);
+// The reductions below keep `REDUCTION_LANES` partial results, so that their loops vectorize
+// without relying on floating point reassociation
+constexpr size_t REDUCTION_LANES = 8;
+
+// Reduce the `n` values of `values`, a mean being reduced to the sum of the values
+float reduceValues(const float* values, size_t n, ReportReduction reduction) {
+    std::array<float, REDUCTION_LANES> lanes;
+    size_t i = 0;
+    if (reduction == ReportReduction::min || reduction == ReportReduction::max) {
+        if (n == 0) {
+            return std::numeric_limits<float>::quiet_NaN();
+        }
+        lanes.fill(values[0]);
+        if (reduction == ReportReduction::min) {
+            for (; i + REDUCTION_LANES <= n; i += REDUCTION_LANES) {
+                for (size_t lane = 0; lane < REDUCTION_LANES; ++lane) {
+                    lanes[lane] = std::min(lanes[lane], values[i + lane]);
+                }
+            }
+            for (; i < n; ++i) {
+                lanes[0] = std::min(lanes[0], values[i]);
+            }
+            return *std::min_element(lanes.begin(), lanes.end());
+        }
+        for (; i + REDUCTION_LANES <= n; i += REDUCTION_LANES) {
+            for (size_t lane = 0; lane < REDUCTION_LANES; ++lane) {
+                lanes[lane] = std::max(lanes[lane], values[i + lane]);
+            }
+        }
+        for (; i < n; ++i) {
+            lanes[0] = std::max(lanes[0], values[i]);
+        }
+        return *std::max_element(lanes.begin(), lanes.end());
     }
-    node_offsets_.emplace_back(element_ids_count);
 
-    {  // Sort the index according to the GIDs, if not sorted in file
-        if (mapping_group.getDataSet("node_ids").hasAttribute("sorted")) {
-            uint8_t sorted = 0;
-            mapping_group.getDataSet("node_ids").getAttribute("sorted").read(sorted);
-            is_node_ids_sorted_ = (sorted != 0);
+    lanes.fill(0.f);
+    for (; i + REDUCTION_LANES <= n; i += REDUCTION_LANES) {
+        for (size_t lane = 0; lane < REDUCTION_LANES; ++lane) {
+            lanes[lane] += values[i + lane];
         }
+    }
+    for (; i < n; ++i) {
+        lanes[0] += values[i];
+    }
+    return std::accumulate(lanes.begin(), lanes.end(), 0.f);
+}
 
-        if (!is_node_ids_sorted_) {
-            // Note: The idea is to sort the positions to access the values, allowing us to
-            //       maintain all vectors intact, while still being able to index the data
-            std::sort(node_index_.begin(), node_index_.end(), [&](const size_t i, const size_t j) {
-                return node_ids_[i] < node_ids_[j];
-            });
+// Combine `values` into the partial reductions `out`, element-wise; a mean is accumulated as a sum
+void accumulateValues(float* out, const float* values, size_t n, ReportReduction reduction) {
+    if (reduction == ReportReduction::min) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = std::min(out[i], values[i]);
+        }
+    } else if (reduction == ReportReduction::max) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = std::max(out[i], values[i]);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] += values[i];
         }
     }
+}
 
-    {  // Get times
-        std::vector<double> times;
-        mapping_group.getDataSet("time").read(times);
-        tstart_ = times[0];
-        tstop_ = times[1];
-        tstep_ = times[2];
-        mapping_group.getDataSet("time").getAttribute("units").read(time_units_);
-        size_t i = 0;
-        for (double t = tstart_; t < tstop_ - EPSILON; t += tstep_, ++i) {
-            times_index_.emplace_back(i, t);
+// Return the number of distinct chunks of `chunk_size` values covered by the sorted `ranges`
+size_t countChunks(const Selection::Ranges& ranges, size_t chunk_size) {
+    size_t count = 0;
+    size_t next_chunk = 0;  // The chunks before were already counted
+    for (const auto& range : ranges) {
+        if (std::get<0>(range) >= std::get<1>(range)) {
+            continue;
+        }
+        const size_t first = std::max(next_chunk, std::get<0>(range) / chunk_size);
+        const size_t last = (std::get<1>(range) - 1) / chunk_size;
+        if (first <= last) {
+            count += last - first + 1;
+            next_chunk = last + 1;
         }
     }
+    return count;
+}
 
-    pop_group_.getDataSet("data").getAttribute("units").read(data_units_);
+// Return the name of the group of level `level` of a summary pyramid
+std::string summaryLevelName(size_t level) {
+    return fmt::format("level_{}", level);
 }
 
-template <typename T>
-std::tuple<double, double, double> ReportReader<T>::Population::getTimes() const {
-    return std::tie(tstart_, tstop_, tstep_);
+// The 'data' of a report written by ReportWriter has a random 'generation' attribute, copied as
+// 'data_generation' to the transposed data and the summary pyramid computed from it: they are
+// used only while it matches, i.e. until 'data' is written anew
+uint64_t newDataGeneration() {
+    std::random_device random;
+    return (uint64_t(random()) << 32) ^ uint64_t(random());
 }
 
-template <typename T>
-std::string ReportReader<T>::Population::getTimeUnits() const {
-    return time_units_;
+// Return the generation of `data`, giving it one if it has none
+uint64_t dataGeneration(HighFive::DataSet& data) {
+    uint64_t generation = 0;
+    if (data.hasAttribute("generation")) {
+        data.getAttribute("generation").read(generation);
+    } else {
+        generation = newDataGeneration();
+        data.createAttribute("generation", generation);
+    }
+    return generation;
 }
 
-template <typename T>
-std::string ReportReader<T>::Population::getDataUnits() const {
-    return data_units_;
+// Number of values of 'data' recorded by `writeDataFingerprint`
+constexpr size_t DATA_SAMPLE_SIZE = 16;
+
+// Return a few values of `data`, decoded, spread along its diagonal: writes in place keep its
+// generation, and don't touch its object header, but are unlikely to leave them all as they were
+std::vector<float> sampleData(const HighFive::DataSet& data) {
+    const auto dims = data.getDimensions();
+    if (dims.size() != 2 || dims[0] == 0 || dims[1] == 0) {
+        return {};
+    }
+    std::vector<size_t> coordinates;
+    coordinates.reserve(2 * DATA_SAMPLE_SIZE);
+    for (size_t i = 0; i < DATA_SAMPLE_SIZE; ++i) {
+        coordinates.push_back(i * (dims[0] - 1) / (DATA_SAMPLE_SIZE - 1));
+        coordinates.push_back(i * (dims[1] - 1) / (DATA_SAMPLE_SIZE - 1));
+    }
+    std::vector<float> sample(DATA_SAMPLE_SIZE);
+    std::vector<int16_t> encoded;
+    readDecodedValues(data.select(HighFive::ElementSet(coordinates)),
+                      data,
+                      readDataEncoding(data),
+                      sample.size(),
+                      sample.data(),
+                      encoded);
+    return sample;
 }
 
-template <typename T>
-bool ReportReader<T>::Population::getSorted() const {
-    return is_node_ids_sorted_;
+// Record in `derived` what it was computed from: the generation of `data`, set first if missing,
+// then its dimensions, modification time (0 unless HDF5 tracks it) and a sample of its values
+template <typename Derived>
+void writeDataFingerprint(HighFive::DataSet& data, Derived& derived) {
+    derived.createAttribute("data_generation", dataGeneration(data));
+    derived.createAttribute("data_dims", data.getDimensions());
+    derived.createAttribute("data_mtime", int64_t(data.getInfo().getModificationTime()));
+    derived.createAttribute("data_sample", sampleData(data));
 }
 
-template <typename T>
-std::vector<NodeID> ReportReader<T>::Population::getNodeIds() const {
-    return node_ids_;
+// Was `derived` computed from the current `data`, i.e. does its fingerprint still match? The
+// sampled values are compared bitwise, NaNs included
+template <typename Derived>
+bool isDataFingerprint(const HighFive::DataSet& data, const Derived& derived) {
+    for (const char* name : {"data_generation", "data_dims", "data_mtime", "data_sample"}) {
+        if (!derived.hasAttribute(name)) {
+            return false;
+        }
+    }
+    if (!data.hasAttribute("generation")) {
+        return false;
+    }
+    uint64_t generation = 0;
+    uint64_t derived_generation = 0;
+    data.getAttribute("generation").read(generation);
+    derived.getAttribute("data_generation").read(derived_generation);
+    std::vector<size_t> derived_dims;
+    derived.getAttribute("data_dims").read(derived_dims);
+    int64_t derived_mtime = 0;
+    derived.getAttribute("data_mtime").read(derived_mtime);
+    if (generation != derived_generation || derived_dims != data.getDimensions() ||
+        derived_mtime != int64_t(data.getInfo().getModificationTime())) {
+        return false;
+    }
+    std::vector<float> derived_sample;
+    derived.getAttribute("data_sample").read(derived_sample);
+    const auto sample = sampleData(data);
+    return sample.size() == derived_sample.size() &&
+           std::memcmp(sample.data(), derived_sample.data(), sample.size() * sizeof(float)) == 0;
 }
 
-template <typename T>
-typename ReportReader<T>::Population::NodeIdElementLayout
-ReportReader<T>::Population::getNodeIdElementLayout(
-    const nonstd::optional<Selection>& node_ids,
-    const nonstd::optional<size_t>& _block_gap_limit) const {
-    NodeIdElementLayout result;
-    std::vector<NodeID> concrete_node_ids;
-    size_t element_ids_count = 0;
+// Return the number of frames of a report from `tstart` to `tstop` every `tstep`: the times
+// `tstart + i * tstep` before `tstop`
+size_t reportFrameCount(double tstart, double tstop, double tstep) {
+    const double n_frames = std::ceil((tstop - EPSILON - tstart) / tstep);
+    return n_frames > 0 ? static_cast<size_t>(n_frames) : 0;
+}
 
-    // Set the gap between IO blocks while fetching data (Default: 64MB / 4 x GPFS blocks)
-    const size_t block_gap_limit = _block_gap_limit.value_or(16777216);
+// Return the positions of `node_ids`, sorted by node id
+std::vector<uint64_t> sortedNodeIndex(const std::vector<NodeID>& node_ids) {
+    std::vector<uint64_t> node_index(node_ids.size());
+    std::iota(node_index.begin(), node_index.end(), uint64_t{0});
+    std::sort(node_index.begin(), node_index.end(), [&](const uint64_t i, const uint64_t j) {
+        return node_ids[i] < node_ids[j];
+    });
+    return node_index;
+}
 
-    if (block_gap_limit < 4194304) {
-        throw SonataError("block_gap_limit must be at least 4194304 (16MB / 1 x GPFS block)");
+// Is `node_index` a permutation of the positions of `node_ids` sorting them by node id? Checked
+// in linear time, before trusting an index read from a file
+bool isSortedNodeIndex(const std::vector<uint64_t>& node_index,
+                       const std::vector<NodeID>& node_ids) {
+    if (node_index.size() != node_ids.size()) {
+        return false;
     }
+    std::vector<bool> seen(node_ids.size(), false);
+    for (size_t i = 0; i < node_index.size(); ++i) {
+        const auto position = node_index[i];
+        if (position >= node_ids.size() || seen[position] ||
+            (i > 0 && node_ids[position] < node_ids[node_index[i - 1]])) {
+            return false;
+        }
+        seen[position] = true;
+    }
+    return true;
+}
 
-    // Take all nodes if no selection is provided
-    if (!node_ids) {
-        concrete_node_ids = node_ids_;
-        result.node_ranges = node_ranges_;
-        result.node_offsets = node_offsets_;
-        result.node_index = node_index_;
-        element_ids_count = node_offsets_.back();
-    } else if (!node_ids->empty()) {
-        const auto selected_node_ids = node_ids->flatten();
+// Position in a report mapping of each of its node ids, to look up the selected nodes in constant
+// time instead of a binary search each: a table indexed by node id when the ids are compact, an
+// open addressing hash table otherwise. A node id listed several times maps to its first
+// position in the sorted node index, as with a binary search.
+class NodeRowTable
+{
+  public:
+    static constexpr uint64_t NOT_FOUND = std::numeric_limits<uint64_t>::max();
 
-        for (const auto node_id : selected_node_ids) {
-            const auto it = std::lower_bound(node_index_.begin(),
-                                             node_index_.end(),
-                                             node_id,
-                                             [&](const size_t i, const NodeID node_id) {
-                                                 return node_ids_[i] < node_id;
-                                             });
+    NodeRowTable() = default;
 
-            if (it != node_index_.end() && node_ids_[*it] == node_id) {
-                const auto& range = node_ranges_[*it];
+    NodeRowTable(const std::vector<NodeID>& node_ids, const std::vector<uint64_t>& node_index) {
+        if (node_ids.empty()) {
+            return;
+        }
 
-                concrete_node_ids.emplace_back(node_id);
-                result.node_ranges.emplace_back(range);
-                result.node_offsets.emplace_back(element_ids_count);
-                result.node_index.emplace_back(result.node_index.size());
+        const auto min_max = std::minmax_element(node_ids.begin(), node_ids.end());
+        min_id_ = *min_max.first;
+        const uint64_t span = *min_max.second - min_id_;
+        if (span < NODE_ROWS_DENSE_FACTOR * node_ids.size()) {
+            // In reverse, so that the first position of a node id is the one kept
+            rows_.assign(span + 1, NOT_FOUND);
+            for (auto it = node_index.rbegin(); it != node_index.rend(); ++it) {
+                rows_[node_ids[*it] - min_id_] = *it;
+            }
+            return;
+        }
 
-                element_ids_count += (std::get<1>(range) - std::get<0>(range));
+        // At most half full, so that probe sequences stay short
+        size_t n_slots = 2;
+        shift_ = 63;
+        while (n_slots < 2 * node_ids.size()) {
+            n_slots *= 2;
+            --shift_;
+        }
+        slots_.assign(n_slots, {0, NOT_FOUND});
+        for (const auto position : node_index) {
+            const NodeID node_id = node_ids[position];
+            size_t slot = hashSlot(node_id);
+            while (slots_[slot].second != NOT_FOUND && slots_[slot].first != node_id) {
+                slot = (slot + 1) & (n_slots - 1);
+            }
+            if (slots_[slot].second == NOT_FOUND) {
+                slots_[slot] = {node_id, position};
             }
         }
-    } else {
-        // node_ids Selection exists, but is empty
     }
 
-    // Extract the ElementIDs from the GIDs
-    if (!concrete_node_ids.empty()) {
-        // Sort the index by the selected ranges
-        std::sort(result.node_index.begin(),
-                  result.node_index.end(),
-                  [&](const size_t i, const size_t j) {
-                      return std::get<0>(result.node_ranges[i]) <
-                             std::get<0>(result.node_ranges[j]);
-                  });
-
-        // Generate the {min,max} IO blocks for the requests
-        size_t offset = 0;
-        for (size_t i = 0; (i + 1) < result.node_index.size(); i++) {
-            const auto index = result.node_index[i];
-            const auto index_next = result.node_index[i + 1];
-            const auto max = std::get<1>(result.node_ranges[index]);
-            const auto min_next = std::get<0>(result.node_ranges[index_next]);
-
-            if ((min_next - max) > block_gap_limit) {
-                result.min_max_blocks.push_back({offset, (i + 1)});
-                offset = (i + 1);
+    // Return the position of `node_id` in the mapping, or NOT_FOUND
+    uint64_t find(NodeID node_id) const {
+        if (!rows_.empty()) {
+            if (node_id < min_id_ || node_id - min_id_ >= rows_.size()) {
+                return NOT_FOUND;
             }
+            return rows_[node_id - min_id_];
+        }
+        if (slots_.empty()) {
+            return NOT_FOUND;
         }
-        result.min_max_blocks.push_back({offset, result.node_index.size()});
+        size_t slot = hashSlot(node_id);
+        while (slots_[slot].second != NOT_FOUND && slots_[slot].first != node_id) {
+            slot = (slot + 1) & (slots_.size() - 1);
+        }
+        return slots_[slot].second;
+    }
 
-        // Fill the GID-ElementID mapping in blocks to reduce the file system overhead
-        std::vector<ElementID> element_ids;
-        auto dataset_elem_ids = pop_group_.getGroup("mapping").getDataSet("element_ids");
+  private:
+    // Fibonacci hashing: the top bits of the product by 2^64 / golden ratio
+    size_t hashSlot(NodeID node_id) const {
+        return static_cast<size_t>((node_id * uint64_t{0x9e3779b97f4a7c15}) >> shift_);
+    }
 
-        result.ids.resize(element_ids_count);
+    NodeID min_id_ = 0;
+    std::vector<uint64_t> rows_;                      // By node id - min_id_, if compact
+    std::vector<std::pair<NodeID, uint64_t>> slots_;  // Otherwise, the hash table
+    unsigned shift_ = 63;
+};
+
+constexpr uint64_t NodeRowTable::NOT_FOUND;
+
+// Return the {frames, elements} dimensions of the `chunk_size` chunks of the 'data' dataset of a
+// report with `n_frames` frames of `n_elements` elements, for a chunked `shape`; the chunks span
+// at most `max_rows` frames
+std::vector<hsize_t> reportChunkDims(ReportWriter::ChunkShape shape,
+                                     size_t n_frames,
+                                     size_t n_elements,
+                                     size_t chunk_size,
+                                     size_t max_rows = std::numeric_limits<size_t>::max()) {
+    chunk_size = std::max<size_t>(1, chunk_size);
+
+    size_t rows = 1;
+    if (shape == ReportWriter::ChunkShape::time_major) {
+        rows = chunk_size / n_elements;
+    } else if (shape == ReportWriter::ChunkShape::element_major) {
+        rows = chunk_size;
+    } else {
+        rows = std::max(static_cast<size_t>(std::sqrt(static_cast<double>(chunk_size))),
+                        chunk_size / n_elements);
+    }
+    rows = std::max<size_t>(1, std::min({rows, n_frames, max_rows}));
+    const size_t cols = std::max<size_t>(1, std::min(chunk_size / rows, n_elements));
+    return {rows, cols};
+}
+
+}  // anonymous namespace
+
+namespace bbp {
+namespace sonata {
+
+SpikeReader::SpikeReader(std::string filename)
+    : SpikeReader(std::move(filename), false) { }
+
+SpikeReader::SpikeReader(std::string filename, bool lazy)
+    : filename_(std::move(filename))
+    , lazy_(lazy) { }
+
+std::vector<std::string> SpikeReader::getPopulationNames() const {
+    HighFive::File file = openHDF5withoutLock(filename_);
+    return file.getGroup("/spikes").listObjectNames();
+}
+
+auto SpikeReader::openPopulation(const std::string& populationName) const -> const Population& {
+    if (populations_.find(populationName) == populations_.end()) {
+        populations_.emplace(populationName, Population{filename_, populationName, lazy_});
+    }
+
+    return populations_.at(populationName);
+}
+
+std::tuple<double, double> SpikeReader::Population::getTimes() const {
+    return std::tie(tstart_, tstop_);
+}
+
+/**
+ * The spikes of a population sorted 'by_time' or 'by_id', left in the file.
+ *
+ * The positions of the spikes which can match a query are found by binary search of the sorted
+ * dataset, through a small cache of blocks; only those spikes are then read, block by block.
+ */
+class SpikeReader::Population::LazySpikes
+{
+  public:
+    explicit LazySpikes(const HighFive::Group& pop)
+        : node_ids_(pop.getDataSet("node_ids"))
+        , timestamps_(pop.getDataSet("timestamps"))
+        , size_(timestamps_.getSpace().getDimensions()[0]) { }
+
+    size_t size() const {
+        return size_;
+    }
+
+    double timestamp(size_t i) {
+        return timestamps_cache_.at(timestamps_, size_, i);
+    }
+
+    /**
+     * Smallest and largest timestamps, reading them all block by block
+     */
+    std::pair<double, double> timestampBounds() const {
+        auto bounds = std::make_pair(std::numeric_limits<double>::infinity(),
+                                     -std::numeric_limits<double>::infinity());
+        std::vector<double> values;
+        for (size_t first = 0; first < size_; first += SPIKE_READ_BLOCK_SIZE) {
+            timestamps_.select({first}, {std::min(SPIKE_READ_BLOCK_SIZE, size_ - first)})
+                .read(values);
+            const auto minmax = std::minmax_element(values.begin(), values.end());
+            bounds.first = std::min(bounds.first, *minmax.first);
+            bounds.second = std::max(bounds.second, *minmax.second);
+        }
+        return bounds;
+    }
+
+    /**
+     * Positions of the spikes which can be in `node_ids` and [start, stop], sorted and merged:
+     * the spikes in [start, stop] if sorted 'by_time', those of `node_ids` if sorted 'by_id'
+     */
+    Selection::Ranges candidates(Sorting sorting,
+                                 const nonstd::optional<Selection>& node_ids,
+                                 double start,
+                                 double stop) {
+        Selection::Ranges ranges;
+        if (sorting == Sorting::by_time) {
+            const auto first = partitionPoint(0, [&](size_t i) { return timestamp(i) < start; });
+            const auto last = partitionPoint(first,
+                                             [&](size_t i) { return timestamp(i) <= stop; });
+            ranges.push_back({first, last});
+        } else if (!node_ids) {
+            ranges.push_back({0, size_});
+        } else {
+            size_t first = 0;
+            for (const auto& range : bulk_read::sortAndMerge(node_ids->ranges())) {
+                first = partitionPoint(first, [&](size_t i) { return nodeId(i) < range[0]; });
+                const auto last = partitionPoint(first,
+                                                 [&](size_t i) { return nodeId(i) < range[1]; });
+                ranges.push_back({first, last});
+                first = last;
+            }
+        }
+        return bulk_read::sortAndMerge(ranges);
+    }
+
+    /**
+     * Read the spikes at `positions`, in order, calling `f(spikes)` on each block
+     */
+    template <typename F>
+    void forEachBlock(const Selection::Ranges& positions, F f) const {
+        Selection::Ranges block;
+        size_t block_size = 0;
+        const auto flush = [&]() {
+            const Selection selection(std::move(block));
+            SpikeTimes spikes;
+            spikes.node_ids = detail::readCanonicalSelection<NodeID>(node_ids_, selection);
+            spikes.timestamps = detail::readCanonicalSelection<double>(timestamps_, selection);
+            f(spikes);
+            block.clear();
+            block_size = 0;
+        };
+
+        for (const auto& range : positions) {
+            for (auto first = range[0]; first < range[1];) {
+                const auto last = std::min<uint64_t>(range[1],
+                                                     first + SPIKE_READ_BLOCK_SIZE - block_size);
+                block.push_back({first, last});
+                block_size += last - first;
+                first = last;
+                if (block_size == SPIKE_READ_BLOCK_SIZE) {
+                    flush();
+                }
+            }
+        }
+        if (block_size > 0) {
+            flush();
+        }
+    }
+
+    /**
+     * All the spikes, read on first use
+     */
+    const SpikeTimes& all() {
+        std::call_once(all_flag_, [this]() {
+            node_ids_.read(all_.node_ids);
+            timestamps_.read(all_.timestamps);
+        });
+        return all_;
+    }
+
+  private:
+    NodeID nodeId(size_t i) {
+        return node_ids_cache_.at(node_ids_, size_, i);
+    }
+
+    // First position from `first` for which `pred` is false, `pred` being true then false
+    template <typename Pred>
+    size_t partitionPoint(size_t first, Pred pred) const {
+        size_t last = size_;
+        while (first < last) {
+            const size_t middle = first + (last - first) / 2;
+            if (pred(middle)) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        return first;
+    }
+
+    HighFive::DataSet node_ids_;
+    HighFive::DataSet timestamps_;
+    size_t size_;
+    ProbeCache<NodeID> node_ids_cache_;
+    ProbeCache<double> timestamps_cache_;
+    std::once_flag all_flag_;
+    SpikeTimes all_;
+};
+
+const SpikeTimes& SpikeReader::Population::spikeTimes() const {
+    return lazy_ ? lazy_->all() : spike_times_;
+}
+
+Spikes SpikeReader::Population::get(const nonstd::optional<Selection>& node_ids,
+                                    const nonstd::optional<double>& tstart,
+                                    const nonstd::optional<double>& tstop) const {
+    const double start = tstart.value_or(tstart_);
+    const double stop = tstop.value_or(tstop_);
+
+    if (start < 0 - EPSILON || stop < 0 - EPSILON) {
+        throw SonataError("Times cannot be negative");
+    }
+
+    if (start > stop) {
+        throw SonataError("tstart should be <= to tstop");
+    }
+
+    if (node_ids and node_ids->empty()) {
+        return Spikes{};
+    }
+
+    const double lower = start - EPSILON;
+    const double upper = stop + EPSILON;
+    const bool sorted_by_id = sorting_ == Sorting::by_id;
+    Spikes spikes;
+
+    if (lazy_) {
+        // Spikes sorted by ID are first gathered, to be returned in the order of `node_ids`
+        SpikeTimes matched;
+        const bool by_ranges = node_ids && sorted_by_id;
+        const auto select = [&](const SpikeTimes& block) {
+            const auto size = block.node_ids.size();
+            if (by_ranges) {
+                selectSpikes(block, 0, size, nonstd::nullopt, lower, upper, false, matched);
+            } else {
+                selectSpikes(block, 0, size, node_ids, lower, upper, false, spikes);
+            }
+        };
+        lazy_->forEachBlock(lazy_->candidates(sorting_, node_ids, lower, upper), select);
+        if (by_ranges) {
+            const auto size = matched.node_ids.size();
+            selectSpikes(matched, 0, size, node_ids, lower, upper, true, spikes);
+        }
+        return spikes;
+    }
+
+    const auto& spike_times = spikeTimes();
+    const auto& timestamps = spike_times.timestamps;
+    size_t first = 0;
+    size_t last = timestamps.size();
+    if (sorting_ == Sorting::by_time) {
+        // The candidate spikes are contiguous
+        const auto begin = std::lower_bound(timestamps.begin(), timestamps.end(), lower);
+        const auto end = std::upper_bound(begin, timestamps.end(), upper);
+        first = static_cast<size_t>(begin - timestamps.begin());
+        last = static_cast<size_t>(end - timestamps.begin());
+    }
+    selectSpikes(spike_times, first, last, node_ids, lower, upper, sorted_by_id, spikes);
+    return spikes;
+}
+
+const SpikeTimes& SpikeReader::Population::getRawArrays() const {
+    return spikeTimes();
+}
+
+/**
+ * Indices of the spikes of a population, each built on first use.
+ *
+ * `byNode` holds the positions of the spikes sorted by node ID, then time, with the offsets of
+ * the spikes of each node; `byTime` the positions sorted by time. Ties keep the order of the
+ * file.
+ */
+class SpikeReader::Population::SpikeIndex
+{
+  public:
+    struct ByNode {
+        // Sorted and unique
+        std::vector<NodeID> node_ids;
+        // The spikes of `node_ids[i]` are `positions[offsets[i]:offsets[i + 1]]`
+        std::vector<size_t> offsets;
+        std::vector<size_t> positions;
+    };
+
+    const ByNode& byNode(const SpikeTimes& spikes) {
+        std::call_once(by_node_flag_, [&]() {
+            const auto& node_ids = spikes.node_ids;
+            const auto& timestamps = spikes.timestamps;
+
+            by_node_.positions = sortedPositions(spikes, [&](size_t i, size_t j) {
+                return node_ids[i] < node_ids[j] ||
+                       (node_ids[i] == node_ids[j] && timestamps[i] < timestamps[j]);
+            });
+            for (size_t i = 0; i < by_node_.positions.size(); ++i) {
+                const auto node_id = node_ids[by_node_.positions[i]];
+                if (by_node_.node_ids.empty() || by_node_.node_ids.back() != node_id) {
+                    by_node_.node_ids.push_back(node_id);
+                    by_node_.offsets.push_back(i);
+                }
+            }
+            by_node_.offsets.push_back(by_node_.positions.size());
+        });
+        return by_node_;
+    }
+
+    const std::vector<size_t>& byTime(const SpikeTimes& spikes) {
+        std::call_once(by_time_flag_, [&]() {
+            const auto& timestamps = spikes.timestamps;
+            by_time_ = sortedPositions(spikes, [&](size_t i, size_t j) {
+                return timestamps[i] < timestamps[j];
+            });
+        });
+        return by_time_;
+    }
+
+  private:
+    template <typename Compare>
+    static std::vector<size_t> sortedPositions(const SpikeTimes& spikes, Compare compare) {
+        std::vector<size_t> positions(spikes.node_ids.size());
+        std::iota(positions.begin(), positions.end(), size_t(0));
+        std::stable_sort(positions.begin(), positions.end(), compare);
+        return positions;
+    }
+
+    std::once_flag by_node_flag_;
+    std::once_flag by_time_flag_;
+    ByNode by_node_;
+    std::vector<size_t> by_time_;
+};
+
+SpikeTimes SpikeReader::Population::getArrays(const nonstd::optional<Selection>& node_ids,
+                                              const nonstd::optional<double>& tstart,
+                                              const nonstd::optional<double>& tstop) const {
+    if (!node_ids && !tstart && !tstop) {
+        return spikeTimes();
+    }
+
+    SpikeTimes spikes;
+    getArrays(spikes, node_ids, tstart, tstop);
+    return spikes;
+}
+
+void SpikeReader::Population::getArrays(SpikeTimes& spikes,
+                                        const nonstd::optional<Selection>& node_ids,
+                                        const nonstd::optional<double>& tstart,
+                                        const nonstd::optional<double>& tstop) const {
+    if (!node_ids && !tstart && !tstop) {
+        spikes = spikeTimes();
+        return;
+    }
+
+    spikes.node_ids.clear();
+    spikes.timestamps.clear();
+
+    const double start = tstart.value_or(-std::numeric_limits<double>::infinity());
+    const double stop = tstop.value_or(std::numeric_limits<double>::infinity());
+
+    if (lazy_) {
+        lazy_->forEachBlock(lazy_->candidates(sorting_, node_ids, start, stop),
+                            [&](const SpikeTimes& block) {
+                                const auto size = block.node_ids.size();
+                                selectSpikes(block, 0, size, node_ids, start, stop, false, spikes);
+                            });
+        return;
+    }
+
+    const auto& spike_times = spikeTimes();
+    const auto& timestamps = spike_times.timestamps;
+    const auto size = timestamps.size();
+
+    if (!node_ids && sorting_ == Sorting::by_time) {
+        // The spikes in [start, stop] are contiguous
+        const auto begin = std::lower_bound(timestamps.begin(), timestamps.end(), start);
+        const auto end = std::upper_bound(begin, timestamps.end(), stop);
+        const auto first = static_cast<ptrdiff_t>(begin - timestamps.begin());
+        const auto last = static_cast<ptrdiff_t>(end - timestamps.begin());
+        spikes.node_ids.assign(spike_times.node_ids.begin() + first,
+                               spike_times.node_ids.begin() + last);
+        spikes.timestamps.assign(begin, end);
+        return;
+    }
+
+    if (sorting_ == Sorting::by_id) {
+        // The spikes of each range of nodes are contiguous, and merged ranges keep the file order
+        const auto merged = node_ids ? nonstd::optional<Selection>(
+                                           Selection(bulk_read::sortAndMerge(node_ids->ranges())))
+                                     : nonstd::nullopt;
+        selectSpikes(spike_times, 0, size, merged, start, stop, true, spikes);
+        return;
+    }
+
+    const auto before_start = [&](size_t position, double t) { return timestamps[position] < t; };
+    const auto after_stop = [&](double t, size_t position) { return t < timestamps[position]; };
+
+    std::vector<size_t> positions;
+    if (node_ids) {
+        // Spikes of each selected node, restricted to [start, stop] by bisection
+        const auto& index = index_->byNode(spike_times);
+        for (const auto& range : bulk_read::sortAndMerge(node_ids->ranges())) {
+            auto it = std::lower_bound(index.node_ids.begin(), index.node_ids.end(), range[0]);
+            for (; it != index.node_ids.end() && *it < range[1]; ++it) {
+                const auto i = static_cast<size_t>(it - index.node_ids.begin());
+                const auto node_begin = index.positions.begin() +
+                                        static_cast<ptrdiff_t>(index.offsets[i]);
+                const auto node_end = index.positions.begin() +
+                                      static_cast<ptrdiff_t>(index.offsets[i + 1]);
+                const auto begin = std::lower_bound(node_begin, node_end, start, before_start);
+                const auto end = std::upper_bound(begin, node_end, stop, after_stop);
+                positions.insert(positions.end(), begin, end);
+            }
+        }
+    } else {
+        const auto& index = index_->byTime(spike_times);
+        const auto begin = std::lower_bound(index.begin(), index.end(), start, before_start);
+        const auto end = std::upper_bound(begin, index.end(), stop, after_stop);
+        positions.assign(begin, end);
+    }
+
+    // Back to the order of the file
+    std::sort(positions.begin(), positions.end());
+    reserveSpikes(spikes, positions.size());
+    for (const auto position : positions) {
+        appendSpike(spikes, spike_times.node_ids[position], timestamps[position]);
+    }
+}
+
+std::pair<size_t, size_t> SpikeReader::Population::nodeSpikes(NodeID node_id,
+                                                              double tstart,
+                                                              double tstop) const {
+    const auto& spike_times = spikeTimes();
+    const auto& timestamps = spike_times.timestamps;
+    const auto& index = index_->byNode(spike_times);
+
+    const auto it = std::lower_bound(index.node_ids.begin(), index.node_ids.end(), node_id);
+    if (it == index.node_ids.end() || *it != node_id) {
+        return {0, 0};
+    }
+
+    const auto i = static_cast<size_t>(it - index.node_ids.begin());
+    const auto node_begin = index.positions.begin() + static_cast<ptrdiff_t>(index.offsets[i]);
+    const auto node_end = index.positions.begin() + static_cast<ptrdiff_t>(index.offsets[i + 1]);
+    const auto begin = std::lower_bound(node_begin,
+                                        node_end,
+                                        tstart,
+                                        [&](size_t position, double t) {
+                                            return timestamps[position] < t;
+                                        });
+    const auto end = std::upper_bound(begin, node_end, tstop, [&](double t, size_t position) {
+        return t < timestamps[position];
+    });
+    return {static_cast<size_t>(begin - index.positions.begin()),
+            static_cast<size_t>(end - index.positions.begin())};
+}
+
+std::vector<uint64_t> SpikeReader::Population::binnedCounts(
+    const nonstd::optional<Selection>& node_ids,
+    double tstart,
+    double tstop,
+    double binSize,
+    size_t n_threads) const {
+    if (!(binSize > 0)) {
+        throw SonataError("binSize must be positive");
+    }
+
+    if (!(tstart < tstop)) {
+        throw SonataError("tstart should be < to tstop");
+    }
+
+    const auto n_bins = static_cast<size_t>(std::ceil((tstop - tstart) / binSize));
+    const auto& spike_times = spikeTimes();
+    const auto& timestamps = spike_times.timestamps;
+    const auto count = [&](std::vector<uint64_t>& counts, double timestamp) {
+        if (timestamp >= tstart && timestamp < tstop) {
+            const auto bin = static_cast<size_t>((timestamp - tstart) / binSize);
+            ++counts[std::min(bin, n_bins - 1)];
+        }
+    };
+
+    // Each thread counts a slice of the spikes in its own bins
+    const size_t n_slices = std::max<size_t>(1, n_threads);
+    std::vector<std::vector<uint64_t>> slice_counts(n_slices, std::vector<uint64_t>(n_bins, 0));
+    const auto sliceBounds = [n_slices](size_t size, size_t slice) {
+        return std::make_pair(size * slice / n_slices, size * (slice + 1) / n_slices);
+    };
+
+    if (!node_ids) {
+        size_t first = 0;
+        size_t last = timestamps.size();
+        if (sorting_ == Sorting::by_time) {
+            const auto begin = std::lower_bound(timestamps.begin(), timestamps.end(), tstart);
+            first = static_cast<size_t>(begin - timestamps.begin());
+            last = static_cast<size_t>(std::lower_bound(begin, timestamps.end(), tstop) -
+                                       timestamps.begin());
+        }
+        parallel_read::parallelFor(n_slices, n_threads, [&](size_t slice) {
+            const auto bounds = sliceBounds(last - first, slice);
+            for (size_t i = first + bounds.first; i < first + bounds.second; ++i) {
+                count(slice_counts[slice], timestamps[i]);
+            }
+        });
+    } else {
+        // The spikes of each selected node, in the index by node
+        const auto& index = index_->byNode(spike_times);
+        std::vector<std::pair<size_t, size_t>> node_spikes;
+        for (const auto& range : bulk_read::sortAndMerge(node_ids->ranges())) {
+            auto it = std::lower_bound(index.node_ids.begin(), index.node_ids.end(), range[0]);
+            for (; it != index.node_ids.end() && *it < range[1]; ++it) {
+                const auto i = static_cast<size_t>(it - index.node_ids.begin());
+                node_spikes.emplace_back(index.offsets[i], index.offsets[i + 1]);
+            }
+        }
+        parallel_read::parallelFor(n_slices, n_threads, [&](size_t slice) {
+            const auto bounds = sliceBounds(node_spikes.size(), slice);
+            for (size_t i = bounds.first; i < bounds.second; ++i) {
+                for (size_t k = node_spikes[i].first; k < node_spikes[i].second; ++k) {
+                    count(slice_counts[slice], timestamps[index.positions[k]]);
+                }
+            }
+        });
+    }
+
+    auto& counts = slice_counts[0];
+    for (size_t slice = 1; slice < n_slices; ++slice) {
+        for (size_t bin = 0; bin < n_bins; ++bin) {
+            counts[bin] += slice_counts[slice][bin];
+        }
+    }
+    return std::move(counts);
+}
+
+std::vector<double> SpikeReader::Population::firingRates(const Selection& node_ids,
+                                                         const nonstd::optional<double>& tstart,
+                                                         const nonstd::optional<double>& tstop,
+                                                         size_t n_threads) const {
+    const double start = tstart.value_or(tstart_);
+    const double stop = tstop.value_or(tstop_);
+    if (!(start < stop)) {
+        throw SonataError("tstart should be < to tstop");
+    }
+
+    const auto nodes = node_ids.flatten();
+    std::vector<double> rates(nodes.size());
+    const size_t n_tasks = (nodes.size() + SPIKE_STATS_NODE_BLOCK_SIZE - 1) /
+                           SPIKE_STATS_NODE_BLOCK_SIZE;
+    parallel_read::parallelFor(n_tasks, n_threads, [&](size_t task) {
+        const size_t last = std::min(nodes.size(), (task + 1) * SPIKE_STATS_NODE_BLOCK_SIZE);
+        for (size_t i = task * SPIKE_STATS_NODE_BLOCK_SIZE; i < last; ++i) {
+            const auto spikes = nodeSpikes(nodes[i], start, stop);
+            rates[i] = static_cast<double>(spikes.second - spikes.first) / (stop - start);
+        }
+    });
+    return rates;
+}
+
+IsiStats SpikeReader::Population::isiStats(const Selection& node_ids,
+                                           const nonstd::optional<double>& tstart,
+                                           const nonstd::optional<double>& tstop,
+                                           size_t n_threads) const {
+    const double start = tstart.value_or(tstart_);
+    const double stop = tstop.value_or(tstop_);
+    if (start > stop) {
+        throw SonataError("tstart should be <= to tstop");
+    }
+
+    const auto& spike_times = spikeTimes();
+    const auto& timestamps = spike_times.timestamps;
+    const auto& positions = index_->byNode(spike_times).positions;
+
+    IsiStats stats;
+    stats.node_ids = node_ids.flatten();
+    const size_t size = stats.node_ids.size();
+    stats.counts.resize(size);
+    stats.means.resize(size);
+    stats.cvs.resize(size);
+
+    const size_t n_tasks = (size + SPIKE_STATS_NODE_BLOCK_SIZE - 1) / SPIKE_STATS_NODE_BLOCK_SIZE;
+    parallel_read::parallelFor(n_tasks, n_threads, [&](size_t task) {
+        const size_t last = std::min(size, (task + 1) * SPIKE_STATS_NODE_BLOCK_SIZE);
+        for (size_t i = task * SPIKE_STATS_NODE_BLOCK_SIZE; i < last; ++i) {
+            const auto spikes = nodeSpikes(stats.node_ids[i], start, stop);
+            const auto n_spikes = spikes.second - spikes.first;
+            if (n_spikes < 2) {
+                stats.counts[i] = 0;
+                stats.means[i] = stats.cvs[i] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+
+            const auto timestamp = [&](size_t k) {
+                return timestamps[positions[spikes.first + k]];
+            };
+            const auto n_intervals = n_spikes - 1;
+            const double mean = (timestamp(n_intervals) - timestamp(0)) /
+                                static_cast<double>(n_intervals);
+            double variance = 0;
+            for (size_t k = 0; k < n_intervals; ++k) {
+                const double deviation = timestamp(k + 1) - timestamp(k) - mean;
+                variance += deviation * deviation;
+            }
+            variance /= static_cast<double>(n_intervals);
+
+            stats.counts[i] = n_intervals;
+            stats.means[i] = mean;
+            stats.cvs[i] = std::sqrt(variance) / mean;
+        }
+    });
+    return stats;
+}
+
+SpikeReader::Population::Sorting SpikeReader::Population::getSorting() const {
+    return sorting_;
+}
+
+std::string SpikeReader::Population::getTimeUnits() const {
+    return time_units_;
+}
+
+SpikeReader::Population::Population(const std::string& filename,
+                                    const std::string& populationName,
+                                    bool lazy)
+    : index_(std::make_shared<SpikeIndex>()) {
+    HighFive::File file = openHDF5withoutLock(filename);
+
+    const auto pop_path = std::string("/spikes/") + populationName;
+    const auto pop = file.getGroup(pop_path);
+    auto& node_ids = spike_times_.node_ids;
+    auto& timestamps = spike_times_.timestamps;
+
+    if (pop.hasAttribute("sorting")) {
+        pop.getAttribute("sorting").read(sorting_);
+    }
+
+    pop.getDataSet("timestamps").getAttribute("units").read(time_units_);
+
+    if (lazy && sorting_ != Sorting::none) {
+        if (pop.getDataSet("node_ids").getSpace().getDimensions()[0] !=
+            pop.getDataSet("timestamps").getSpace().getDimensions()[0]) {
+            throw SonataError(
+                "In spikes file, 'node_ids' and 'timestamps' does not have the same size.");
+        }
+
+        lazy_ = std::make_shared<LazySpikes>(pop);
+        const auto size = lazy_->size();
+        if (size == 0) {
+            tstart_ = tstop_ = 0;
+        } else if (sorting_ == Sorting::by_time) {
+            tstart_ = lazy_->timestamp(0);
+            tstop_ = lazy_->timestamp(size - 1);
+        } else {
+            std::tie(tstart_, tstop_) = lazy_->timestampBounds();
+        }
+        return;
+    }
+
+    pop.getDataSet("node_ids").read(node_ids);
+    pop.getDataSet("timestamps").read(timestamps);
+
+    if (node_ids.size() != timestamps.size()) {
+        throw SonataError(
+            "In spikes file, 'node_ids' and 'timestamps' does not have the same size.");
+    }
+
+    if (sorting_ == Sorting::by_time) {
+        tstart_ = timestamps.empty() ? 0 : timestamps.front();
+        tstop_ = timestamps.empty() ? 0 : timestamps.back();
+    } else {
+        tstart_ = timestamps.empty() ? 0 : *min_element(timestamps.cbegin(), timestamps.cend());
+        tstop_ = timestamps.empty() ? 0 : *max_element(timestamps.cbegin(), timestamps.cend());
+    }
+}
+
+SpikeWriter::SpikeWriter(std::string filename, size_t n_threads)
+    : filename_(std::move(filename))
+    , n_threads_(n_threads) { }
+
+void SpikeWriter::addPopulation(const std::string& populationName,
+                                Sorting sorting,
+                                const std::string& timeUnits) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (written_) {
+        throw SonataError(fmt::format("'{}' was already written", filename_));
+    }
+    if (populations_.find(populationName) != populations_.end()) {
+        throw SonataError(fmt::format("Population '{}' was already added", populationName));
+    }
+
+    populations_.emplace(populationName, PopulationSpikes{sorting, timeUnits, {}});
+}
+
+void SpikeWriter::addSpikes(const std::string& populationName,
+                            const std::vector<NodeID>& node_ids,
+                            const std::vector<double>& timestamps) {
+    if (node_ids.size() != timestamps.size()) {
+        throw SonataError("'node_ids' and 'timestamps' must have the same size");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (written_) {
+        throw SonataError(fmt::format("'{}' was already written", filename_));
+    }
+    const auto it = populations_.find(populationName);
+    if (it == populations_.end()) {
+        throw SonataError(fmt::format("Population '{}' was not added", populationName));
+    }
+
+    auto& spikes = it->second.spikes;
+    spikes.node_ids.insert(spikes.node_ids.end(), node_ids.begin(), node_ids.end());
+    spikes.timestamps.insert(spikes.timestamps.end(), timestamps.begin(), timestamps.end());
+}
+
+void SpikeWriter::write(size_t chunkSize, unsigned compressionLevel) {
+    if (chunkSize == 0 && compressionLevel > 0) {
+        throw SonataError("Only chunked datasets can be compressed");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (written_) {
+        // Writing again would truncate the file, losing the spikes already written
+        throw SonataError(fmt::format("'{}' was already written", filename_));
+    }
+    // Even if it fails below, as the spikes are dropped as they are written
+    written_ = true;
+    HighFive::File file(filename_, HighFive::File::Truncate);
+    auto spikes_group = file.createGroup("spikes");
+
+    for (auto& entry : populations_) {
+        auto& population = entry.second;
+        auto& spikes = population.spikes;
+        if (population.sorting != Sorting::none) {
+            sortSpikes(spikes, population.sorting == Sorting::by_id, n_threads_);
+        }
+
+        const size_t size = spikes.node_ids.size();
+        HighFive::DataSetCreateProps props;
+        if (chunkSize > 0 && size > 0) {
+            props.add(HighFive::Chunking(std::vector<hsize_t>{std::min(chunkSize, size)}));
+            if (compressionLevel > 0) {
+                props.add(HighFive::Deflate(compressionLevel));
+            }
+        }
+
+        auto pop = spikes_group.createGroup(entry.first);
+        pop.createAttribute("sorting", population.sorting);
+        auto node_ids = pop.createDataSet<NodeID>("node_ids", HighFive::DataSpace({size}), props);
+        auto timestamps =
+            pop.createDataSet<double>("timestamps", HighFive::DataSpace({size}), props);
+        timestamps.createAttribute("units", population.time_units);
+        if (size > 0) {
+            node_ids.write(spikes.node_ids);
+            timestamps.write(spikes.timestamps);
+        }
+
+        spikes = SpikeTimes{};
+    }
+}
+
+/**
+ * The position in a population of a MergedSpikeReader, and the block of spikes around it.
+ */
+class MergedSpikeReader::Cursor
+{
+  public:
+    Cursor(const HighFive::Group& pop, Sorting sorting, size_t blockSize)
+        : node_ids_(pop.getDataSet("node_ids"))
+        , timestamps_(pop.getDataSet("timestamps"))
+        , size_(timestamps_.getSpace().getDimensions()[0])
+        , block_size_(std::max<size_t>(1, blockSize)) {
+        if (node_ids_.getSpace().getDimensions()[0] != size_) {
+            throw SonataError(
+                "In spikes file, 'node_ids' and 'timestamps' does not have the same size.");
+        }
+
+        Sorting population_sorting = Sorting::none;
+        if (pop.hasAttribute("sorting")) {
+            pop.getAttribute("sorting").read(population_sorting);
+        }
+
+        if (population_sorting != sorting) {
+            node_ids_.read(block_.node_ids);
+            timestamps_.read(block_.timestamps);
+            sortSpikes(block_, sorting == Sorting::by_id, 1);
+            streamed_ = false;
+        }
+    }
+
+    size_t remaining() const {
+        return size_ - position_;
+    }
+
+    NodeID nodeId() const {
+        return block_.node_ids[position_ - block_start_];
+    }
+
+    double timestamp() const {
+        return block_.timestamps[position_ - block_start_];
+    }
+
+    void advance() {
+        ++position_;
+        if (streamed_ && position_ == block_start_ + block_.node_ids.size() && position_ < size_) {
+            load();
+        }
+    }
+
+    void reset() {
+        position_ = 0;
+        if (streamed_ && size_ > 0) {
+            load();
+        }
+    }
+
+  private:
+    void load() {
+        const size_t count = std::min(block_size_, size_ - position_);
+        node_ids_.select({position_}, {count}).read(block_.node_ids);
+        timestamps_.select({position_}, {count}).read(block_.timestamps);
+        block_start_ = position_;
+    }
+
+    HighFive::DataSet node_ids_;
+    HighFive::DataSet timestamps_;
+    size_t size_;
+    size_t block_size_;
+    // Read block by block if sorted as merged, otherwise held sorted in `block_`
+    bool streamed_ = true;
+    SpikeTimes block_;
+    size_t block_start_ = 0;
+    size_t position_ = 0;
+};
+
+MergedSpikeReader::MergedSpikeReader(std::vector<Source> sources,
+                                     Sorting sorting,
+                                     size_t blockSize)
+    : sources_(std::move(sources))
+    , sorting_(sorting) {
+    if (sorting_ == Sorting::none) {
+        throw SonataError("Spikes can only be merged 'by_time' or 'by_id'");
+    }
+
+    for (const auto& source : sources_) {
+        const auto file = openHDF5withoutLock(source.first);
+        const auto pop = file.getGroup(std::string("/spikes/") + source.second);
+        cursors_.emplace_back(new Cursor(pop, sorting_, blockSize));
+    }
+    reset();
+}
+
+MergedSpikeReader::MergedSpikeReader(MergedSpikeReader&&) noexcept = default;
+MergedSpikeReader& MergedSpikeReader::operator=(MergedSpikeReader&&) noexcept = default;
+MergedSpikeReader::~MergedSpikeReader() = default;
+
+const std::vector<MergedSpikeReader::Source>& MergedSpikeReader::getSources() const {
+    return sources_;
+}
+
+bool MergedSpikeReader::after(size_t lhs, size_t rhs) const {
+    const auto& left = *cursors_[lhs];
+    const auto& right = *cursors_[rhs];
+    if (sorting_ == Sorting::by_time) {
+        if (left.timestamp() != right.timestamp()) {
+            return left.timestamp() > right.timestamp();
+        }
+    } else if (left.nodeId() != right.nodeId()) {
+        return left.nodeId() > right.nodeId();
+    }
+    return lhs > rhs;
+}
+
+MergedSpikes MergedSpikeReader::next(size_t maxSpikes) {
+    const auto compare = [this](size_t lhs, size_t rhs) { return after(lhs, rhs); };
+
+    size_t remaining = 0;
+    for (const auto i : heap_) {
+        remaining += cursors_[i]->remaining();
+    }
+    const size_t count = std::min(maxSpikes, remaining);
+
+    MergedSpikes spikes;
+    spikes.node_ids.reserve(count);
+    spikes.timestamps.reserve(count);
+    spikes.sources.reserve(count);
+    for (size_t n = 0; n < count; ++n) {
+        std::pop_heap(heap_.begin(), heap_.end(), compare);
+        const auto i = heap_.back();
+        auto& cursor = *cursors_[i];
+
+        spikes.node_ids.push_back(cursor.nodeId());
+        spikes.timestamps.push_back(cursor.timestamp());
+        spikes.sources.push_back(i);
+
+        cursor.advance();
+        if (cursor.remaining() == 0) {
+            heap_.pop_back();
+        } else {
+            std::push_heap(heap_.begin(), heap_.end(), compare);
+        }
+    }
+    return spikes;
+}
+
+bool MergedSpikeReader::done() const {
+    return heap_.empty();
+}
+
+void MergedSpikeReader::reset() {
+    heap_.clear();
+    for (size_t i = 0; i < cursors_.size(); ++i) {
+        cursors_[i]->reset();
+        if (cursors_[i]->remaining() > 0) {
+            heap_.push_back(i);
+        }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), [this](size_t lhs, size_t rhs) {
+        return after(lhs, rhs);
+    });
+}
+
+template <typename T>
+ReportReader<T>::ReportReader(const std::string& filename, size_t n_threads)
+    : file_([&filename] {
+        HDF5_LOCK_GUARD
+        return openHDF5withoutLock(filename);
+    }())
+    , n_threads_(n_threads) { }
+
+template <typename T>
+std::vector<std::string> ReportReader<T>::getPopulationNames() const {
+    HDF5_LOCK_GUARD
+    return file_.getGroup("/report").listObjectNames();
+}
+
+template <typename T>
+auto ReportReader<T>::openPopulation(const std::string& populationName) const -> const Population& {
+    HDF5_LOCK_GUARD
+    if (populations_.find(populationName) == populations_.end()) {
+        populations_.emplace(populationName, Population{file_, populationName, n_threads_});
+    }
+
+    return populations_.at(populationName);
+}
+
+/**
+ * Least recently used cache of the layouts computed by `getNodeIdElementLayout`, keyed on the
+ * node selection and the block gap limit. Layouts with more element IDs than the cache can hold
+ * are not cached.
+ */
+template <typename T>
+class ReportReader<T>::Population::LayoutCache
+{
+  public:
+    using Layout = std::shared_ptr<const NodeIdElementLayout>;
+
+    struct Key {
+        bool all_nodes;
+        Selection::Ranges ranges;
+        size_t block_gap_limit;
+
+        bool operator==(const Key& other) const {
+            return all_nodes == other.all_nodes && block_gap_limit == other.block_gap_limit &&
+                   ranges == other.ranges;
+        }
+    };
+
+    Layout find(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = findEntry(key);
+        if (it == entries_.end()) {
+            return nullptr;
+        }
+
+        // Mark as most recently used
+        entries_.splice(entries_.begin(), entries_, it);
+        return it->second;
+    }
+
+    void insert(Key key, Layout layout) {
+        const size_t n_ids = layout->ids.size();
+        if (n_ids > LAYOUT_CACHE_MAX_IDS) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (findEntry(key) != entries_.end()) {  // Computed concurrently by another thread
+            return;
+        }
+
+        entries_.emplace_front(std::move(key), std::move(layout));
+        total_ids_ += n_ids;
+        while (entries_.size() > LAYOUT_CACHE_MAX_ENTRIES || total_ids_ > LAYOUT_CACHE_MAX_IDS) {
+            total_ids_ -= entries_.back().second->ids.size();
+            entries_.pop_back();
+        }
+    }
+
+  private:
+    using Entries = std::list<std::pair<Key, Layout>>;
+
+    typename Entries::iterator findEntry(const Key& key) {
+        return std::find_if(entries_.begin(),
+                            entries_.end(),
+                            [&](const typename Entries::value_type& entry) {
+                                return entry.first == key;
+                            });
+    }
+
+    std::mutex mutex_;
+    Entries entries_;  // Most recently used first
+    size_t total_ids_ = 0;
+};
+
+/**
+ * The node ids of the mapping of a population, with the range of the columns of each node, their
+ * offsets in the columns, their index sorted by node id and their positions by node id, read by
+ * `Population::getNodeMapping` on first use.
+ */
+template <typename T>
+class ReportReader<T>::Population::NodeMapping
+{
+  public:
+    std::vector<NodeID> node_ids;
+    std::vector<Selection::Range> node_ranges;
+    std::vector<uint64_t> node_offsets;
+    std::vector<uint64_t> node_index;
+    NodeRowTable node_rows;
+
+    std::once_flag loaded;
+};
+
+template <typename T>
+ReportReader<T>::Population::Population(const HighFive::File& file,
+                                        const std::string& populationName,
+                                        size_t n_threads)
+    : pop_group_(file.getGroup(std::string("/report/") + populationName))
+    , population_name_(populationName)
+    , is_node_ids_sorted_(false)
+    , n_threads_(n_threads)
+    , node_mapping_(std::make_shared<NodeMapping>())
+    , layout_cache_(std::make_shared<LayoutCache>()) {
+    const auto mapping_group = pop_group_.getGroup("mapping");
+    if (mapping_group.getDataSet("node_ids").hasAttribute("sorted")) {
+        uint8_t sorted = 0;
+        mapping_group.getDataSet("node_ids").getAttribute("sorted").read(sorted);
+        is_node_ids_sorted_ = (sorted != 0);
+    }
+
+    {  // Get times
+        std::vector<double> times;
+        mapping_group.getDataSet("time").read(times);
+        tstart_ = times[0];
+        tstop_ = times[1];
+        tstep_ = times[2];
+        mapping_group.getDataSet("time").getAttribute("units").read(time_units_);
+        if (tstep_ <= 0) {
+            throw SonataError("The time step must be positive");
+        }
+        n_times_ = reportFrameCount(tstart_, tstop_, tstep_);
+    }
+
+    pop_group_.getDataSet("data").getAttribute("units").read(data_units_);
+
+    // Transposed data which doesn't match 'data', i.e. whose fingerprint of 'data' is outdated or
+    // of another shape, is ignored
+    if (pop_group_.exist("data_transposed")) {
+        const auto data = pop_group_.getDataSet("data");
+        const auto transposed = pop_group_.getDataSet("data_transposed");
+        const auto dims = data.getDimensions();
+        const auto transposed_dims = transposed.getDimensions();
+        has_transposed_data_ = dims.size() == 2 &&
+                               transposed_dims == std::vector<size_t>{dims[1], dims[0]} &&
+                               isDataFingerprint(data, transposed);
+    }
+
+    // Likewise for a summary pyramid, whose levels are used up to the first which doesn't match
+    if (pop_group_.exist("summary")) {
+        const auto data = pop_group_.getDataSet("data");
+        const auto dims = data.getDimensions();
+        const auto summary = pop_group_.getGroup("summary");
+        const bool current = dims.size() == 2 && isDataFingerprint(data, summary);
+        for (size_t level = 1; current && summary.exist(summaryLevelName(level)); ++level) {
+            const auto group = summary.getGroup(summaryLevelName(level));
+            const size_t window = size_t(1) << level;
+            uint64_t attribute_window = 0;
+            if (group.hasAttribute("window")) {
+                group.getAttribute("window").read(attribute_window);
+            }
+            const std::vector<size_t> level_dims{(dims[0] + window - 1) / window, dims[1]};
+            bool valid = attribute_window == window;
+            for (const char* name : {"min", "max", "mean"}) {
+                valid = valid && group.exist(name) &&
+                        group.getDataSet(name).getDimensions() == level_dims;
+            }
+            if (!valid) {
+                break;
+            }
+            summary_windows_.push_back(window);
+        }
+    }
+}
+
+template <typename T>
+auto ReportReader<T>::Population::getNodeMapping() const -> const NodeMapping& {
+    std::call_once(node_mapping_->loaded, [this]() {
+        const auto mapping_group = pop_group_.getGroup("mapping");
+        std::vector<NodeID> node_ids;
+        mapping_group.getDataSet("node_ids").read(node_ids);
+
+        std::vector<uint64_t> index_pointers;
+        mapping_group.getDataSet("index_pointers").read(index_pointers);
+
+        if (index_pointers.size() != (node_ids.size() + 1)) {
+            throw SonataError("'index_pointers' dataset size must be 'node_ids' size plus one");
+        }
+
+        // Expand the pointers into tuples that define the range of each GID
+        std::vector<Selection::Range> node_ranges;
+        std::vector<uint64_t> node_offsets;
+        node_ranges.reserve(node_ids.size());
+        node_offsets.reserve(node_ids.size() + 1);
+        size_t element_ids_count = 0;
+        for (size_t i = 0; i < node_ids.size(); ++i) {
+            node_ranges.push_back({index_pointers[i], index_pointers[i + 1]});  // Range of GID
+            node_offsets.emplace_back(element_ids_count);                       // Offset in output
+            element_ids_count += (index_pointers[i + 1] - index_pointers[i]);
+        }
+        node_offsets.emplace_back(element_ids_count);
+
+        // Note: The idea is to sort the positions to access the values, allowing us to maintain
+        //       all vectors intact, while still being able to index the data
+        std::vector<uint64_t> node_index;
+        if (is_node_ids_sorted_) {
+            node_index.resize(node_ids.size());
+            std::iota(node_index.begin(), node_index.end(), uint64_t{0});
+        } else {
+            if (mapping_group.exist("node_index")) {
+                mapping_group.getDataSet("node_index").read(node_index);
+            }
+            // An index which doesn't match 'node_ids', e.g. outdated, is ignored
+            if (!isSortedNodeIndex(node_index, node_ids)) {
+                node_index = sortedNodeIndex(node_ids);
+            }
+        }
+
+        auto& mapping = *node_mapping_;
+        mapping.node_ids = std::move(node_ids);
+        mapping.node_ranges = std::move(node_ranges);
+        mapping.node_offsets = std::move(node_offsets);
+        mapping.node_index = std::move(node_index);
+        mapping.node_rows = NodeRowTable(mapping.node_ids, mapping.node_index);
+    });
+    return *node_mapping_;
+}
+
+template <typename T>
+double ReportReader<T>::Population::getTime(size_t index) const {
+    return tstart_ + static_cast<double>(index) * tstep_;
+}
+
+template <typename T>
+std::tuple<double, double, double> ReportReader<T>::Population::getTimes() const {
+    return std::tie(tstart_, tstop_, tstep_);
+}
+
+template <typename T>
+std::string ReportReader<T>::Population::getTimeUnits() const {
+    return time_units_;
+}
+
+template <typename T>
+std::string ReportReader<T>::Population::getDataUnits() const {
+    return data_units_;
+}
+
+template <typename T>
+bool ReportReader<T>::Population::getSorted() const {
+    return is_node_ids_sorted_;
+}
+
+template <typename T>
+bool ReportReader<T>::Population::hasTransposedData() const {
+    return has_transposed_data_;
+}
+
+template <typename T>
+std::vector<size_t> ReportReader<T>::Population::getSummaryWindows() const {
+    return summary_windows_;
+}
+
+template <typename T>
+std::vector<NodeID> ReportReader<T>::Population::getNodeIds() const {
+    HDF5_LOCK_GUARD
+    return getNodeMapping().node_ids;
+}
+
+template <typename T>
+auto ReportReader<T>::Population::getNodeIdElementLayout(
+    const nonstd::optional<Selection>& node_ids,
+    const nonstd::optional<size_t>& _block_gap_limit) const
+    -> std::shared_ptr<const NodeIdElementLayout> {
+    // Set the gap between IO blocks while fetching data (Default: 64MB / 4 x GPFS blocks)
+    const size_t block_gap_limit = _block_gap_limit.value_or(16777216);
+
+    if (block_gap_limit < 4194304) {
+        throw SonataError("block_gap_limit must be at least 4194304 (16MB / 1 x GPFS block)");
+    }
+
+    typename LayoutCache::Key key{!node_ids,
+                                  node_ids ? node_ids->ranges() : Selection::Ranges{},
+                                  block_gap_limit};
+    auto layout = layout_cache_->find(key);
+    if (!layout) {
+        layout = std::make_shared<NodeIdElementLayout>(
+            computeNodeIdElementLayout(node_ids, block_gap_limit));
+        layout_cache_->insert(std::move(key), layout);
+    }
+
+    return layout;
+}
+
+template <typename T>
+auto ReportReader<T>::Population::computeNodeIdElementLayout(
+    const nonstd::optional<Selection>& node_ids, size_t block_gap_limit) const
+    -> NodeIdElementLayout {
+    NodeIdElementLayout result;
+    std::vector<NodeID> concrete_node_ids;
+    size_t element_ids_count = 0;
+    const auto& mapping = getNodeMapping();
+
+    // Take all nodes if no selection is provided
+    if (!node_ids) {
+        concrete_node_ids = mapping.node_ids;
+        result.node_ranges = mapping.node_ranges;
+        result.node_offsets = mapping.node_offsets;
+        result.node_index = mapping.node_index;
+        element_ids_count = mapping.node_offsets.back();
+    } else if (!node_ids->empty()) {
+        const auto selected_node_ids = node_ids->flatten();
+
+        for (const auto node_id : selected_node_ids) {
+            const auto row = mapping.node_rows.find(node_id);
+
+            if (row != NodeRowTable::NOT_FOUND) {
+                const auto& range = mapping.node_ranges[row];
+
+                concrete_node_ids.emplace_back(node_id);
+                result.node_ranges.emplace_back(range);
+                result.node_offsets.emplace_back(element_ids_count);
+                result.node_index.emplace_back(result.node_index.size());
+
+                element_ids_count += (std::get<1>(range) - std::get<0>(range));
+            }
+        }
+    } else {
+        // node_ids Selection exists, but is empty
+    }
+
+    // Extract the ElementIDs from the GIDs
+    if (!concrete_node_ids.empty()) {
+        // Sort the index by the selected ranges, in linear time
+        std::vector<uint64_t> range_starts(result.node_index.size());
+        std::transform(result.node_index.begin(),
+                       result.node_index.end(),
+                       range_starts.begin(),
+                       [&](const uint64_t i) { return std::get<0>(result.node_ranges[i]); });
+        radix_sort::sortByKey(range_starts, result.node_index, n_threads_);
+
+        // Generate the {min,max} IO blocks for the requests
+        computeMinMaxBlocks(result, block_gap_limit);
+
+        // Fill the GID-ElementID mapping in blocks to reduce the file system overhead
+        std::vector<ElementID> element_ids;
+        auto dataset_elem_ids = pop_group_.getGroup("mapping").getDataSet("element_ids");
+
+        result.ids.resize(element_ids_count);
 
         for (const auto& min_max_block : result.min_max_blocks) {
             const auto first_index = result.node_index[std::get<0>(min_max_block)];
@@ -461,58 +2187,699 @@ ReportReader<T>::Population::getNodeIdElementLayout(
         dataset_elem_ids.select({std::get<0>(result.node_ranges[index])}, {1}).read(element_ids);
     }
 
-    return result;
+    return result;
+}
+
+template <typename T>
+std::pair<size_t, size_t> ReportReader<T>::Population::getIndex(
+    const nonstd::optional<double>& tstart, const nonstd::optional<double>& tstop) const {
+    std::pair<size_t, size_t> indexes;
+
+    const double start = tstart.value_or(tstart_);
+    const double stop = tstop.value_or(tstop_);
+
+    if (start < 0 - EPSILON || stop < 0 - EPSILON) {
+        throw SonataError("Times cannot be negative");
+    }
+
+    // The first timestep with start < time + EPSILON, and the last with stop > time - EPSILON
+    const double first = std::floor((start - EPSILON - tstart_) / tstep_) + 1;
+    if (n_times_ == 0 || first >= static_cast<double>(n_times_)) {
+        throw SonataError("tstart is after the end of the range");
+    }
+    indexes.first = first > 0 ? static_cast<size_t>(first) : 0;
+
+    const double last = std::ceil((stop + EPSILON - tstart_) / tstep_) - 1;
+    if (last < 0) {
+        throw SonataError("tstop is before the beginning of the range");
+    }
+    indexes.second = last < static_cast<double>(n_times_ - 1) ? static_cast<size_t>(last)
+                                                               : n_times_ - 1;
+
+    if (indexes.first > indexes.second) {
+        throw SonataError("tstart should be <= to tstop");
+    }
+
+    return indexes;
+}
+
+
+template <typename T>
+auto ReportReader<T>::Population::computeCompartmentSetLayout(
+    const CompartmentSet& compartment_set, const nonstd::optional<size_t>& block_gap_limit) const
+    -> NodeIdElementLayout {
+    if (compartment_set.population() != population_name_) {
+        throw SonataError(
+            fmt::format("The compartment set is of population '{}', not of '{}'",
+                        compartment_set.population(),
+                        population_name_));
+    }
+
+    NodeIdElementLayout result;
+    const auto nodes = getNodeIdElementLayout(compartment_set.nodeIds(), block_gap_limit);
+
+    // Position in `nodes` of each node with elements, by node id
+    std::vector<std::pair<NodeID, size_t>> node_positions;
+    for (size_t i = 0; i < nodes->node_ranges.size(); ++i) {
+        if (std::get<1>(nodes->node_ranges[i]) > std::get<0>(nodes->node_ranges[i])) {
+            node_positions.emplace_back(keyNodeID(nodes->ids[nodes->node_offsets[i]]), i);
+        }
+    }
+    std::sort(node_positions.begin(), node_positions.end());
+
+    // The columns of the current node, by section then position
+    std::vector<std::pair<uint64_t, size_t>> columns;
+    size_t node = std::numeric_limits<size_t>::max();
+    for (size_t i = 0; i < compartment_set.size(); ++i) {
+        const auto location = compartment_set[i];
+        const auto it = std::lower_bound(node_positions.begin(),
+                                         node_positions.end(),
+                                         std::make_pair(location.nodeId, size_t(0)));
+        if (it == node_positions.end() || it->first != location.nodeId) {
+            throw SonataError(fmt::format("Node {} of the compartment set is not in the report",
+                                          location.nodeId));
+        }
+
+        const auto begin = std::get<0>(nodes->node_ranges[it->second]);
+        const auto end = std::get<1>(nodes->node_ranges[it->second]);
+        const auto offset = nodes->node_offsets[it->second];
+        if (it->second != node) {
+            node = it->second;
+            columns.clear();
+            for (size_t column = 0; column < end - begin; ++column) {
+                columns.emplace_back(keyElementID(nodes->ids[offset + column]), column);
+            }
+            std::sort(columns.begin(), columns.end());
+        }
+
+        // The n compartments of a section split it evenly, in the order of their columns
+        const auto section = std::equal_range(
+            columns.begin(),
+            columns.end(),
+            std::make_pair(location.sectionId, size_t(0)),
+            [](const std::pair<uint64_t, size_t>& lhs, const std::pair<uint64_t, size_t>& rhs) {
+                return lhs.first < rhs.first;
+            });
+        const auto n_compartments = static_cast<size_t>(section.second - section.first);
+        if (n_compartments == 0) {
+            throw SonataError(fmt::format("Section {} of node {} is not in the report",
+                                          location.sectionId,
+                                          location.nodeId));
+        }
+        const auto compartment = std::min(
+            n_compartments - 1,
+            static_cast<size_t>(std::max(0.0, location.offset) * n_compartments));
+        const auto column = (section.first + compartment)->second;
+
+        // Consecutive columns of consecutive compartments are kept as a single range
+        const auto position = begin + column;
+        if (!result.node_ranges.empty() && std::get<1>(result.node_ranges.back()) == position &&
+            result.node_offsets.back() + position - std::get<0>(result.node_ranges.back()) ==
+                result.ids.size()) {
+            std::get<1>(result.node_ranges.back()) = position + 1;
+        } else {
+            result.node_ranges.push_back({position, position + 1});
+            result.node_offsets.push_back(result.ids.size());
+            result.node_index.push_back(result.node_index.size());
+        }
+        result.ids.push_back(nodes->ids[offset + column]);
+    }
+
+    if (!result.ids.empty()) {
+        std::stable_sort(result.node_index.begin(),
+                         result.node_index.end(),
+                         [&](const size_t i, const size_t j) {
+                             return std::get<0>(result.node_ranges[i]) <
+                                    std::get<0>(result.node_ranges[j]);
+                         });
+        computeMinMaxBlocks(result, block_gap_limit.value_or(16777216));
+    }
+
+    return result;
+}
+
+template <typename T>
+typename DataFrame<T>::DataType ReportReader<T>::Population::getNodeIdElementIdMapping(
+    const nonstd::optional<Selection>& node_ids,
+    const nonstd::optional<size_t>& block_gap_limit) const {
+    HDF5_LOCK_GUARD
+    typename DataFrame<T>::DataType ids;
+    assignLayoutIds(getNodeIdElementLayout(node_ids, block_gap_limit), ids);
+    return ids;
+}
+
+template <typename T>
+void ReportReader<T>::Population::readFrames(const NodeIdElementLayout& layout,
+                                             size_t index_start,
+                                             size_t index_stop,
+                                             size_t stride,
+                                             size_t max_read_size,
+                                             float* out,
+                                             ReportReadBuffer& buffer) const {
+    const size_t n_time_entries = ((index_stop - index_start) / stride) + 1;
+    const size_t element_ids_count = layout.ids.size();
+
+    if (has_transposed_data_ && preferTransposedData(layout, index_start, index_stop, stride)) {
+        readFramesTransposed(layout, index_start, index_stop, stride, max_read_size, out, buffer);
+        return;
+    }
+
+    auto dataset = pop_group_.getDataSet("data");
+    const auto encoding = readDataEncoding(dataset);
+    const size_t value_size = dataset.getDataType().getSize();
+    if (n_threads_ > 1) {
+        const auto dims = dataset.getDimensions();
+        const auto location =
+            parallel_read::getRawLocation(dataset, encodedMemoryType(dataset, encoding));
+        if (location && dims.size() == 2 && dims[0] > index_stop) {
+            readFramesParallel(layout,
+                               index_start,
+                               index_stop,
+                               stride,
+                               max_read_size,
+                               location->filename,
+                               location->offset,
+                               dims[1],
+                               out);
+            return;
+        }
+    }
+
+    const auto chunk_rows = io_planner::getStorageLayout(dataset).filteredChunkSize(0);
+
+    for (const auto& min_max_block : layout.min_max_blocks) {
+        const auto bounds = blockBounds(layout, min_max_block);
+        const auto min = std::get<0>(bounds);
+        const size_t block_size = std::get<1>(bounds) - min;
+        if (block_size == 0) {
+            continue;
+        }
+        const bool into_frames = isFramesBlock(layout, min_max_block);
+
+        // Access the data in 2D tiles (timesteps x block) to reduce the file system overhead
+        const size_t frames_per_read =
+            std::max<size_t>(1, max_read_size / (block_size * value_size));
+
+        size_t n_frames = 0;
+        for (size_t frame = 0; frame < n_time_entries; frame += n_frames) {
+            const size_t row = index_start + frame * stride;
+            n_frames = std::min(frames_per_read, n_time_entries - frame);
+            // End the tile on the last boundary of the filtered chunks it spans, if any, so that
+            // the next tile doesn't decompress the same chunks again
+            const size_t row_end = ((row + n_frames * stride) / chunk_rows) * chunk_rows;
+            if (chunk_rows > 1 && row_end > row) {
+                n_frames = std::min((row_end - row + stride - 1) / stride, n_frames);
+            }
+
+            const auto selection = dataset.select({row, min}, {n_frames, block_size}, {stride, 1});
+            if (into_frames) {
+                readDecodedValues(selection,
+                                  dataset,
+                                  encoding,
+                                  n_frames * block_size,
+                                  out + frame * element_ids_count,
+                                  buffer.encoded);
+                continue;
+            }
+            if (encoding.type != ReportEncoding::float32) {
+                buffer.encoded.resize(n_frames * block_size);
+                selection.read_raw(buffer.encoded.data(), encodedMemoryType(dataset, encoding));
+                decodeBlockFrames(layout,
+                                  min_max_block,
+                                  encoding,
+                                  buffer.encoded.data(),
+                                  n_frames,
+                                  out + frame * element_ids_count);
+                continue;
+            }
+            buffer.values.resize(n_frames * block_size);
+            selection.read_raw(buffer.values.data());
+
+            // Copy the values for each of the GIDs assigned into this block, frame by frame
+            copyBlockFrames(layout,
+                            min_max_block,
+                            buffer.values.data(),
+                            n_frames,
+                            out + frame * element_ids_count);
+        }
+    }
+}
+
+template <typename T>
+void ReportReader<T>::Population::readFramesParallel(const NodeIdElementLayout& layout,
+                                                     size_t index_start,
+                                                     size_t index_stop,
+                                                     size_t stride,
+                                                     size_t max_read_size,
+                                                     const std::string& filename,
+                                                     uint64_t offset,
+                                                     size_t n_cols,
+                                                     float* out) const {
+    struct Tile {
+        size_t block;
+        size_t frame;
+        size_t n_frames;
+    };
+
+    const size_t n_time_entries = ((index_stop - index_start) / stride) + 1;
+    const size_t element_ids_count = layout.ids.size();
+    const auto encoding = readDataEncoding(pop_group_.getDataSet("data"));
+    const size_t value_size =
+        encoding.type == ReportEncoding::float32 ? sizeof(float) : sizeof(int16_t);
+
+    // Split every {min,max} block into tiles of timesteps, with at least one tile per thread
+    std::vector<Tile> tiles;
+    std::vector<bool> into_frames(layout.min_max_blocks.size(), false);
+    const size_t frames_per_thread = (n_time_entries + n_threads_ - 1) / n_threads_;
+    for (size_t block = 0; block < layout.min_max_blocks.size(); ++block) {
+        const auto bounds = blockBounds(layout, layout.min_max_blocks[block]);
+        const size_t block_size = std::get<1>(bounds) - std::get<0>(bounds);
+        if (block_size == 0) {
+            continue;
+        }
+        into_frames[block] = isFramesBlock(layout, layout.min_max_blocks[block]);
+
+        const size_t frames_per_read = std::min(
+            frames_per_thread, std::max<size_t>(1, max_read_size / (block_size * value_size)));
+        for (size_t frame = 0; frame < n_time_entries; frame += frames_per_read) {
+            tiles.push_back({block, frame, std::min(frames_per_read, n_time_entries - frame)});
+        }
+    }
+
+    // The tiles fill disjoint parts of `out`, and are read without going through HDF5
+    const parallel_read::RawFile file(filename);
+    parallel_read::parallelFor(tiles.size(), n_threads_, [&](size_t i) {
+        const auto& tile = tiles[i];
+        const auto& min_max_block = layout.min_max_blocks[tile.block];
+        const auto bounds = blockBounds(layout, min_max_block);
+        const auto min = std::get<0>(bounds);
+        const size_t block_size = std::get<1>(bounds) - min;
+        const size_t row = index_start + tile.frame * stride;
+
+        // The float32 tiles of blocks with the columns of `out` are read straight into it,
+        // the others are decoded or copied to it
+        std::vector<float> buffer;
+        std::vector<int16_t> encoded;
+        float* const frames_out = out + tile.frame * element_ids_count;
+        char* tile_in = reinterpret_cast<char*>(frames_out);
+        if (encoding.type != ReportEncoding::float32) {
+            encoded.resize(tile.n_frames * block_size);
+            tile_in = reinterpret_cast<char*>(encoded.data());
+        } else if (!into_frames[tile.block]) {
+            buffer.resize(tile.n_frames * block_size);
+            tile_in = reinterpret_cast<char*>(buffer.data());
+        }
+        if (stride == 1 && block_size == n_cols) {
+            // Whole consecutive rows: a single read
+            file.read(tile_in,
+                      tile.n_frames * block_size * value_size,
+                      offset + row * n_cols * value_size);
+        } else {
+            for (size_t f = 0; f < tile.n_frames; ++f) {
+                file.read(tile_in + f * block_size * value_size,
+                          block_size * value_size,
+                          offset + ((row + f * stride) * n_cols + min) * value_size);
+            }
+        }
+
+        if (encoding.type != ReportEncoding::float32) {
+            if (into_frames[tile.block]) {
+                decodeValues(encoding, encoded.data(), encoded.size(), frames_out);
+            } else {
+                decodeBlockFrames(
+                    layout, min_max_block, encoding, encoded.data(), tile.n_frames, frames_out);
+            }
+        } else if (!into_frames[tile.block]) {
+            copyBlockFrames(layout, min_max_block, buffer.data(), tile.n_frames, frames_out);
+        }
+    });
+}
+
+template <typename T>
+void ReportReader<T>::Population::readFramesTransposed(const NodeIdElementLayout& layout,
+                                                       size_t index_start,
+                                                       size_t index_stop,
+                                                       size_t stride,
+                                                       size_t max_read_size,
+                                                       float* out,
+                                                       ReportReadBuffer& buffer) const {
+    const size_t n_time_entries = ((index_stop - index_start) / stride) + 1;
+    const size_t element_ids_count = layout.ids.size();
+    auto dataset = pop_group_.getDataSet("data_transposed");
+
+    for (size_t first = 0; first < layout.node_index.size();) {
+        // The nodes whose elements follow each other are read together
+        size_t last = first + 1;
+        while (last < layout.node_index.size() &&
+               std::get<0>(layout.node_ranges[layout.node_index[last]]) ==
+                   std::get<1>(layout.node_ranges[layout.node_index[last - 1]])) {
+            ++last;
+        }
+        const auto min = std::get<0>(layout.node_ranges[layout.node_index[first]]);
+        const size_t n_elements = std::get<1>(layout.node_ranges[layout.node_index[last - 1]]) -
+                                  min;
+        if (n_elements == 0) {
+            first = last;
+            continue;
+        }
+
+        const size_t frames_per_read =
+            std::max<size_t>(1, max_read_size / (n_elements * sizeof(float)));
+        for (size_t frame = 0; frame < n_time_entries; frame += frames_per_read) {
+            const size_t n_frames = std::min(frames_per_read, n_time_entries - frame);
+            const size_t column = index_start + frame * stride;
+
+            buffer.values.resize(n_elements * n_frames);
+            dataset.select({min, column}, {n_elements, n_frames}, {1, stride})
+                .read_raw(buffer.values.data());
+
+            // Transpose back to data[times][ids]
+            for (size_t i = first; i < last; ++i) {
+                const auto index = layout.node_index[i];
+                const auto begin = std::get<0>(layout.node_ranges[index]) - min;
+                const auto end = std::get<1>(layout.node_ranges[index]) - min;
+                for (size_t e = begin; e < end; ++e) {
+                    const float* const element = buffer.values.data() + e * n_frames;
+                    float* const data_start =
+                        out + frame * element_ids_count + layout.node_offsets[index] + e - begin;
+                    for (size_t f = 0; f < n_frames; ++f) {
+                        data_start[f * element_ids_count] = element[f];
+                    }
+                }
+            }
+        }
+        first = last;
+    }
+}
+
+template <typename T>
+bool ReportReader<T>::Population::preferTransposedData(const NodeIdElementLayout& layout,
+                                                       size_t index_start,
+                                                       size_t index_stop,
+                                                       size_t stride) const {
+    const size_t n_time_entries = ((index_stop - index_start) / stride) + 1;
+
+    // 'data' is read by {min,max} blocks of elements, as many timesteps as `stride` allows
+    Selection::Ranges blocks;
+    for (const auto& min_max_block : layout.min_max_blocks) {
+        blocks.push_back(blockBounds(layout, min_max_block));
+    }
+    double data_cost = 0;
+    const auto data = pop_group_.getDataSet("data");
+    const auto data_layout = io_planner::getStorageLayout(data);
+    // Values stored as float16 or int16 take half the bytes
+    const size_t value_size = data.getDataType().getSize();
+    if (data_layout.chunked) {
+        const size_t chunk_rows = data_layout.chunkSize(0);
+        const size_t chunk_cols = data_layout.chunkSize(1);
+        const size_t row_chunks =
+            std::min(n_time_entries, index_stop / chunk_rows - index_start / chunk_rows + 1);
+        data_cost = static_cast<double>(row_chunks * countChunks(blocks, chunk_cols)) *
+                    (REPORT_READ_OPERATION_COST + chunk_rows * chunk_cols * value_size);
+    } else {
+        for (const auto& block : blocks) {
+            data_cost += static_cast<double>(n_time_entries) *
+                         (REPORT_READ_OPERATION_COST +
+                          (std::get<1>(block) - std::get<0>(block)) * value_size);
+        }
+    }
+
+    // 'data_transposed' is read by runs of consecutive elements, all the timesteps in between
+    Selection::Ranges elements;
+    for (const auto index : layout.node_index) {
+        elements.push_back(layout.node_ranges[index]);
+    }
+    const size_t n_columns = index_stop - index_start + 1;
+    double transposed_cost = 0;
+    const auto transposed_layout =
+        io_planner::getStorageLayout(pop_group_.getDataSet("data_transposed"));
+    if (transposed_layout.chunked) {
+        const size_t chunk_rows = transposed_layout.chunkSize(0);
+        const size_t chunk_cols = transposed_layout.chunkSize(1);
+        const size_t column_chunks = index_stop / chunk_cols - index_start / chunk_cols + 1;
+        transposed_cost =
+            static_cast<double>(countChunks(elements, chunk_rows) * column_chunks) *
+            (REPORT_READ_OPERATION_COST + chunk_rows * chunk_cols * sizeof(float));
+    } else {
+        transposed_cost = static_cast<double>(layout.ids.size()) *
+                          (REPORT_READ_OPERATION_COST + n_columns * sizeof(float));
+    }
+
+    return transposed_cost < data_cost;
+}
+
+template <typename T>
+void ReportReader<T>::Population::readDataFrame(const NodeIdElementLayout& layout,
+                                                size_t index_start,
+                                                size_t index_stop,
+                                                size_t stride,
+                                                size_t max_read_size,
+                                                DataFrame<T>& data_frame,
+                                                ReportReadBuffer& buffer) const {
+    checkReportDataType(pop_group_.getDataSet("data"));
+
+    // Fill times
+    data_frame.times.clear();
+    for (size_t i = index_start; i <= index_stop; i += stride) {
+        data_frame.times.emplace_back(getTime(i));
+    }
+
+    // Fill .data member
+    const size_t n_time_entries = data_frame.times.size();
+    const size_t element_ids_count = layout.ids.size();
+    data_frame.data.resize(n_time_entries * element_ids_count);
+
+    readFrames(layout,
+               index_start,
+               index_stop,
+               stride,
+               max_read_size,
+               data_frame.data.data(),
+               buffer);
+}
+
+template <typename T>
+DataFrame<T> ReportReader<T>::Population::get(
+    const nonstd::optional<Selection>& node_ids,
+    const nonstd::optional<double>& tstart,
+    const nonstd::optional<double>& tstop,
+    const nonstd::optional<size_t>& tstride,
+    const nonstd::optional<size_t>& block_gap_limit,
+    const nonstd::optional<size_t>& max_read_size) const {
+    DataFrame<T> data_frame;
+    ReportReadBuffer buffer;
+    getInto(data_frame, buffer, node_ids, tstart, tstop, tstride, block_gap_limit, max_read_size);
+    return data_frame;
+}
+
+template <typename T>
+void ReportReader<T>::Population::getInto(DataFrame<T>& data_frame,
+                                          ReportReadBuffer& buffer,
+                                          const nonstd::optional<Selection>& node_ids,
+                                          const nonstd::optional<double>& tstart,
+                                          const nonstd::optional<double>& tstop,
+                                          const nonstd::optional<size_t>& tstride,
+                                          const nonstd::optional<size_t>& block_gap_limit,
+                                          const nonstd::optional<size_t>& max_read_size) const {
+    HDF5_LOCK_GUARD
+    size_t index_start = 0;
+    size_t index_stop = 0;
+    std::tie(index_start, index_stop) = getIndex(tstart, tstop);
+    const size_t stride = tstride.value_or(1);
+    if (stride == 0) {
+        throw SonataError("tstride should be > 0");
+    }
+
+    // Retrieve the GID-ElementID layout, alongside the {min,max} blocks
+    const auto node_id_element_layout = getNodeIdElementLayout(node_ids, block_gap_limit);
+
+    if (node_id_element_layout->ids.empty()) {  // At the end no data available (wrong node_ids?)
+        data_frame.ids.clear();
+        data_frame.times.clear();
+        data_frame.data.clear();
+        return;
+    }
+
+    readDataFrame(*node_id_element_layout,
+                  index_start,
+                  index_stop,
+                  stride,
+                  max_read_size.value_or(DEFAULT_MAX_READ_SIZE),
+                  data_frame,
+                  buffer);
+
+    // Fill ids, without copying them when possible
+    assignLayoutIds(node_id_element_layout, data_frame.ids);
 }
 
 template <typename T>
-std::pair<size_t, size_t> ReportReader<T>::Population::getIndex(
-    const nonstd::optional<double>& tstart, const nonstd::optional<double>& tstop) const {
-    std::pair<size_t, size_t> indexes;
+size_t ReportReader<T>::Population::getInto(float* data,
+                                            size_t n_frames,
+                                            size_t n_ids,
+                                            ReportReadBuffer& buffer,
+                                            const nonstd::optional<Selection>& node_ids,
+                                            const nonstd::optional<double>& tstart,
+                                            const nonstd::optional<double>& tstop,
+                                            const nonstd::optional<size_t>& tstride,
+                                            const nonstd::optional<size_t>& block_gap_limit,
+                                            const nonstd::optional<size_t>& max_read_size) const {
+    HDF5_LOCK_GUARD
+    size_t index_start = 0;
+    size_t index_stop = 0;
+    std::tie(index_start, index_stop) = getIndex(tstart, tstop);
+    const size_t stride = tstride.value_or(1);
+    if (stride == 0) {
+        throw SonataError("tstride should be > 0");
+    }
 
-    const double start = tstart.value_or(tstart_);
-    const double stop = tstop.value_or(tstop_);
+    const auto layout = getNodeIdElementLayout(node_ids, block_gap_limit);
+    if (n_ids != layout->ids.size()) {
+        throw SonataError(
+            fmt::format("The selection has {} ids, not {}", layout->ids.size(), n_ids));
+    }
+    if (layout->ids.empty()) {
+        return 0;
+    }
 
-    if (start < 0 - EPSILON || stop < 0 - EPSILON) {
-        throw SonataError("Times cannot be negative");
+    const size_t n_time_entries = (index_stop - index_start) / stride + 1;
+    if (n_frames < n_time_entries) {
+        throw SonataError(
+            fmt::format("{} timesteps are read, with room for {}", n_time_entries, n_frames));
     }
+    checkReportDataType(pop_group_.getDataSet("data"));
+
+    readFrames(*layout,
+               index_start,
+               index_stop,
+               stride,
+               max_read_size.value_or(DEFAULT_MAX_READ_SIZE),
+               data,
+               buffer);
+    return n_time_entries;
+}
 
-    const auto it_start = std::find_if(times_index_.cbegin(),
-                                       times_index_.cend(),
-                                       [&](const std::pair<size_t, double>& v) {
-                                           return start < v.second + EPSILON;
-                                       });
-    if (it_start == times_index_.end()) {
-        throw SonataError("tstart is after the end of the range");
+template <typename T>
+DataFrame<T> ReportReader<T>::Population::getCompartmentSet(
+    const CompartmentSet& compartment_set,
+    const nonstd::optional<double>& tstart,
+    const nonstd::optional<double>& tstop,
+    const nonstd::optional<size_t>& tstride,
+    const nonstd::optional<size_t>& block_gap_limit,
+    const nonstd::optional<size_t>& max_read_size) const {
+    HDF5_LOCK_GUARD
+    size_t index_start = 0;
+    size_t index_stop = 0;
+    std::tie(index_start, index_stop) = getIndex(tstart, tstop);
+    const size_t stride = tstride.value_or(1);
+    if (stride == 0) {
+        throw SonataError("tstride should be > 0");
     }
-    indexes.first = it_start->first;
 
-    const auto it_stop =
-        std::find_if(times_index_.crbegin(),
-                     times_index_.crend(),
-                     [&](const std::pair<size_t, double>& v) { return stop > v.second - EPSILON; });
-    if (it_stop == times_index_.rend()) {
-        throw SonataError("tstop is before the beginning of the range");
+    auto layout = computeCompartmentSetLayout(compartment_set, block_gap_limit);
+
+    DataFrame<T> data_frame;
+    if (layout.ids.empty()) {
+        return data_frame;
     }
-    indexes.second = it_stop->first;
 
-    return indexes;
+    ReportReadBuffer buffer;
+    readDataFrame(layout,
+                  index_start,
+                  index_stop,
+                  stride,
+                  max_read_size.value_or(DEFAULT_MAX_READ_SIZE),
+                  data_frame,
+                  buffer);
+    data_frame.ids = std::move(layout.ids);
+    return data_frame;
 }
 
-
 template <typename T>
-typename DataFrame<T>::DataType ReportReader<T>::Population::getNodeIdElementIdMapping(
+DataFrame<NodeID> ReportReader<T>::Population::getReducedByNode(
     const nonstd::optional<Selection>& node_ids,
+    const nonstd::optional<double>& tstart,
+    const nonstd::optional<double>& tstop,
+    ReportReduction reduction,
+    const nonstd::optional<size_t>& tstride,
     const nonstd::optional<size_t>& block_gap_limit) const {
-    return getNodeIdElementLayout(node_ids, block_gap_limit).ids;
+    HDF5_LOCK_GUARD
+    size_t index_start = 0;
+    size_t index_stop = 0;
+    std::tie(index_start, index_stop) = getIndex(tstart, tstop);
+    const size_t stride = tstride.value_or(1);
+    if (stride == 0) {
+        throw SonataError("tstride should be > 0");
+    }
+
+    const auto layout = getNodeIdElementLayout(node_ids, block_gap_limit);
+    DataFrame<NodeID> data_frame;
+    if (layout->ids.empty()) {
+        return data_frame;
+    }
+    checkReportDataType(pop_group_.getDataSet("data"));
+
+    // The {offset, count} of the columns of each node with elements
+    std::vector<std::pair<size_t, size_t>> columns;
+    for (size_t i = 0; i < layout->node_ranges.size(); ++i) {
+        const size_t count = std::get<1>(layout->node_ranges[i]) -
+                             std::get<0>(layout->node_ranges[i]);
+        if (count > 0) {
+            columns.emplace_back(layout->node_offsets[i], count);
+            data_frame.ids.push_back(keyNodeID(layout->ids[layout->node_offsets[i]]));
+        }
+    }
+
+    for (size_t i = index_start; i <= index_stop; i += stride) {
+        data_frame.times.emplace_back(getTime(i));
+    }
+    const size_t n_time_entries = data_frame.times.size();
+    const size_t n_cols = layout->ids.size();
+    const size_t n_nodes = columns.size();
+    data_frame.data.resize(n_time_entries * n_nodes);
+
+    const size_t frames_per_read =
+        std::max<size_t>(1, REPORT_REDUCTION_READ_SIZE / (n_cols * sizeof(float)));
+    std::vector<float> frames;
+    ReportReadBuffer buffer;
+    for (size_t frame = 0; frame < n_time_entries; frame += frames_per_read) {
+        const size_t n_frames = std::min(frames_per_read, n_time_entries - frame);
+        frames.resize(n_frames * n_cols);
+        readFrames(*layout,
+                   index_start + frame * stride,
+                   index_start + (frame + n_frames - 1) * stride,
+                   stride,
+                   REPORT_REDUCTION_READ_SIZE,
+                   frames.data(),
+                   buffer);
+
+        parallel_read::parallelFor(n_frames, n_threads_, [&](size_t f) {
+            const float* const row = frames.data() + f * n_cols;
+            float* const out = data_frame.data.data() + (frame + f) * n_nodes;
+            for (size_t i = 0; i < n_nodes; ++i) {
+                out[i] = reduceValues(row + columns[i].first, columns[i].second, reduction);
+                if (reduction == ReportReduction::mean) {
+                    out[i] /= static_cast<float>(columns[i].second);
+                }
+            }
+        });
+    }
+
+    return data_frame;
 }
 
 template <typename T>
-DataFrame<T> ReportReader<T>::Population::get(
+DataFrame<T> ReportReader<T>::Population::getReducedByWindow(
+    size_t window,
     const nonstd::optional<Selection>& node_ids,
     const nonstd::optional<double>& tstart,
     const nonstd::optional<double>& tstop,
+    ReportReduction reduction,
     const nonstd::optional<size_t>& tstride,
     const nonstd::optional<size_t>& block_gap_limit) const {
+    HDF5_LOCK_GUARD
+    if (window == 0) {
+        throw SonataError("window should be > 0");
+    }
     size_t index_start = 0;
     size_t index_stop = 0;
     std::tie(index_start, index_stop) = getIndex(tstart, tstop);
@@ -520,83 +2887,814 @@ DataFrame<T> ReportReader<T>::Population::get(
     if (stride == 0) {
         throw SonataError("tstride should be > 0");
     }
-    if (index_start > index_stop) {
-        throw SonataError("tstart should be <= to tstop");
+
+    const auto layout = getNodeIdElementLayout(node_ids, block_gap_limit);
+    DataFrame<T> data_frame;
+    if (layout->ids.empty()) {
+        return data_frame;
     }
+    checkReportDataType(pop_group_.getDataSet("data"));
 
-    // Retrieve the GID-ElementID layout, alongside the {min,max} blocks
-    auto node_id_element_layout = getNodeIdElementLayout(node_ids, block_gap_limit);
-    const auto& node_ranges = node_id_element_layout.node_ranges;
-    const auto& node_offsets = node_id_element_layout.node_offsets;
-    const auto& node_index = node_id_element_layout.node_index;
-    const auto& min_max_blocks = node_id_element_layout.min_max_blocks;
+    const size_t n_time_entries = (index_stop - index_start) / stride + 1;
+    const size_t n_windows = (n_time_entries + window - 1) / window;
+    for (size_t w = 0; w < n_windows; ++w) {
+        data_frame.times.emplace_back(getTime(index_start + w * window * stride));
+    }
+    const size_t n_cols = layout->ids.size();
+    data_frame.data.resize(n_windows * n_cols);
+
+    // Each task reduces a slice of the columns, for all the windows
+    const size_t n_slices = std::max<size_t>(1, std::min(n_threads_, n_cols));
+    const size_t slice_size = (n_cols + n_slices - 1) / n_slices;
+
+    const size_t frames_per_read =
+        std::max<size_t>(1, REPORT_REDUCTION_READ_SIZE / (n_cols * sizeof(float)));
+    std::vector<float> frames;
+    ReportReadBuffer buffer;
+    for (size_t frame = 0; frame < n_time_entries; frame += frames_per_read) {
+        const size_t n_frames = std::min(frames_per_read, n_time_entries - frame);
+        frames.resize(n_frames * n_cols);
+        readFrames(*layout,
+                   index_start + frame * stride,
+                   index_start + (frame + n_frames - 1) * stride,
+                   stride,
+                   REPORT_REDUCTION_READ_SIZE,
+                   frames.data(),
+                   buffer);
+
+        parallel_read::parallelFor(n_slices, n_threads_, [&](size_t slice) {
+            const size_t begin = std::min(n_cols, slice * slice_size);
+            const size_t count = std::min(n_cols, begin + slice_size) - begin;
+            for (size_t f = 0; f < n_frames; ++f) {
+                const float* const row = frames.data() + f * n_cols + begin;
+                float* const out = data_frame.data.data() + ((frame + f) / window) * n_cols +
+                                   begin;
+                if ((frame + f) % window == 0) {
+                    std::copy(row, row + count, out);
+                } else {
+                    accumulateValues(out, row, count, reduction);
+                }
+            }
+        });
+    }
 
-    if (node_id_element_layout.ids.empty()) {  // At the end no data available (wrong node_ids?)
-        return DataFrame<T>{{}, {}, {}};
+    if (reduction == ReportReduction::mean) {
+        for (size_t w = 0; w < n_windows; ++w) {
+            const auto size = static_cast<float>(std::min(window, n_time_entries - w * window));
+            float* const out = data_frame.data.data() + w * n_cols;
+            for (size_t i = 0; i < n_cols; ++i) {
+                out[i] /= size;
+            }
+        }
     }
 
-    // Fill times
-    DataFrame<T> data_frame;
-    for (size_t i = index_start; i <= index_stop; i += stride) {
-        data_frame.times.emplace_back(times_index_[i].second);
+    data_frame.ids = layout->ids;
+    return data_frame;
+}
+
+template <typename T>
+ReportSummary<T> ReportReader<T>::Population::getSummary(
+    double resolution,
+    const nonstd::optional<Selection>& node_ids,
+    const nonstd::optional<double>& tstart,
+    const nonstd::optional<double>& tstop,
+    const nonstd::optional<size_t>& block_gap_limit) const {
+    HDF5_LOCK_GUARD
+    size_t index_start = 0;
+    size_t index_stop = 0;
+    std::tie(index_start, index_stop) = getIndex(tstart, tstop);
+
+    // The coarsest level whose windows last at most `resolution`, 0 for the timesteps
+    size_t level = 0;
+    while (level < summary_windows_.size() &&
+           static_cast<double>(summary_windows_[level]) * tstep_ <= resolution + EPSILON) {
+        ++level;
     }
 
-    // Fill ids
-    data_frame.ids.swap(node_id_element_layout.ids);
+    ReportSummary<T> summary;
+    summary.window = level == 0 ? 1 : summary_windows_[level - 1];
+    const auto layout = getNodeIdElementLayout(node_ids, block_gap_limit);
+    if (layout->ids.empty()) {
+        return summary;
+    }
+    checkReportDataType(pop_group_.getDataSet("data"));
 
-    // Fill .data member
-    const size_t n_time_entries = ((index_stop - index_start) / stride) + 1;
-    const size_t element_ids_count = data_frame.ids.size();
-    data_frame.data.resize(n_time_entries * element_ids_count);
+    const size_t first_row = index_start / summary.window;
+    const size_t n_rows = index_stop / summary.window - first_row + 1;
+    for (size_t row = first_row; row < first_row + n_rows; ++row) {
+        summary.times.emplace_back(getTime(row * summary.window));
+    }
 
-    auto dataset = pop_group_.getDataSet("data");
-    auto dataset_type = dataset.getDataType();
-    if (dataset_type.getClass() != HighFive::DataTypeClass::Float || dataset_type.getSize() != 4) {
-        throw SonataError(
-            fmt::format("DataType of dataset 'data' should be Float32 ('{}' was found)",
-                        dataset_type.string()));
+    const size_t n_values = n_rows * layout->ids.size();
+    summary.min.resize(n_values);
+    if (level == 0) {
+        ReportReadBuffer buffer;
+        readFrames(*layout,
+                   index_start,
+                   index_stop,
+                   1,
+                   REPORT_SUMMARY_READ_SIZE,
+                   summary.min.data(),
+                   buffer);
+        summary.max = summary.min;
+        summary.mean = summary.min;
+    } else {
+        summary.max.resize(n_values);
+        summary.mean.resize(n_values);
+        const auto group = pop_group_.getGroup("summary").getGroup(summaryLevelName(level));
+        for (const auto& values : {std::make_pair("min", &summary.min),
+                                   std::make_pair("max", &summary.max),
+                                   std::make_pair("mean", &summary.mean)}) {
+            readLayoutRows(group.getDataSet(values.first),
+                           *layout,
+                           first_row,
+                           n_rows,
+                           REPORT_SUMMARY_READ_SIZE,
+                           values.second->data());
+        }
     }
 
-    std::vector<float> buffer;
-    auto data_start = data_frame.data.begin();
-    for (size_t timer_index = index_start; timer_index <= index_stop; timer_index += stride) {
-        // Access the data in blocks to reduce the file system overhead
-        for (const auto& min_max_block : min_max_blocks) {
-            const auto first_index = node_index[std::get<0>(min_max_block)];
-            const auto last_index = node_index[std::get<1>(min_max_block) - 1];
-            const auto min = std::get<0>(node_ranges[first_index]);
-            const auto max = std::get<1>(node_ranges[last_index]);
+    summary.ids = layout->ids;
+    return summary;
+}
+
+template <typename T>
+auto ReportReader<T>::Population::iterate(const nonstd::optional<Selection>& node_ids,
+                                          const nonstd::optional<double>& tstart,
+                                          const nonstd::optional<double>& tstop,
+                                          const nonstd::optional<size_t>& frames_per_chunk,
+                                          const nonstd::optional<size_t>& tstride,
+                                          const nonstd::optional<size_t>& block_gap_limit,
+                                          size_t prefetch) const -> FrameIterator {
+    HDF5_LOCK_GUARD
+    size_t index_start = 0;
+    size_t index_stop = 0;
+    std::tie(index_start, index_stop) = getIndex(tstart, tstop);
+    const size_t stride = tstride.value_or(1);
+    if (stride == 0) {
+        throw SonataError("tstride should be > 0");
+    }
+    if (frames_per_chunk && frames_per_chunk.value() == 0) {
+        throw SonataError("frames_per_chunk should be > 0");
+    }
 
-            dataset.select({timer_index, min}, {1, max - min}).squeezeMemSpace({0}).read(buffer);
+    auto layout = getNodeIdElementLayout(node_ids, block_gap_limit);
 
-            // Copy the values for each of the GIDs assigned into this block
-            const auto buffer_start = buffer.begin();
-            for (size_t i = std::get<0>(min_max_block); i < std::get<1>(min_max_block); ++i) {
-                const auto index = node_index[i];
-                const auto range = Selection::Range{std::get<0>(node_ranges[index]) - min,
-                                                    std::get<1>(node_ranges[index]) - min};
-                const auto elements_per_gid = (std::get<1>(range) - std::get<0>(range));
-                const auto offset = node_offsets[index];
-
-                // Soma report
-                if (elements_per_gid == 1) {
-                    data_start[offset] = buffer_start[std::get<0>(range)];
-                } else {  // Elements report
-                    std::copy(std::next(buffer_start, std::get<0>(range)),
-                              std::next(buffer_start, std::get<1>(range)),
-                              std::next(data_start, offset));
+    // Default: as many frames as fit in DEFAULT_MAX_READ_SIZE
+    const size_t frame_size = std::max<size_t>(1, layout->ids.size() * sizeof(float));
+    const size_t chunk =
+        frames_per_chunk.value_or(std::max<size_t>(1, DEFAULT_MAX_READ_SIZE / frame_size));
+
+    return FrameIterator(std::make_shared<const Population>(*this),
+                         std::move(layout),
+                         index_start,
+                         index_stop,
+                         stride,
+                         chunk,
+                         prefetch);
+}
+
+/**
+ * Background thread of a prefetching `FrameIterator`, reading its DataFrames in order while
+ * fewer than `depth` of them wait to be consumed.
+ */
+template <typename T>
+class ReportReader<T>::Population::FrameIterator::Prefetcher
+{
+  public:
+    Prefetcher(std::shared_ptr<const Population> population,
+               std::shared_ptr<const NodeIdElementLayout> layout,
+               size_t index_start,
+               size_t index_stop,
+               size_t stride,
+               size_t frames_per_chunk,
+               size_t depth)
+        : depth_(depth)
+        , thread_([this, population, layout, index_start, index_stop, stride, frames_per_chunk]() {
+            run(*population, *layout, index_start, index_stop, stride, frames_per_chunk);
+        }) { }
+
+    ~Prefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopped_ = true;
+        }
+        consumed_.notify_all();
+        thread_.join();
+    }
+
+    /**
+     * Wait for the next DataFrame, rethrowing the error of the thread if it couldn't be read.
+     */
+    DataFrame<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        read_.wait(lock, [this]() { return !ready_.empty() || error_; });
+        if (ready_.empty()) {
+            std::rethrow_exception(error_);
+        }
+
+        auto data_frame = std::move(ready_.front());
+        ready_.pop_front();
+        lock.unlock();
+        consumed_.notify_all();
+        return data_frame;
+    }
+
+  private:
+    void run(const Population& population,
+             const NodeIdElementLayout& layout,
+             size_t index_start,
+             size_t index_stop,
+             size_t stride,
+             size_t frames_per_chunk) {
+        ReportReadBuffer buffer;
+        for (size_t index = index_start; index <= index_stop;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                consumed_.wait(lock, [this]() { return stopped_ || ready_.size() < depth_; });
+                if (stopped_) {
+                    return;
+                }
+            }
+
+            const size_t n_frames = std::min(frames_per_chunk, (index_stop - index) / stride + 1);
+            const size_t index_last = index + (n_frames - 1) * stride;
+
+            DataFrame<T> data_frame;
+            try {
+                HDF5_LOCK_GUARD
+                population.readDataFrame(
+                    layout, index, index_last, stride, DEFAULT_MAX_READ_SIZE, data_frame, buffer);
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    error_ = std::current_exception();
                 }
+                read_.notify_all();
+                return;
+            }
+            data_frame.ids = layout.ids;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ready_.push_back(std::move(data_frame));
             }
+            read_.notify_all();
+            index = index_last + stride;
         }
+    }
+
+    const size_t depth_;
+    std::mutex mutex_;
+    std::condition_variable read_;
+    std::condition_variable consumed_;
+    std::deque<DataFrame<T>> ready_;
+    std::exception_ptr error_;
+    bool stopped_ = false;
+    // Started last, once the members it uses are initialized
+    std::thread thread_;
+};
+
+template <typename T>
+ReportReader<T>::Population::FrameIterator::FrameIterator(
+    std::shared_ptr<const Population> population,
+    std::shared_ptr<const NodeIdElementLayout> layout,
+    size_t index_start,
+    size_t index_stop,
+    size_t stride,
+    size_t frames_per_chunk,
+    size_t prefetch)
+    : population_(std::move(population))
+    , layout_(std::move(layout))
+    , index_next_(index_start)
+    , index_stop_(index_stop)
+    , stride_(stride)
+    , frames_per_chunk_(frames_per_chunk) {
+    if (layout_->ids.empty()) {  // No data available (wrong node_ids?)
+        index_next_ = index_stop_ + 1;
+    } else if (prefetch > 0) {
+        prefetcher_.reset(new Prefetcher(
+            population_, layout_, index_start, index_stop, stride, frames_per_chunk, prefetch));
+    }
+}
+
+template <typename T>
+ReportReader<T>::Population::FrameIterator::FrameIterator(FrameIterator&&) noexcept = default;
 
-        std::advance(data_start, element_ids_count);
+template <typename T>
+typename ReportReader<T>::Population::FrameIterator&
+ReportReader<T>::Population::FrameIterator::operator=(FrameIterator&&) noexcept = default;
+
+template <typename T>
+ReportReader<T>::Population::FrameIterator::~FrameIterator() = default;
+
+template <typename T>
+bool ReportReader<T>::Population::FrameIterator::hasNext() const {
+    return index_next_ <= index_stop_;
+}
+
+template <typename T>
+DataFrame<T> ReportReader<T>::Population::FrameIterator::next() {
+    if (!hasNext()) {
+        throw SonataError("No more frames to iterate over");
     }
 
+    const size_t n_frames = std::min(frames_per_chunk_, (index_stop_ - index_next_) / stride_ + 1);
+    const size_t index_last = index_next_ + (n_frames - 1) * stride_;
+
+    DataFrame<T> data_frame;
+    if (prefetcher_) {
+        // Read by the background thread, in the same order
+        data_frame = prefetcher_->pop();
+    } else {
+        HDF5_LOCK_GUARD
+        population_->readDataFrame(
+            *layout_, index_next_, index_last, stride_, DEFAULT_MAX_READ_SIZE, data_frame, buffer_);
+        data_frame.ids = layout_->ids;
+    }
+
+    index_next_ = index_last + stride_;
     return data_frame;
 }
 
 template class ReportReader<NodeID>;
 template class ReportReader<CompartmentID>;
 
+ReportWriter::Population::Population(HighFive::DataSet data,
+                                     size_t n_frames,
+                                     size_t n_elements,
+                                     size_t frames_per_chunk,
+                                     ReportEncoding encoding,
+                                     float scale_factor,
+                                     float add_offset)
+    : data_(std::move(data))
+    , n_frames_(n_frames)
+    , n_elements_(n_elements)
+    , frames_per_chunk_(frames_per_chunk)
+    , encoding_(encoding)
+    , scale_factor_(scale_factor)
+    , add_offset_(add_offset) { }
+
+size_t ReportWriter::Population::getFrameCount() const {
+    return n_frames_;
+}
+
+size_t ReportWriter::Population::getWrittenFrameCount() const {
+    return n_written_ + n_buffered_;
+}
+
+size_t ReportWriter::Population::getElementCount() const {
+    return n_elements_;
+}
+
+void ReportWriter::Population::writeFrames(const float* data, size_t n_frames) {
+    if (getWrittenFrameCount() + n_frames > n_frames_) {
+        throw SonataError(fmt::format("Writing {} frames past the {} frames of the population",
+                                      getWrittenFrameCount() + n_frames - n_frames_,
+                                      n_frames_));
+    }
+
+    while (n_frames > 0) {
+        // Whole rows of chunks are written as is, the others are gathered in `buffer_`
+        size_t count = n_frames - n_frames % frames_per_chunk_;
+        if (n_buffered_ == 0 && count > 0) {
+            writeRows(data, n_written_, count);
+            n_written_ += count;
+        } else {
+            count = std::min(n_frames, frames_per_chunk_ - n_buffered_);
+            buffer_.insert(buffer_.end(), data, data + count * n_elements_);
+            n_buffered_ += count;
+            if (n_buffered_ == frames_per_chunk_ || getWrittenFrameCount() == n_frames_) {
+                flush();
+            }
+        }
+        data += count * n_elements_;
+        n_frames -= count;
+    }
+}
+
+void ReportWriter::Population::writeFrames(const std::vector<float>& data) {
+    if (n_elements_ == 0 ? !data.empty() : data.size() % n_elements_ != 0) {
+        throw SonataError(
+            fmt::format("The size of the data must be a multiple of {} elements", n_elements_));
+    }
+    writeFrames(data.data(), n_elements_ == 0 ? 0 : data.size() / n_elements_);
+}
+
+void ReportWriter::Population::flush() {
+    if (n_buffered_ == 0) {
+        return;
+    }
+    writeRows(buffer_.data(), n_written_, n_buffered_);
+    n_written_ += n_buffered_;
+    n_buffered_ = 0;
+    buffer_.clear();
+}
+
+void ReportWriter::Population::writeRows(const float* data, size_t row, size_t n_rows) {
+    if (n_elements_ == 0 || n_rows == 0) {
+        return;
+    }
+    auto selection = data_.select({row, 0}, {n_rows, n_elements_});
+    if (encoding_ == ReportEncoding::float32) {
+        selection.write_raw(data);
+        return;
+    }
+
+    const size_t n_values = n_rows * n_elements_;
+    encoded_.resize(n_values);
+    if (encoding_ == ReportEncoding::float16) {
+        for (size_t i = 0; i < n_values; ++i) {
+            encoded_[i] = static_cast<int16_t>(floatToHalf(data[i]));
+        }
+    } else {
+        const DataEncoding encoding{encoding_, scale_factor_, add_offset_};
+        for (size_t i = 0; i < n_values; ++i) {
+            encoded_[i] = encodeInt16(data[i], encoding);
+        }
+    }
+    selection.write_raw(encoded_.data(), data_.getDataType());
+}
+
+ReportWriter::ReportWriter(const std::string& filename)
+    : file_(new HighFive::File(filename, HighFive::File::Truncate)) { }
+
+ReportWriter::ReportWriter(ReportWriter&&) noexcept = default;
+ReportWriter& ReportWriter::operator=(ReportWriter&&) noexcept = default;
+
+ReportWriter::~ReportWriter() {
+    for (auto& entry : populations_) {
+        try {
+            entry.second.flush();
+        } catch (...) {
+        }
+    }
+}
+
+auto ReportWriter::addPopulation(const std::string& populationName,
+                                 const std::vector<NodeID>& node_ids,
+                                 const std::vector<ElementID>& element_ids,
+                                 const std::tuple<double, double, double>& times,
+                                 const std::string& timeUnits,
+                                 const std::string& dataUnits,
+                                 ChunkShape chunkShape,
+                                 size_t chunkSize,
+                                 unsigned compressionLevel,
+                                 ReportEncoding encoding,
+                                 float scaleFactor,
+                                 float addOffset) -> Population& {
+    if (!file_) {
+        throw SonataError("The report was closed");
+    }
+    if (populations_.find(populationName) != populations_.end()) {
+        throw SonataError(fmt::format("Population '{}' was already added", populationName));
+    }
+    if (node_ids.size() != element_ids.size()) {
+        throw SonataError("'node_ids' and 'element_ids' must have the same size");
+    }
+    if (std::get<2>(times) <= 0) {
+        throw SonataError("The time step must be positive");
+    }
+    if (chunkShape == ChunkShape::contiguous && compressionLevel > 0) {
+        throw SonataError("Only chunked datasets can be compressed");
+    }
+    if (encoding == ReportEncoding::int16 && !(scaleFactor != 0.f && std::isfinite(scaleFactor))) {
+        throw SonataError("The scale factor of int16 data must be finite and non-zero");
+    }
+
+    // The nodes of the columns, and their first column
+    std::vector<NodeID> nodes;
+    std::vector<uint64_t> index_pointers;
+    for (size_t i = 0; i < node_ids.size(); ++i) {
+        if (i == 0 || node_ids[i] != node_ids[i - 1]) {
+            nodes.push_back(node_ids[i]);
+            index_pointers.push_back(i);
+        }
+    }
+    index_pointers.push_back(node_ids.size());
+
+    const bool sorted = std::is_sorted(nodes.begin(), nodes.end());
+    {
+        auto unique_nodes = nodes;
+        if (!sorted) {
+            std::sort(unique_nodes.begin(), unique_nodes.end());
+        }
+        const auto it = std::adjacent_find(unique_nodes.begin(), unique_nodes.end());
+        if (it != unique_nodes.end()) {
+            throw SonataError(fmt::format("The columns of node {} must be contiguous", *it));
+        }
+    }
+
+    auto pop = file_->createGroup(std::string("/report/") + populationName);
+    auto mapping = pop.createGroup("mapping");
+    mapping.createDataSet("node_ids", nodes)
+        .createAttribute("sorted", static_cast<uint8_t>(sorted));
+    mapping.createDataSet("index_pointers", index_pointers);
+    mapping.createDataSet("element_ids", element_ids);
+    if (!sorted) {
+        mapping.createDataSet("node_index", sortedNodeIndex(nodes));
+    }
+    mapping
+        .createDataSet("time",
+                       std::vector<double>{std::get<0>(times),
+                                           std::get<1>(times),
+                                           std::get<2>(times)})
+        .createAttribute("units", timeUnits);
+
+    const size_t n_frames = reportFrameCount(std::get<0>(times),
+                                             std::get<1>(times),
+                                             std::get<2>(times));
+    const size_t n_elements = element_ids.size();
+    HighFive::DataSetCreateProps props;
+    size_t frames_per_chunk = 1;
+    if (chunkShape != ChunkShape::contiguous && n_frames > 0 && n_elements > 0) {
+        // Bounds the frames buffered, as floats, until a row of chunks is complete
+        const size_t max_rows = REPORT_WRITE_BUFFER_SIZE / (n_elements * sizeof(float));
+        const auto dims = reportChunkDims(chunkShape, n_frames, n_elements, chunkSize, max_rows);
+        props.add(HighFive::Chunking(dims));
+        if (compressionLevel > 0) {
+            props.add(HighFive::Deflate(compressionLevel));
+        }
+        frames_per_chunk = dims[0];
+    }
+    const HighFive::DataSpace space({n_frames, n_elements});
+    auto data = encoding == ReportEncoding::float16
+                    ? createHalfDataSet(pop, "data", space, props)
+                    : encoding == ReportEncoding::int16
+                          ? pop.createDataSet<int16_t>("data", space, props)
+                          : pop.createDataSet<float>("data", space, props);
+    data.createAttribute("units", dataUnits);
+    data.createAttribute("generation", newDataGeneration());
+    if (encoding == ReportEncoding::int16) {
+        data.createAttribute("scale_factor", scaleFactor);
+        data.createAttribute("add_offset", addOffset);
+    }
+
+    return populations_
+        .emplace(populationName,
+                 Population(std::move(data),
+                            n_frames,
+                            n_elements,
+                            frames_per_chunk,
+                            encoding,
+                            scaleFactor,
+                            addOffset))
+        .first->second;
+}
+
+auto ReportWriter::getPopulation(const std::string& populationName) -> Population& {
+    const auto it = populations_.find(populationName);
+    if (it == populations_.end()) {
+        throw SonataError(fmt::format("Population '{}' was not added", populationName));
+    }
+    return it->second;
+}
+
+void ReportWriter::writeTransposedData(const std::string& filename,
+                                       const std::string& populationName,
+                                       size_t elementsPerChunk,
+                                       size_t framesPerChunk,
+                                       unsigned compressionLevel,
+                                       bool overwrite) {
+    HighFive::File file(filename, HighFive::File::ReadWrite);
+    auto pop = file.getGroup(std::string("/report/") + populationName);
+    if (pop.exist("data_transposed")) {
+        if (!overwrite) {
+            throw SonataError(
+                fmt::format("Population '{}' already has transposed data", populationName));
+        }
+        pop.unlink("data_transposed");
+    }
+
+    auto data = pop.getDataSet("data");
+    const auto dims = data.getDimensions();
+    if (dims.size() != 2) {
+        throw SonataError("Dataset 'data' should have 2 dimensions");
+    }
+    const auto encoding = readDataEncoding(data);
+    const size_t n_frames = dims[0];
+    const size_t n_elements = dims[1];
+    const size_t chunk_elements = std::max<size_t>(1, std::min(elementsPerChunk, n_elements));
+    const size_t chunk_frames = std::max<size_t>(1, std::min(framesPerChunk, n_frames));
+
+    HighFive::DataSetCreateProps props;
+    if (n_frames > 0 && n_elements > 0) {
+        props.add(HighFive::Chunking(std::vector<hsize_t>{chunk_elements, chunk_frames}));
+        if (compressionLevel > 0) {
+            props.add(HighFive::Deflate(compressionLevel));
+        }
+    }
+    auto transposed = pop.createDataSet<float>("data_transposed",
+                                               HighFive::DataSpace({n_elements, n_frames}),
+                                               props);
+    writeDataFingerprint(data, transposed);
+
+    try {
+        // Tiles of a row of chunks of 'data_transposed' by as many elements as fit
+        const size_t elements_per_tile =
+            std::max<size_t>(1,
+                             REPORT_TRANSPOSE_TILE_SIZE /
+                                 (chunk_frames * chunk_elements * sizeof(float))) *
+            chunk_elements;
+        std::vector<float> buffer;
+        std::vector<int16_t> encoded;
+        std::vector<float> tile;
+        for (size_t frame = 0; frame < n_frames; frame += chunk_frames) {
+            const size_t n_tile_frames = std::min(chunk_frames, n_frames - frame);
+            for (size_t element = 0; element < n_elements; element += elements_per_tile) {
+                const size_t n_tile_elements = std::min(elements_per_tile, n_elements - element);
+                buffer.resize(n_tile_frames * n_tile_elements);
+                tile.resize(buffer.size());
+                readDecodedValues(data.select({frame, element}, {n_tile_frames, n_tile_elements}),
+                                  data,
+                                  encoding,
+                                  buffer.size(),
+                                  buffer.data(),
+                                  encoded);
+
+                for (size_t f = 0; f < n_tile_frames; ++f) {
+                    for (size_t e = 0; e < n_tile_elements; ++e) {
+                        tile[e * n_tile_frames + f] = buffer[f * n_tile_elements + e];
+                    }
+                }
+                transposed.select({element, frame}, {n_tile_elements, n_tile_frames})
+                    .write_raw(tile.data());
+            }
+        }
+    } catch (...) {
+        try {
+            // Don't leave partial transposed data behind
+            pop.unlink("data_transposed");
+        } catch (...) {
+        }
+        throw;
+    }
+}
+
+void ReportWriter::writeNodeIndex(const std::string& filename,
+                                  const std::string& populationName,
+                                  bool overwrite) {
+    HighFive::File file(filename, HighFive::File::ReadWrite);
+    auto mapping = file.getGroup(std::string("/report/") + populationName + "/mapping");
+    if (mapping.exist("node_index")) {
+        if (!overwrite) {
+            throw SonataError(
+                fmt::format("Population '{}' already has a node index", populationName));
+        }
+        mapping.unlink("node_index");
+    }
+
+    std::vector<NodeID> node_ids;
+    mapping.getDataSet("node_ids").read(node_ids);
+    mapping.createDataSet("node_index", sortedNodeIndex(node_ids));
+}
+
+void ReportWriter::writeSummaryPyramid(const std::string& filename,
+                                       const std::string& populationName,
+                                       unsigned compressionLevel,
+                                       bool overwrite) {
+    HighFive::File file(filename, HighFive::File::ReadWrite);
+    auto pop = file.getGroup(std::string("/report/") + populationName);
+    if (pop.exist("summary")) {
+        if (!overwrite) {
+            throw SonataError(
+                fmt::format("Population '{}' already has a summary pyramid", populationName));
+        }
+        pop.unlink("summary");
+    }
+
+    auto data = pop.getDataSet("data");
+    const auto dims = data.getDimensions();
+    if (dims.size() != 2) {
+        throw SonataError("Dataset 'data' should have 2 dimensions");
+    }
+    const auto encoding = readDataEncoding(data);
+    const size_t n_frames = dims[0];
+    const size_t n_elements = dims[1];
+
+    auto summary = pop.createGroup("summary");
+    writeDataFingerprint(data, summary);
+    try {
+        // Blocks of an even number of rows of the previous level, or of 'data' for the first
+        const size_t rows_per_read =
+            std::max<size_t>(1, REPORT_SUMMARY_READ_SIZE / (2 * n_elements * sizeof(float))) * 2;
+        std::vector<int16_t> encoded;
+        std::vector<float> in_min;
+        std::vector<float> in_max;
+        std::vector<float> in_mean;
+        std::vector<float> out_min;
+        std::vector<float> out_max;
+        std::vector<float> out_mean;
+
+        size_t rows = n_frames;
+        for (size_t level = 1, window = 1; rows > 1 && n_elements > 0; ++level, window *= 2) {
+            const size_t level_rows = (rows + 1) / 2;
+            HighFive::DataSetCreateProps props;
+            if (compressionLevel > 0) {
+                props.add(HighFive::Chunking(reportChunkDims(
+                    ChunkShape::time_major, level_rows, n_elements, REPORT_SUMMARY_CHUNK_SIZE)));
+                props.add(HighFive::Deflate(compressionLevel));
+            }
+            auto group = summary.createGroup(summaryLevelName(level));
+            group.createAttribute("window", static_cast<uint64_t>(window * 2));
+            const HighFive::DataSpace space({level_rows, n_elements});
+            auto min = group.createDataSet<float>("min", space, props);
+            auto max = group.createDataSet<float>("max", space, props);
+            auto mean = group.createDataSet<float>("mean", space, props);
+
+            for (size_t row = 0; row < rows; row += rows_per_read) {
+                const size_t n_rows = std::min(rows_per_read, rows - row);
+                in_min.resize(n_rows * n_elements);
+                const float* values_min = in_min.data();
+                const float* values_max = in_min.data();
+                const float* values_mean = in_min.data();
+                if (level == 1) {
+                    readDecodedValues(data.select({row, 0}, {n_rows, n_elements}),
+                                      data,
+                                      encoding,
+                                      in_min.size(),
+                                      in_min.data(),
+                                      encoded);
+                } else {
+                    const auto previous = summary.getGroup(summaryLevelName(level - 1));
+                    in_max.resize(in_min.size());
+                    in_mean.resize(in_min.size());
+                    previous.getDataSet("min")
+                        .select({row, 0}, {n_rows, n_elements})
+                        .read_raw(in_min.data());
+                    previous.getDataSet("max")
+                        .select({row, 0}, {n_rows, n_elements})
+                        .read_raw(in_max.data());
+                    previous.getDataSet("mean")
+                        .select({row, 0}, {n_rows, n_elements})
+                        .read_raw(in_mean.data());
+                    values_max = in_max.data();
+                    values_mean = in_mean.data();
+                }
+
+                // Combine pairs of rows, weighting the means by the frames of their windows,
+                // as the last one may be cut short
+                const size_t n_out_rows = (n_rows + 1) / 2;
+                out_min.resize(n_out_rows * n_elements);
+                out_max.resize(out_min.size());
+                out_mean.resize(out_min.size());
+                for (size_t r = 0; r < n_out_rows; ++r) {
+                    const size_t first = 2 * r * n_elements;
+                    float* const o_min = out_min.data() + r * n_elements;
+                    float* const o_max = out_max.data() + r * n_elements;
+                    float* const o_mean = out_mean.data() + r * n_elements;
+                    std::copy(values_min + first, values_min + first + n_elements, o_min);
+                    std::copy(values_max + first, values_max + first + n_elements, o_max);
+                    std::copy(values_mean + first, values_mean + first + n_elements, o_mean);
+                    if (2 * r + 1 == n_rows) {
+                        continue;
+                    }
+
+                    const size_t second = first + n_elements;
+                    const size_t second_frame = (row + 2 * r + 1) * window;
+                    const auto w_first = static_cast<float>(window);
+                    const auto w_second =
+                        static_cast<float>(std::min(window, n_frames - second_frame));
+                    accumulateValues(o_min, values_min + second, n_elements, ReportReduction::min);
+                    accumulateValues(o_max, values_max + second, n_elements, ReportReduction::max);
+                    for (size_t e = 0; e < n_elements; ++e) {
+                        o_mean[e] = (o_mean[e] * w_first + values_mean[second + e] * w_second) /
+                                    (w_first + w_second);
+                    }
+                }
+
+                min.select({row / 2, 0}, {n_out_rows, n_elements}).write_raw(out_min.data());
+                max.select({row / 2, 0}, {n_out_rows, n_elements}).write_raw(out_max.data());
+                mean.select({row / 2, 0}, {n_out_rows, n_elements}).write_raw(out_mean.data());
+            }
+            rows = level_rows;
+        }
+    } catch (...) {
+        try {
+            // Don't leave a partial summary pyramid behind
+            pop.unlink("summary");
+        } catch (...) {
+        }
+        throw;
+    }
+}
+
+void ReportWriter::close() {
+    std::vector<std::string> incomplete;
+    for (auto& entry : populations_) {
+        entry.second.flush();
+        if (entry.second.getWrittenFrameCount() != entry.second.getFrameCount()) {
+            incomplete.push_back(entry.first);
+        }
+    }
+    populations_.clear();
+    file_.reset();
+
+    if (!incomplete.empty()) {
+        throw SonataError(fmt::format("Frames are missing in populations: {}",
+                                      fmt::join(incomplete, ", ")));
+    }
+}
+
 }  // namespace sonata
 }  // namespace bbp
@@ -1,10 +1,16 @@
 #include <catch2/catch_all.hpp>
 
+#include "../extlib/filesystem.hpp"
 #include <bbp/sonata/edges.h>
 
+#include <highfive/H5File.hpp>
+
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -89,6 +95,49 @@ TEST_CASE("EdgePopulation", "[edges]") {
 }
 
 
+TEST_CASE("EdgePopulation::preloadIndices", "[edges]") {
+    EdgePopulation population("./data/edges1.h5", "", "edges-AB");
+    const EdgePopulation onDisk("./data/edges1.h5", "", "edges-AB");
+
+    CHECK_FALSE(population.hasPreloadedIndices());
+    population.preloadIndices();
+    CHECK(population.hasPreloadedIndices());
+
+    CHECK(population.afferentEdges({}).empty());
+    CHECK(population.afferentEdges({3}).empty());
+    CHECK(population.afferentEdges({1}) == Selection({{0, 1}, {2, 4}}));
+    CHECK(population.afferentEdges({1, 2}) == Selection({{0, 4}, {5, 6}}));
+    CHECK(population.afferentEdges({999}).empty());
+
+    CHECK(population.efferentEdges({}).empty());
+    CHECK(population.efferentEdges({0}).empty());
+    CHECK(population.efferentEdges({1, 3}) == Selection({{0, 2}, {4, 6}}));
+    CHECK(population.efferentEdges({2, 1, 2}) == Selection({{0, 4}}));
+
+    CHECK(population.connectingEdges({3}, {0}) == Selection({{4, 5}}));
+    CHECK(population.connectingEdges({0, 1, 2, 3}, {2}) == Selection({{1, 2}, {5, 6}}));
+    CHECK(population.connectingEdges({999}, {999}).empty());
+
+    const std::vector<NodeID> nodes{2, 0, 1, 999, 2, 3};
+    for (const auto* pop : std::vector<const EdgePopulation*>{&population, &onDisk}) {
+        const auto afferent = pop->afferentEdgesPerNode(nodes);
+        const auto efferent = pop->efferentEdgesPerNode(nodes);
+        REQUIRE(afferent.size() == nodes.size());
+        REQUIRE(efferent.size() == nodes.size());
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            CHECK(afferent[i] == onDisk.afferentEdges({nodes[i]}));
+            CHECK(efferent[i] == onDisk.efferentEdges({nodes[i]}));
+        }
+        CHECK(pop->afferentEdgesPerNode({}).size() == 0);
+    }
+
+    // Loaded once per file and population
+    EdgePopulation other("./data/edges1.h5", "", "edges-AB");
+    other.preloadIndices();
+    CHECK(other.afferentEdges({1, 2}) == Selection({{0, 4}, {5, 6}}));
+}
+
+
 TEST_CASE("EdgePopulationSelectAll", "[base]") {
     const EdgePopulation population("./data/edges1.h5", "", "edges-AB");
     CHECK(population.selectAll().flatSize() == 6);
@@ -110,6 +159,7 @@ void copyFile(const std::string& srcFilePath, const std::string& dstFilePath) {
 TEST_CASE("EdgePopulation::writeIndices", "[edges]") {
     const std::string srcFilePath = "./data/edges-no-index.h5";
     const std::string dstFilePath = "./data/edges-no-index.h5.tmp";
+    const std::string rewrittenFilePath = "./data/edges-no-index-rewritten.h5.tmp";
     {
         const EdgePopulation population(srcFilePath, "", "edges-AB");
 
@@ -133,13 +183,83 @@ TEST_CASE("EdgePopulation::writeIndices", "[edges]") {
             EdgePopulation::writeIndices(dstFilePath, "edges-AB", 4, 4, /* overwrite */ false),
             SonataError);
 
-        // Not implemented yet
-        CHECK_THROWS_AS(
-            EdgePopulation::writeIndices(dstFilePath, "edges-AB", 4, 4, /* overwrite */ true),
-            SonataError);
+        EdgePopulation::writeIndices(dstFilePath,
+                                     "edges-AB",
+                                     4,
+                                     4,
+                                     /* overwrite */ true,
+                                     /* n_threads */ 3);
+        {
+            const EdgePopulation population(dstFilePath, "", "edges-AB");
+            CHECK(population.afferentEdges({1, 2}) == Selection({{0, 4}, {5, 6}}));
+            CHECK(population.efferentEdges({1, 2}) == Selection({{0, 4}}));
+        }
+
+        // Rewritten indices are preloaded anew, whatever the name of the file
+        {
+            EdgePopulation population(dstFilePath, "", "edges-AB");
+            population.preloadIndices();
+            CHECK(population.afferentEdges({1, 2}) == Selection({{0, 4}, {5, 6}}));
+        }
+        {
+            HighFive::File file(dstFilePath, HighFive::File::ReadWrite);
+            auto targets = file.getDataSet("/edges/edges-AB/target_node_id");
+            std::vector<NodeID> values;
+            targets.read(values);
+            std::reverse(values.begin(), values.end());
+            targets.write(values);
+        }
+        EdgePopulation::writeIndices(dstFilePath, "edges-AB", 4, 4, /* overwrite */ true);
+        {
+            const EdgePopulation onDisk(dstFilePath, "", "edges-AB");
+            EdgePopulation population("./" + dstFilePath, "", "edges-AB");
+            population.preloadIndices();
+            CHECK(population.afferentEdges({1, 2}) == onDisk.afferentEdges({1, 2}));
+            CHECK(population.efferentEdges({1, 2}) == onDisk.efferentEdges({1, 2}));
+            CHECK(population.afferentEdges({1, 2}) != Selection({{0, 4}, {5, 6}}));
+        }
+
+        // Indices rewritten by other means, e.g. by another process, while still preloaded
+        {
+            namespace fs = ghc::filesystem;
+            const auto afferent = [](const EdgePopulation& pop) {
+                std::vector<Selection> edges;
+                for (const NodeID node : {0, 1, 2, 3}) {
+                    edges.push_back(pop.afferentEdges({node}));
+                }
+                return edges;
+            };
+            EdgePopulation kept(dstFilePath, "", "edges-AB");
+            kept.preloadIndices();
+            const auto before = afferent(kept);
+
+            copyFile(dstFilePath, rewrittenFilePath);
+            {
+                HighFive::File file(rewrittenFilePath, HighFive::File::ReadWrite);
+                auto ranges = file.getDataSet(
+                    "/edges/edges-AB/indices/target_to_source/range_to_edge_id");
+                std::vector<std::vector<uint64_t>> values;
+                ranges.read(values);
+                std::reverse(values.begin(), values.end());
+                ranges.write(values);
+            }
+            // Replaced by a file of the same size, modified after it even on file systems with
+            // coarse modification times
+            fs::last_write_time(rewrittenFilePath,
+                                fs::last_write_time(dstFilePath) + std::chrono::seconds(1));
+            REQUIRE(std::rename(rewrittenFilePath.c_str(), dstFilePath.c_str()) == 0);
+
+            const EdgePopulation onDisk(dstFilePath, "", "edges-AB");
+            REQUIRE(afferent(onDisk) != before);
+            EdgePopulation population(dstFilePath, "", "edges-AB");
+            population.preloadIndices();
+            CHECK(afferent(population) == afferent(onDisk));
+            CHECK(afferent(kept) == before);
+        }
     } catch (...) {
         try {
             std::remove(dstFilePath.c_str());
+            std::remove(rewrittenFilePath.c_str());
         } catch (...) {
         }
         throw;
@@ -149,6 +269,66 @@ TEST_CASE("EdgePopulation::writeIndices", "[edges]") {
 }
 
 
+TEST_CASE("EdgePopulation::connectingEdges", "[edges]") {
+    const std::string path = "./data/edges-connecting.h5.tmp";
+    const uint64_t nodeCount = 100;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<NodeID> nodeDist(0, nodeCount - 1);
+    {
+        // Sorted by target, so that afferent edges are contiguous and efferent ones scattered
+        std::vector<NodeID> sources(5000);
+        std::vector<NodeID> targets(sources.size());
+        for (size_t i = 0; i < sources.size(); ++i) {
+            sources[i] = nodeDist(rng);
+            targets[i] = i * nodeCount / sources.size();
+        }
+
+        HighFive::File file(path, HighFive::File::Truncate);
+        auto group = file.createGroup("/edges/edges-AB");
+        group.createGroup("0");
+        group.createDataSet("source_node_id", sources);
+        group.createDataSet("target_node_id", targets);
+    }
+    EdgePopulation::writeIndices(path, "edges-AB", nodeCount, nodeCount, false, /* n_threads */ 4);
+
+    {
+        const EdgePopulation population(path, "", "edges-AB");
+        const auto allSources = population.sourceNodeIDs(population.selectAll());
+        const auto allTargets = population.targetNodeIDs(population.selectAll());
+
+        const auto randomNodes = [&](size_t count) {
+            std::vector<NodeID> nodes(count);
+            std::generate(nodes.begin(), nodes.end(), [&]() { return nodeDist(rng); });
+            return nodes;
+        };
+        const auto contains = [](const std::vector<NodeID>& nodes, NodeID node) {
+            return std::find(nodes.begin(), nodes.end(), node) != nodes.end();
+        };
+
+        // Covers both filtering the smaller side and intersecting ranges
+        for (const size_t sourceCount : {0, 1, 3, 30, 100}) {
+            for (const size_t targetCount : {0, 1, 3, 30, 100}) {
+                const auto source = randomNodes(sourceCount);
+                const auto target = randomNodes(targetCount);
+
+                Selection::Values expected;
+                for (size_t i = 0; i < allSources.size(); ++i) {
+                    if (contains(source, allSources[i]) && contains(target, allTargets[i])) {
+                        expected.push_back(i);
+                    }
+                }
+                CHECK(population.connectingEdges(source, target) ==
+                      Selection::fromValues(expected));
+            }
+        }
+
+        CHECK(population.connectingEdges({nodeCount + 1}, {0, 1}).empty());
+    }
+
+    std::remove(path.c_str());
+}
+
+
 TEST_CASE("EdgeStorage", "[edges]") {
     // CSV not supported at the moment
     CHECK_THROWS_AS(EdgeStorage("./data/edges1.h5", "csv-file"), SonataError);
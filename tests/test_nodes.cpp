@@ -2,7 +2,9 @@
 
 #include <bbp/sonata/nodes.h>
 
+#include <cstdio>  // std::remove
 #include <iostream>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -160,6 +162,187 @@ TEST_CASE("NodePopulationSelectAll", "[base]") {
     CHECK(population.selectAll().flatSize() == 6);
 }
 
+TEST_CASE("NodePopulationChunkedAttributes", "[base]") {
+    const std::string path = "./data/nodes-chunked.h5.tmp";
+    {
+        HighFive::DataSetCreateProps props;
+        props.add(HighFive::Chunking(std::vector<hsize_t>{8}));
+        props.add(HighFive::Deflate(4));
+
+        std::vector<int32_t> values(100);
+        std::iota(values.begin(), values.end(), 0);
+
+        HighFive::File file(path, HighFive::File::Truncate);
+        file.createGroup("/nodes/nodes-A/0").createDataSet("attr", values, props);
+        file.getGroup("/nodes/nodes-A")
+            .createDataSet("node_type_id", std::vector<int64_t>(values.size(), -1), props);
+    }
+
+    {
+        const NodePopulation population(path, "", "nodes-A");
+        CHECK(population.size() == 100);
+        // ranges sharing chunks are read together
+        CHECK(population.getAttribute<int32_t>("attr",
+                                               Selection({{1, 3}, {5, 9}, {30, 31}, {95, 100}})) ==
+              std::vector<int32_t>{1, 2, 5, 6, 7, 8, 30, 95, 96, 97, 98, 99});
+        CHECK(population.getAttribute<int32_t>("attr", Selection({{60, 61}, {3, 4}})) ==
+              std::vector<int32_t>{60, 3});
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("NodePopulationParallelReader", "[base]") {
+    const std::string path = "./data/nodes-parallel.h5.tmp";
+    {
+        std::vector<int32_t> values(1000);
+        std::iota(values.begin(), values.end(), 0);
+
+        HighFive::DataSetCreateProps props;
+        props.add(HighFive::Chunking(std::vector<hsize_t>{64}));
+        props.add(HighFive::Deflate(4));
+
+        HighFive::File file(path, HighFive::File::Truncate);
+        auto group = file.createGroup("/nodes/nodes-A/0");
+        group.createDataSet("attr", values);
+        group.createDataSet("attr-double", std::vector<double>(values.begin(), values.end()));
+        group.createDataSet("attr-chunked", values, props);
+        group.createDataSet("attr-string", std::vector<std::string>(values.size(), "a"));
+        file.getGroup("/nodes/nodes-A")
+            .createDataSet("node_type_id", std::vector<int64_t>(values.size(), -1));
+    }
+
+    {
+        const NodePopulation serial(path, "", "nodes-A");
+        const NodePopulation parallel(path, "", "nodes-A", makeParallelHdf5Reader(4));
+
+        const auto selections = std::vector<Selection>{
+            Selection({{0, 1000}}),
+            Selection({{1, 3}, {5, 9}, {30, 31}, {995, 1000}}),
+            Selection({{600, 610}, {3, 4}, {605, 700}}),  // unsorted and overlapping
+            Selection({}),
+        };
+        for (const auto& selection : selections) {
+            CHECK(parallel.getAttribute<int32_t>("attr", selection) ==
+                  serial.getAttribute<int32_t>("attr", selection));
+            CHECK(parallel.getAttribute<double>("attr-double", selection) ==
+                  serial.getAttribute<double>("attr-double", selection));
+            CHECK(parallel.getAttribute<int32_t>("attr-chunked", selection) ==
+                  serial.getAttribute<int32_t>("attr-chunked", selection));
+            CHECK(parallel.getAttribute<std::string>("attr-string", selection) ==
+                  serial.getAttribute<std::string>("attr-string", selection));
+        }
+
+        // Values are converted by HDF5 if the types differ
+        CHECK(parallel.getAttribute<int64_t>("attr", Selection({{10, 12}})) ==
+              std::vector<int64_t>{10, 11});
+
+        CHECK_THROWS(parallel.getAttribute<int32_t>("attr", Selection({{999, 1001}})));
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("NodePopulationMappedReader", "[base]") {
+    const std::string path = "./data/nodes-mapped.h5.tmp";
+    {
+        std::vector<int32_t> values(1000);
+        std::iota(values.begin(), values.end(), 0);
+
+        HighFive::DataSetCreateProps props;
+        props.add(HighFive::Chunking(std::vector<hsize_t>{64}));
+        props.add(HighFive::Deflate(4));
+
+        HighFive::File file(path, HighFive::File::Truncate);
+        auto group = file.createGroup("/nodes/nodes-A/0");
+        group.createDataSet("attr", values);
+        group.createDataSet("attr-double", std::vector<double>(values.begin(), values.end()));
+        group.createDataSet("attr-chunked", values, props);
+        group.createDataSet("attr-string", std::vector<std::string>(values.size(), "a"));
+        group.createDataSet("attr-empty", std::vector<int32_t>{});
+        file.getGroup("/nodes/nodes-A")
+            .createDataSet("node_type_id", std::vector<int64_t>(values.size(), -1));
+    }
+
+    {
+        const NodePopulation serial(path, "", "nodes-A");
+        const NodePopulation mapped(path, "", "nodes-A", makeMappedHdf5Reader());
+
+        const auto selections = std::vector<Selection>{
+            Selection({{0, 1000}}),
+            Selection({{1, 3}, {5, 9}, {30, 31}, {995, 1000}}),
+            Selection({{600, 610}, {3, 4}, {605, 700}}),  // unsorted and overlapping
+            Selection({}),
+        };
+        for (const auto& selection : selections) {
+            CHECK(mapped.getAttribute<int32_t>("attr", selection) ==
+                  serial.getAttribute<int32_t>("attr", selection));
+            CHECK(mapped.getAttribute<double>("attr-double", selection) ==
+                  serial.getAttribute<double>("attr-double", selection));
+            CHECK(mapped.getAttribute<int32_t>("attr-chunked", selection) ==
+                  serial.getAttribute<int32_t>("attr-chunked", selection));
+            CHECK(mapped.getAttribute<std::string>("attr-string", selection) ==
+                  serial.getAttribute<std::string>("attr-string", selection));
+        }
+
+        CHECK(mapped.getAttribute<int64_t>("attr", Selection({{10, 12}})) ==
+              std::vector<int64_t>{10, 11});
+        CHECK_THROWS(mapped.getAttribute<int32_t>("attr", Selection({{999, 1001}})));
+
+        const auto view = serial.getAttributeView<int32_t>("attr");
+        CHECK(std::vector<int32_t>(view.begin(), view.end()) ==
+              serial.getAttribute<int32_t>("attr", serial.selectAll()));
+        CHECK(serial.getAttributeView<double>("attr-double")[999] == 999.);
+        CHECK(serial.getAttributeView<int32_t>("attr-empty").empty());
+
+        CHECK_THROWS_AS(serial.getAttributeView<int32_t>("attr-chunked"), SonataError);
+        CHECK_THROWS_AS(serial.getAttributeView<int64_t>("attr"), SonataError);
+        CHECK_THROWS_AS(serial.getAttributeView<int32_t>("no-such-attribute"), SonataError);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("NodePopulationMappedReader rewritten file", "[base]") {
+    const std::string path = "./data/nodes-mapped-rewritten.h5.tmp";
+    const auto write = [&path](size_t n_nodes, int32_t first) {
+        std::vector<int32_t> values(n_nodes);
+        std::iota(values.begin(), values.end(), first);
+
+        std::remove(path.c_str());
+        HighFive::File file(path, HighFive::File::Truncate);
+        auto group = file.createGroup("/nodes/nodes-A/0");
+        // Another dataset first, so that 'attr' is at another offset in a larger file
+        group.createDataSet("other", std::vector<double>(n_nodes, 0.));
+        group.createDataSet("attr", values);
+        file.getGroup("/nodes/nodes-A")
+            .createDataSet("node_type_id", std::vector<int64_t>(values.size(), -1));
+    };
+
+    const auto reader = makeMappedHdf5Reader();
+    try {
+        write(100, 0);
+        {
+            const NodePopulation mapped(path, "", "nodes-A", reader);
+            CHECK(mapped.getAttribute<int32_t>("attr", Selection({{98, 100}})) ==
+                  std::vector<int32_t>{98, 99});
+        }
+
+        // Same path, other file: read through the same reader, it is mapped anew
+        write(1000, 5000);
+        {
+            const NodePopulation mapped(path, "", "nodes-A", reader);
+            CHECK(mapped.getAttribute<int32_t>("attr", Selection({{98, 100}, {998, 1000}})) ==
+                  std::vector<int32_t>{5098, 5099, 5998, 5999});
+        }
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+}
+
 TEST_CASE("NodePopulationmatchAttributeValues", "[base]") {
     NodePopulation population("./data/nodes1.h5", "", "nodes-A");
 
@@ -1,9 +1,118 @@
 #include <catch2/catch_all.hpp>
 
+#include "../extlib/filesystem.hpp"
+
+#include <bbp/sonata/compartment_sets.h>
 #include <bbp/sonata/report_reader.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>  // std::remove
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+
 using namespace bbp::sonata;
 
+namespace {
+
+// Write an element report `/report/All` with `n_nodes` sorted nodes of `n_elements` each and
+// `n_frames` timesteps of 0.1ms; data[t][i] = t + i / 1000. If `chunk` is not empty, 'data' is
+// chunked accordingly and compressed.
+void writeElementReport(const std::string& path,
+                        size_t n_nodes,
+                        size_t n_elements,
+                        size_t n_frames,
+                        const std::vector<hsize_t>& chunk = {}) {
+    HighFive::File file(path, HighFive::File::Truncate);
+    auto pop = file.createGroup("/report/All");
+    auto mapping = pop.createGroup("mapping");
+
+    std::vector<NodeID> node_ids(n_nodes);
+    std::iota(node_ids.begin(), node_ids.end(), NodeID{1});
+    std::vector<uint64_t> index_pointers(n_nodes + 1);
+    std::vector<ElementID> element_ids(n_nodes * n_elements);
+    for (size_t i = 0; i <= n_nodes; ++i) {
+        index_pointers[i] = i * n_elements;
+    }
+    for (size_t i = 0; i < element_ids.size(); ++i) {
+        element_ids[i] = static_cast<ElementID>(i % n_elements);
+    }
+
+    mapping.createDataSet("node_ids", node_ids)
+        .createAttribute("sorted", static_cast<uint8_t>(1));
+    mapping.createDataSet("index_pointers", index_pointers);
+    mapping.createDataSet("element_ids", element_ids);
+    mapping.createDataSet("time", std::vector<double>{0., 0.1 * n_frames, 0.1})
+        .createAttribute("units", std::string("ms"));
+
+    const size_t n_cols = element_ids.size();
+    std::vector<float> data(n_frames * n_cols);
+    for (size_t t = 0; t < n_frames; ++t) {
+        for (size_t i = 0; i < n_cols; ++i) {
+            data[t * n_cols + i] = static_cast<float>(t) + static_cast<float>(i) / 1000.f;
+        }
+    }
+    HighFive::DataSetCreateProps props;
+    if (!chunk.empty()) {
+        props.add(HighFive::Chunking(chunk));
+        props.add(HighFive::Deflate(4));
+    }
+    auto dataset =
+        pop.createDataSet<float>("data", HighFive::DataSpace({n_frames, n_cols}), props);
+    dataset.write_raw(data.data());
+    dataset.createAttribute("units", std::string("mV"));
+}
+
+// An HDF5 filter which leaves the values as they are, counting the chunks it decodes, i.e. the
+// chunks read from the file (unless cached by HDF5)
+constexpr H5Z_filter_t COUNTING_FILTER = 300;  // In the range reserved for testing
+size_t decoded_chunks = 0;
+
+size_t countingFilter(
+    unsigned int flags, size_t, const unsigned int[], size_t nbytes, size_t*, void**) {
+    if (flags & H5Z_FLAG_REVERSE) {
+        ++decoded_chunks;
+    }
+    return nbytes;
+}
+
+void registerCountingFilter() {
+    static const H5Z_class2_t filter_class = {H5Z_CLASS_T_VERS,
+                                              COUNTING_FILTER,
+                                              1,
+                                              1,
+                                              "counting",
+                                              nullptr,
+                                              nullptr,
+                                              countingFilter};
+    REQUIRE(H5Zregister(&filter_class) >= 0);
+}
+
+// Write the 'data' of the report `path` anew, in chunks of `chunk` through the counting filter,
+// returning its values
+std::vector<float> rewriteCountedData(const std::string& path, const std::vector<hsize_t>& chunk) {
+    registerCountingFilter();
+    HighFive::File file(path, HighFive::File::ReadWrite);
+    auto pop = file.getGroup("/report/All");
+    const auto dims = pop.getDataSet("data").getDimensions();
+    std::vector<float> values(dims[0] * dims[1]);
+    pop.getDataSet("data").read_raw(values.data());
+    pop.unlink("data");
+
+    HighFive::DataSetCreateProps props;
+    props.add(HighFive::Chunking(chunk));
+    REQUIRE(H5Pset_filter(props.getId(), COUNTING_FILTER, H5Z_FLAG_MANDATORY, 0, nullptr) >= 0);
+    auto data = pop.createDataSet<float>("data", HighFive::DataSpace(dims), props);
+    data.write_raw(values.data());
+    data.createAttribute("units", std::string("mV"));
+    return values;
+}
+
+}  // unnamed namespace
+
 void testTimes(const std::vector<double>& vec, double start, double step, int size) {
     REQUIRE(size == vec.size());
     for (int i = 0; i < vec.size(); ++i) {
@@ -30,6 +139,13 @@ TEST_CASE("SpikeReader", "[base]") {
     REQUIRE(reader.openPopulation("spikes2").getSorting() ==
             SpikeReader::Population::Sorting::none);
 
+    // Spikes sorted by ID follow the order of the ranges, each spike appearing once
+    REQUIRE(reader.openPopulation("spikes1").get(Selection({{5, 6}, {2, 4}, {3, 6}})) ==
+            std::vector<std::pair<uint64_t, double>>{
+                {5UL, 0.1}, {2UL, 0.2}, {2UL, 0.7}, {3UL, 0.3}, {3UL, 1.3}});
+    REQUIRE(reader.openPopulation("spikes2").get(Selection({{5, 6}, {2, 4}, {3, 6}})) ==
+            reader.openPopulation("spikes2").get(Selection({{2, 6}})));
+
     REQUIRE(reader.openPopulation("All").get(Selection({{5, 6}}), 0.1, 0.1) ==
             std::vector<std::pair<uint64_t, double>>{{5, 0.1}});
     REQUIRE(reader.openPopulation("empty").get() == std::vector<std::pair<uint64_t, double>>{});
@@ -38,6 +154,300 @@ TEST_CASE("SpikeReader", "[base]") {
     REQUIRE(reader.openPopulation("All").getTimeUnits() == "ms");
 }
 
+TEST_CASE("SpikeReader::getArrays", "[base]") {
+    const SpikeReader reader("./data/spikes.h5");
+
+    const auto selections = std::vector<nonstd::optional<Selection>>{
+        nonstd::nullopt,
+        Selection({}),
+        Selection({{3, 4}}),
+        Selection({{5, 6}, {1, 4}, {2, 3}}),  // unsorted and overlapping
+        Selection({{0, 1000}}),
+    };
+    const auto times = std::vector<nonstd::optional<double>>{nonstd::nullopt, 0.1, 0.3, 1.3, 5.};
+
+    for (const auto& name : reader.getPopulationNames()) {
+        const auto& population = reader.openPopulation(name);
+        const auto& raw = population.getRawArrays();
+        // Reused across queries
+        SpikeTimes buffer;
+
+        for (const auto& node_ids : selections) {
+            for (const auto& tstart : times) {
+                for (const auto& tstop : times) {
+                    SpikeTimes expected;
+                    for (size_t i = 0; i < raw.node_ids.size(); ++i) {
+                        const auto node_id = raw.node_ids[i];
+                        const auto timestamp = raw.timestamps[i];
+                        if ((!node_ids || node_ids->contains(node_id)) &&
+                            (!tstart || timestamp >= *tstart) && (!tstop || timestamp <= *tstop)) {
+                            expected.node_ids.push_back(node_id);
+                            expected.timestamps.push_back(timestamp);
+                        }
+                    }
+
+                    const auto actual = population.getArrays(node_ids, tstart, tstop);
+                    CHECK(actual.node_ids == expected.node_ids);
+                    CHECK(actual.timestamps == expected.timestamps);
+
+                    population.getArrays(buffer, node_ids, tstart, tstop);
+                    CHECK(buffer.node_ids == expected.node_ids);
+                    CHECK(buffer.timestamps == expected.timestamps);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("SpikeReader lazy", "[base]") {
+    const SpikeReader eager("./data/spikes.h5");
+    const SpikeReader lazy("./data/spikes.h5", /* lazy */ true);
+
+    const auto selections = std::vector<nonstd::optional<Selection>>{
+        nonstd::nullopt,
+        Selection({}),
+        Selection({{3, 4}}),
+        Selection({{5, 6}, {1, 4}, {2, 3}}),  // unsorted and overlapping
+        Selection({{0, 1000}}),
+    };
+    const auto times = std::vector<nonstd::optional<double>>{nonstd::nullopt, 0.1, 0.3, 1.3, 5.};
+
+    for (const auto& name : eager.getPopulationNames()) {
+        const auto& expected = eager.openPopulation(name);
+        const auto& actual = lazy.openPopulation(name);
+
+        CHECK(actual.getSorting() == expected.getSorting());
+        CHECK(actual.getTimes() == expected.getTimes());
+        CHECK(actual.getTimeUnits() == expected.getTimeUnits());
+
+        for (const auto& node_ids : selections) {
+            for (const auto& tstart : times) {
+                for (const auto& tstop : times) {
+                    const auto expected_arrays = expected.getArrays(node_ids, tstart, tstop);
+                    const auto actual_arrays = actual.getArrays(node_ids, tstart, tstop);
+                    CHECK(actual_arrays.node_ids == expected_arrays.node_ids);
+                    CHECK(actual_arrays.timestamps == expected_arrays.timestamps);
+
+                    if (tstart && tstop && *tstart > *tstop) {
+                        CHECK_THROWS_AS(actual.get(node_ids, tstart, tstop), SonataError);
+                    } else {
+                        CHECK(actual.get(node_ids, tstart, tstop) ==
+                              expected.get(node_ids, tstart, tstop));
+                    }
+                }
+            }
+        }
+
+        CHECK(actual.getRawArrays().node_ids == expected.getRawArrays().node_ids);
+        CHECK(actual.getRawArrays().timestamps == expected.getRawArrays().timestamps);
+    }
+}
+
+TEST_CASE("SpikeReader statistics", "[base]") {
+    const SpikeReader reader("./data/spikes.h5");
+
+    // The same spikes, sorted differently
+    for (const auto& name : {"All", "spikes1", "spikes2"}) {
+        const auto& population = reader.openPopulation(name);
+        for (const size_t n_threads : {1, 3}) {
+            CHECK(population.binnedCounts(nonstd::nullopt, 0., 1.5, 0.5, n_threads) ==
+                  std::vector<uint64_t>{3, 1, 1});
+            CHECK(population.binnedCounts(Selection({{2, 4}}), 0., 1.5, 0.5, n_threads) ==
+                  std::vector<uint64_t>{2, 1, 1});
+            // Half-open and with a shorter last bin
+            CHECK(population.binnedCounts(nonstd::nullopt, 0.2, 1.3, 0.4, n_threads) ==
+                  std::vector<uint64_t>{2, 1, 0});
+
+            CHECK(population.firingRates(Selection::fromValues({2, 3, 5, 7}), 0., 2., n_threads) ==
+                  std::vector<double>{1., 1., 0.5, 0.});
+
+            const auto stats = population.isiStats(Selection::fromValues({3, 2, 5}),
+                                                   nonstd::nullopt,
+                                                   nonstd::nullopt,
+                                                   n_threads);
+            CHECK(stats.node_ids == std::vector<NodeID>{3, 2, 5});
+            CHECK(stats.counts == std::vector<uint64_t>{1, 1, 0});
+            CHECK(stats.means[0] == Catch::Approx(1.));
+            CHECK(stats.means[1] == Catch::Approx(0.5));
+            CHECK(std::isnan(stats.means[2]));
+            CHECK(stats.cvs[0] == 0.);
+            CHECK(std::isnan(stats.cvs[2]));
+        }
+    }
+
+    const auto& population = reader.openPopulation("All");
+    CHECK(population.isiStats(Selection({{2, 3}}), 0.5, 1.5).counts == std::vector<uint64_t>{0});
+    CHECK(reader.openPopulation("empty").binnedCounts(nonstd::nullopt, 0., 1., 0.5) ==
+          std::vector<uint64_t>{0, 0});
+    CHECK_THROWS_AS(population.binnedCounts(nonstd::nullopt, 0., 1., 0.), SonataError);
+    CHECK_THROWS_AS(population.binnedCounts(nonstd::nullopt, 1., 1., 0.1), SonataError);
+    CHECK_THROWS_AS(population.firingRates(Selection({{2, 3}}), 1., 1.), SonataError);
+}
+
+TEST_CASE("SpikeWriter", "[base]") {
+    const std::string path = "./data/spikes-written.h5.tmp";
+    const SpikeReader original("./data/spikes.h5");
+    {
+        SpikeWriter writer(path);
+        for (const auto& name : original.getPopulationNames()) {
+            const auto& population = original.openPopulation(name);
+            writer.addPopulation(name, population.getSorting(), population.getTimeUnits());
+            writer.addSpikes(name,
+                             population.getRawArrays().node_ids,
+                             population.getRawArrays().timestamps);
+        }
+        CHECK_THROWS_AS(writer.addPopulation("All"), SonataError);
+        CHECK_THROWS_AS(writer.addSpikes("no-such-population", {1}, {0.1}), SonataError);
+        CHECK_THROWS_AS(writer.addSpikes("All", {1, 2}, {0.1}), SonataError);
+        CHECK_THROWS_AS(writer.write(0, 4), SonataError);
+        writer.write(/* chunkSize */ 2, /* compressionLevel */ 4);
+
+        // Writing again would overwrite the spikes already written
+        CHECK_THROWS_AS(writer.write(), SonataError);
+        CHECK_THROWS_AS(writer.addSpikes("All", {1}, {0.1}), SonataError);
+        CHECK_THROWS_AS(writer.addPopulation("other"), SonataError);
+    }
+
+    // The spikes of './data/spikes.h5' are already sorted
+    const SpikeReader written(path);
+    REQUIRE(written.getPopulationNames() == original.getPopulationNames());
+    for (const auto& name : original.getPopulationNames()) {
+        const auto& expected = original.openPopulation(name);
+        const auto& actual = written.openPopulation(name);
+        CHECK(actual.getSorting() == expected.getSorting());
+        CHECK(actual.getTimeUnits() == expected.getTimeUnits());
+        CHECK(actual.getTimes() == expected.getTimes());
+        CHECK(actual.getRawArrays().node_ids == expected.getRawArrays().node_ids);
+        CHECK(actual.getRawArrays().timestamps == expected.getRawArrays().timestamps);
+        CHECK(actual.get(Selection({{2, 4}}), 0.2, 1.0) ==
+              expected.get(Selection({{2, 4}}), 0.2, 1.0));
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("SpikeWriter sorting", "[base]") {
+    const std::string path = "./data/spikes-sorted.h5.tmp";
+    const size_t n_batches = 8;
+    const size_t batch_size = 10000;
+    Spikes added;
+    {
+        SpikeWriter writer(path, /* n_threads */ 4);
+        writer.addPopulation("by_time", SpikeWriter::Sorting::by_time);
+        writer.addPopulation("by_id", SpikeWriter::Sorting::by_id);
+        writer.addPopulation("none", SpikeWriter::Sorting::none);
+
+        std::vector<SpikeTimes> batches(n_batches);
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<NodeID> node_dist(0, 999);
+        std::uniform_real_distribution<double> time_dist(0., 1000.);
+        for (auto& batch : batches) {
+            for (size_t i = 0; i < batch_size; ++i) {
+                batch.node_ids.push_back(node_dist(rng));
+                // Some spikes at the same time
+                batch.timestamps.push_back(i % 10 == 0 ? 1.5 : time_dist(rng));
+                added.emplace_back(batch.node_ids.back(), batch.timestamps.back());
+            }
+        }
+
+        std::vector<std::thread> threads;
+        for (const auto& batch : batches) {
+            threads.emplace_back([&writer, &batch]() {
+                for (const auto& name : {"by_time", "by_id", "none"}) {
+                    writer.addSpikes(name, batch.node_ids, batch.timestamps);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        writer.write();
+    }
+
+    std::sort(added.begin(), added.end());
+    const SpikeReader reader(path);
+    for (const auto& name : {"by_time", "by_id", "none"}) {
+        const auto& population = reader.openPopulation(name);
+        auto spikes = population.get();
+        REQUIRE(spikes.size() == n_batches * batch_size);
+
+        if (population.getSorting() == SpikeWriter::Sorting::by_time) {
+            CHECK(std::is_sorted(spikes.begin(), spikes.end(), [](const Spike& a, const Spike& b) {
+                return a.second < b.second;
+            }));
+        } else if (population.getSorting() == SpikeWriter::Sorting::by_id) {
+            CHECK(std::is_sorted(spikes.begin(), spikes.end()));
+        }
+
+        std::sort(spikes.begin(), spikes.end());
+        CHECK(spikes == added);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("MergedSpikeReader", "[base]") {
+    using Sorting = MergedSpikeReader::Sorting;
+    const std::string path = "./data/spikes.h5";
+    const SpikeReader reader(path);
+
+    std::vector<MergedSpikeReader::Source> sources;
+    std::vector<std::tuple<NodeID, double, size_t>> expected;
+    for (const auto& name : reader.getPopulationNames()) {
+        const auto& spikes = reader.openPopulation(name).getRawArrays();
+        for (size_t i = 0; i < spikes.node_ids.size(); ++i) {
+            expected.emplace_back(spikes.node_ids[i], spikes.timestamps[i], sources.size());
+        }
+        sources.emplace_back(path, name);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    CHECK_THROWS_AS(MergedSpikeReader(sources, Sorting::none), SonataError);
+    CHECK_THROWS(MergedSpikeReader(std::vector<MergedSpikeReader::Source>{
+        {path, "no-such-population"}}));
+
+    for (const auto sorting : {Sorting::by_time, Sorting::by_id}) {
+        MergedSpikeReader merged(sources, sorting, /* blockSize */ 2);
+        CHECK(merged.getSources() == sources);
+
+        for (size_t pass = 0; pass < 2; ++pass) {
+            std::vector<std::tuple<NodeID, double, size_t>> actual;
+            while (!merged.done()) {
+                const auto spikes = merged.next(3);
+                REQUIRE(!spikes.node_ids.empty());
+                REQUIRE(spikes.node_ids.size() <= 3);
+                REQUIRE(spikes.timestamps.size() == spikes.node_ids.size());
+                REQUIRE(spikes.sources.size() == spikes.node_ids.size());
+                for (size_t i = 0; i < spikes.node_ids.size(); ++i) {
+                    actual.emplace_back(spikes.node_ids[i],
+                                        spikes.timestamps[i],
+                                        spikes.sources[i]);
+                }
+            }
+            CHECK(merged.next(3).node_ids.empty());
+
+            // Sorted by the merge key, then by source
+            CHECK(std::is_sorted(actual.begin(), actual.end(), [&](const auto& a, const auto& b) {
+                if (sorting == Sorting::by_time && std::get<1>(a) != std::get<1>(b)) {
+                    return std::get<1>(a) < std::get<1>(b);
+                } else if (sorting == Sorting::by_id && std::get<0>(a) != std::get<0>(b)) {
+                    return std::get<0>(a) < std::get<0>(b);
+                }
+                return std::get<2>(a) < std::get<2>(b);
+            }));
+
+            std::sort(actual.begin(), actual.end());
+            CHECK(actual == expected);
+
+            merged.reset();
+        }
+    }
+
+    MergedSpikeReader empty(std::vector<MergedSpikeReader::Source>{});
+    CHECK(empty.done());
+    CHECK(empty.next(10).node_ids.empty());
+}
+
 TEST_CASE("SomaReportReader limits", "[base]") {
     const SomaReportReader reader("./data/somas.h5");
 
@@ -164,6 +574,13 @@ TEST_CASE("ElementReportReader", "[base]") {
     REQUIRE(pop.get(Selection({{1, 2}}), 0.6, 0.6).data ==
             std::vector<float>{30.0f, 30.1f, 30.2f, 30.3f, 30.4f});
 
+    // Reading one timestep or several timesteps per IO block gives the same result
+    const auto all = pop.get();
+    REQUIRE(pop.get(nonstd::nullopt, nonstd::nullopt, nonstd::nullopt, 1, nonstd::nullopt, 1)
+                .data == all.data);
+    REQUIRE(pop.get(sel, 0.2, 3.0, 3, nonstd::nullopt, 7 * sizeof(float)).data ==
+            pop.get(sel, 0.2, 3.0, 3).data);
+
     auto ids = pop.getNodeIdElementIdMapping(Selection({{3, 5}}));
     REQUIRE(ids == std::vector<CompartmentID>{{3, 5}, {3, 5}, {3, 6}, {3, 6}, {3, 7}, {4, 7}, {4, 8}, {4, 8}, {4, 9}, {4, 9}});
 
@@ -172,3 +589,1297 @@ TEST_CASE("ElementReportReader", "[base]") {
 
     REQUIRE_THROWS(pop.getNodeIdElementIdMapping(Selection({{3, 5}}), 4194303)); // < 1 x GPFS block
 }
+
+TEST_CASE("ElementReportReader iterate", "[base]") {
+    const ElementReportReader reader("./data/elements.h5");
+    const auto& pop = reader.openPopulation("All");
+    const auto sel = Selection({{3, 5}, {12, 13}});
+
+    const auto reference = pop.get(sel, 0.4, 3.0, 2);
+    const size_t n_cols = reference.ids.size();
+
+    auto iterator = pop.iterate(sel, 0.4, 3.0, 3, 2);
+    std::vector<double> times;
+    std::vector<float> data;
+    while (iterator.hasNext()) {
+        const auto frame = iterator.next();
+        REQUIRE(frame.ids == reference.ids);
+        REQUIRE(frame.times.size() <= 3);
+        REQUIRE(frame.data.size() == frame.times.size() * n_cols);
+        times.insert(times.end(), frame.times.begin(), frame.times.end());
+        data.insert(data.end(), frame.data.begin(), frame.data.end());
+    }
+    REQUIRE(times == reference.times);
+    REQUIRE(data == reference.data);
+    REQUIRE_THROWS(iterator.next());
+
+    // Prefetched frames come in the same order, whatever the number read ahead
+    for (const size_t prefetch : {1, 2, 16}) {
+        auto prefetching = pop.iterate(sel, 0.4, 3.0, 1, 2, nonstd::nullopt, prefetch);
+        std::vector<float> prefetched;
+        while (prefetching.hasNext()) {
+            const auto frame = prefetching.next();
+            REQUIRE(frame.ids == reference.ids);
+            prefetched.insert(prefetched.end(), frame.data.begin(), frame.data.end());
+        }
+        CHECK(prefetched == reference.data);
+        CHECK_THROWS(prefetching.next());
+    }
+
+    // The population is read by other threads while prefetching: the reads are serialized
+    {
+        const auto other_sel = Selection({{1, 3}, {7, 10}});
+        const auto other_reference = pop.get(other_sel);
+        bool other_ok = true;
+        std::thread other([&]() {
+            for (size_t i = 0; i < 50; ++i) {
+                other_ok = other_ok && pop.get(other_sel).data == other_reference.data;
+            }
+        });
+
+        auto prefetching = pop.iterate(sel, 0.4, 3.0, 1, 2, nonstd::nullopt, 4);
+        std::vector<float> prefetched;
+        while (prefetching.hasNext()) {
+            REQUIRE(pop.get(other_sel).data == other_reference.data);
+            const auto frame = prefetching.next();
+            prefetched.insert(prefetched.end(), frame.data.begin(), frame.data.end());
+        }
+        other.join();
+        CHECK(other_ok);
+        CHECK(prefetched == reference.data);
+    }
+
+    // Moved, or dropped before all the frames are consumed
+    {
+        auto prefetching = pop.iterate(sel, 0.4, 3.0, 1, 2, nonstd::nullopt, 2);
+        auto moved = std::move(prefetching);
+        CHECK(moved.next().data ==
+              std::vector<float>(reference.data.begin(), reference.data.begin() + n_cols));
+    }
+
+    // Outliving the reader and population it was opened from, while prefetching
+    for (const size_t prefetch : {0, 2}) {
+        auto orphan = ElementReportReader("./data/elements.h5")
+                          .openPopulation("All")
+                          .iterate(sel, 0.4, 3.0, 1, 2, nonstd::nullopt, prefetch);
+        std::vector<float> orphaned;
+        while (orphan.hasNext()) {
+            const auto frame = orphan.next();
+            orphaned.insert(orphaned.end(), frame.data.begin(), frame.data.end());
+        }
+        CHECK(orphaned == reference.data);
+    }
+
+    // Default chunk size covers the whole (small) report
+    auto all = pop.iterate();
+    REQUIRE(all.next().data == pop.get().data);
+    REQUIRE_FALSE(all.hasNext());
+
+    // No matching nodes
+    REQUIRE_FALSE(pop.iterate(Selection({{100, 101}})).hasNext());
+
+    REQUIRE_THROWS(pop.iterate(sel, 0.4, 3.0, 0));
+    REQUIRE_THROWS(pop.iterate(sel, 0.4, 3.0, 1, 0));
+    REQUIRE_THROWS(pop.iterate(sel, 3.0, 0.4));
+}
+
+TEST_CASE("ElementReportReader repeated queries", "[base]") {
+    const ElementReportReader reader("./data/elements.h5");
+    const auto& pop = reader.openPopulation("All");
+    const auto sel = Selection({{3, 5}, {12, 13}});
+
+    // Sliding time windows over the same selection reuse its layout
+    const auto reference = pop.get(sel);
+    const size_t n_cols = reference.ids.size();
+    for (size_t i = 0; i + 5 <= reference.times.size(); ++i) {
+        const auto window = pop.get(sel, reference.times[i], reference.times[i + 4]);
+        REQUIRE(window.ids == reference.ids);
+        REQUIRE(window.times.size() == 5);
+        REQUIRE(std::equal(window.data.begin(),
+                           window.data.end(),
+                           reference.data.begin() + i * n_cols));
+    }
+    REQUIRE(pop.getNodeIdElementIdMapping(sel) == reference.ids);
+
+    // The same selection with a different block_gap_limit, empty selections and all nodes
+    REQUIRE(pop.get(sel, nonstd::nullopt, nonstd::nullopt, nonstd::nullopt, 4194304).data ==
+            reference.data);
+    REQUIRE(pop.get(Selection({})).ids.empty());
+    REQUIRE(pop.get().ids == pop.getNodeIdElementIdMapping());
+
+    // An iterator stays valid while many other selections are queried
+    auto iterator = pop.iterate(sel, nonstd::nullopt, nonstd::nullopt, 1);
+    for (uint64_t node_id = 0; node_id < 40; ++node_id) {
+        const auto mapping = pop.getNodeIdElementIdMapping(Selection({{node_id, node_id + 1}}));
+        REQUIRE(mapping == pop.get(Selection({{node_id, node_id + 1}})).ids);
+    }
+    size_t row = 0;
+    while (iterator.hasNext()) {
+        const auto frame = iterator.next();
+        REQUIRE(frame.ids == reference.ids);
+        REQUIRE(std::equal(frame.data.begin(),
+                           frame.data.end(),
+                           reference.data.begin() + row * n_cols));
+        ++row;
+    }
+    REQUIRE(row == reference.times.size());
+}
+
+TEST_CASE("ElementReportReader node lookup", "[base]") {
+    const std::string path = "./data/elements-lookup.h5.tmp";
+    const size_t n_nodes = 300;
+    std::mt19937 rng(42);
+
+    // Compact node ids are looked up in a table by id, sparse ones in a hash table
+    for (const uint64_t id_step : {uint64_t{1}, uint64_t{1000003}}) {
+        std::vector<NodeID> nodes(n_nodes);
+        for (size_t i = 0; i < n_nodes; ++i) {
+            nodes[i] = 5 + i * id_step;
+        }
+        std::shuffle(nodes.begin(), nodes.end(), rng);
+
+        // Node i of the mapping has i % 3 + 1 elements
+        std::vector<NodeID> node_ids;
+        std::vector<ElementID> element_ids;
+        std::vector<size_t> first_column(n_nodes);
+        for (size_t i = 0; i < n_nodes; ++i) {
+            first_column[i] = node_ids.size();
+            for (size_t e = 0; e <= i % 3; ++e) {
+                node_ids.push_back(nodes[i]);
+                element_ids.push_back(static_cast<ElementID>(e));
+            }
+        }
+        const size_t n_cols = node_ids.size();
+        std::vector<float> data(2 * n_cols);
+        std::iota(data.begin(), data.end(), 0.f);
+
+        try {
+            {
+                ReportWriter writer(path);
+                writer.addPopulation("All", node_ids, element_ids, std::make_tuple(0., 0.2, 0.1))
+                    .writeFrames(data);
+                writer.close();
+            }
+
+            const ElementReportReader reader(path);
+            const auto& pop = reader.openPopulation("All");
+
+            // Every other node of the report, and ids which aren't in it
+            std::vector<NodeID> selected{0, 4, 6, 5 + n_nodes * id_step};
+            for (size_t i = 0; i < n_nodes; i += 2) {
+                selected.push_back(nodes[i]);
+            }
+            std::sort(selected.begin(), selected.end());
+            const auto frames = pop.get(Selection::fromValues(selected));
+
+            DataFrame<CompartmentID>::DataType ids;
+            std::vector<float> values[2];
+            for (const auto node_id : selected) {
+                const auto it = std::find(nodes.begin(), nodes.end(), node_id);
+                if (it == nodes.end()) {
+                    continue;
+                }
+                const size_t i = static_cast<size_t>(it - nodes.begin());
+                for (size_t e = 0; e <= i % 3; ++e) {
+                    ids.push_back({node_id, e});
+                    for (size_t t = 0; t < 2; ++t) {
+                        values[t].push_back(data[t * n_cols + first_column[i] + e]);
+                    }
+                }
+            }
+            REQUIRE(frames.ids == ids);
+            REQUIRE(frames.times.size() == 2);
+            values[0].insert(values[0].end(), values[1].begin(), values[1].end());
+            REQUIRE(frames.data == values[0]);
+
+            REQUIRE(pop.get(Selection({{0, 5}})).ids.empty());
+            REQUIRE(pop.get().ids.size() == n_cols);
+        } catch (...) {
+            std::remove(path.c_str());
+            throw;
+        }
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ElementReportReader getInto", "[base]") {
+    const ElementReportReader reader("./data/elements.h5");
+    const auto& pop = reader.openPopulation("All");
+
+    DataFrame<CompartmentID> data_frame;
+    ReportReadBuffer buffer;
+    const std::vector<nonstd::optional<Selection>> selections{Selection({{3, 5}}),
+                                                              Selection({{3, 5}, {12, 13}}),
+                                                              nonstd::nullopt};
+    for (const auto& sel : selections) {
+        const auto reference = pop.get(sel, 0.4, 1.6, 2);
+
+        pop.getInto(data_frame, buffer, sel, 0.4, 1.6, 2);
+        CHECK(data_frame.ids == reference.ids);
+        CHECK(data_frame.times == reference.times);
+        CHECK(data_frame.data == reference.data);
+
+        // Polling the same selection reuses the storage
+        const float* const data = data_frame.data.data();
+        pop.getInto(data_frame, buffer, sel, 0.4, 1.6, 2);
+        CHECK(data_frame.data.data() == data);
+        CHECK(data_frame.data == reference.data);
+
+        const size_t n_ids = reference.ids.size();
+        std::vector<float> values((reference.times.size() + 1) * n_ids, -1.f);
+        const size_t n_frames = reference.times.size();
+        CHECK(pop.getInto(values.data(), n_frames + 1, n_ids, buffer, sel, 0.4, 1.6, 2) ==
+              n_frames);
+        CHECK(std::equal(reference.data.begin(), reference.data.end(), values.begin()));
+        CHECK(values.back() == -1.f);
+
+        CHECK_THROWS_AS(pop.getInto(values.data(), 1, n_ids, buffer, sel, 0.4, 1.6, 2),
+                        SonataError);
+        CHECK_THROWS_AS(pop.getInto(values.data(), values.size(), 1, buffer, sel), SonataError);
+    }
+
+    pop.getInto(data_frame, buffer, Selection({}));
+    CHECK(data_frame.ids.empty());
+    CHECK(data_frame.data.empty());
+}
+
+TEST_CASE("ElementReportReader getCompartmentSet", "[base]") {
+    const ElementReportReader reader("./data/elements.h5");
+    const auto& pop = reader.openPopulation("All");
+
+    // Node 3 has sections {5, 5, 6, 6, 7}, node 4 sections {7, 8, 8, 9, 9}
+    const CompartmentSet compartment_set(R"({
+        "population": "All",
+        "compartment_set": [[3, 5, 0.25], [3, 5, 0.75], [3, 7, 0.5], [4, 7, 0.0], [4, 9, 1.0]]
+    })");
+    const auto data = pop.getCompartmentSet(compartment_set, 0.2, 0.4);
+    CHECK(data.ids == DataFrame<CompartmentID>::DataType{{{3, 5}, {3, 5}, {3, 7}, {4, 7}, {4, 9}}});
+    testTimes(data.times, 0.2, 0.2, 2);
+    CHECK(data.data == std::vector<float>{
+                           11.0f, 11.1f, 11.4f, 11.5f, 11.9f, 21.0f, 21.1f, 21.4f, 21.5f, 21.9f});
+
+    // Locations within the same compartment read the same column
+    const CompartmentSet same_compartment(R"({
+        "population": "All",
+        "compartment_set": [[3, 6, 0.1], [3, 6, 0.4], [4, 8, 0.9]]
+    })");
+    const auto same = pop.getCompartmentSet(same_compartment, 0.2, 0.2);
+    CHECK(same.ids == DataFrame<CompartmentID>::DataType{{{3, 6}, {3, 6}, {4, 8}}});
+    CHECK(same.data == std::vector<float>{11.2f, 11.2f, 11.7f});
+
+    // Same values as `get`, with a stride
+    const auto reference = pop.get(Selection({{3, 5}}), 0.2, 3.0, 3);
+    const auto strided = pop.getCompartmentSet(compartment_set, 0.2, 3.0, 3);
+    const std::vector<size_t> columns{0, 1, 4, 5, 9};
+    REQUIRE(strided.times == reference.times);
+    for (size_t t = 0; t < reference.times.size(); ++t) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            CHECK(strided.data[t * columns.size() + i] ==
+                  reference.data[t * reference.ids.size() + columns[i]]);
+        }
+    }
+
+    const CompartmentSet empty(R"({"population": "All", "compartment_set": []})");
+    CHECK(pop.getCompartmentSet(empty).ids.empty());
+
+    const CompartmentSet missing_section(
+        R"({"population": "All", "compartment_set": [[3, 8, 0.5]]})");
+    CHECK_THROWS_AS(pop.getCompartmentSet(missing_section), SonataError);
+    const CompartmentSet missing_node(
+        R"({"population": "All", "compartment_set": [[424242, 0, 0.5]]})");
+    CHECK_THROWS_AS(pop.getCompartmentSet(missing_node), SonataError);
+    // Same nodes and sections, of another population
+    const CompartmentSet other_population(
+        R"({"population": "Other", "compartment_set": [[3, 5, 0.25]]})");
+    CHECK_THROWS_AS(pop.getCompartmentSet(other_population), SonataError);
+}
+
+TEST_CASE("ElementReportReader chunked", "[base]") {
+    const std::string path = "./data/elements-chunked.h5.tmp";
+    const size_t n_elements = 3;
+    writeElementReport(path, 50, n_elements, 40, {8, 16});
+
+    const auto expected = [&](const Selection& selection, size_t start, size_t stride) {
+        std::vector<float> values;
+        for (size_t t = start; t < 40; t += stride) {
+            for (const auto node_id : selection.flatten()) {
+                for (size_t e = 0; e < n_elements; ++e) {
+                    const size_t i = (node_id - 1) * n_elements + e;
+                    values.push_back(static_cast<float>(t) + static_cast<float>(i) / 1000.f);
+                }
+            }
+        }
+        return values;
+    };
+
+    try {
+        const ElementReportReader reader(path);
+        const auto& pop = reader.openPopulation("All");
+
+        const auto sel = Selection({{2, 4}, {6, 7}, {30, 45}});
+        REQUIRE(pop.get(sel).data == expected(sel, 0, 1));
+        REQUIRE(pop.get(sel, 0.5, nonstd::nullopt, 3).data == expected(sel, 5, 3));
+        for (size_t max_read_size : {size_t(1), size_t(200), size_t(10000)}) {
+            REQUIRE(pop.get(sel,
+                            nonstd::nullopt,
+                            nonstd::nullopt,
+                            1,
+                            nonstd::nullopt,
+                            max_read_size)
+                        .data == expected(sel, 0, 1));
+            REQUIRE(pop.get(sel, 0.3, nonstd::nullopt, 7, nonstd::nullopt, max_read_size).data ==
+                    expected(sel, 3, 7));
+        }
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ElementReportReader chunk reads", "[base]") {
+    const std::string path = "./data/elements-chunk-reads.h5.tmp";
+    const size_t n_frames = 64;
+    const size_t n_cols = 40000;
+    writeElementReport(path, n_cols / 2, 2, n_frames);
+
+    // 4 x 2 chunks of 16 frames by 20000 elements, of 1.28MB: more than the chunk cache of HDF5,
+    // so that each read of a chunk decodes it
+    const auto values = rewriteCountedData(path, {16, 20000});
+
+    try {
+        const ElementReportReader reader(path);
+        const auto& pop = reader.openPopulation("All");
+        const auto read = [&](size_t max_read_size) {
+            decoded_chunks = 0;
+            const auto data = pop.get(nonstd::nullopt,
+                                      nonstd::nullopt,
+                                      nonstd::nullopt,
+                                      1,
+                                      nonstd::nullopt,
+                                      max_read_size)
+                                  .data;
+            CHECK(data == values);
+            return decoded_chunks;
+        };
+        const size_t frame_size = n_cols * sizeof(float);
+
+        // Each chunk is read once
+        CHECK(read(64 * frame_size) == 8);
+        // Tiles of up to 24 frames end on the chunk boundaries, e.g. [0, 16) rather than [0, 24)
+        CHECK(read(24 * frame_size) == 8);
+        // Tiles of 4 frames, within `max_read_size`, even if they read each chunk 4 times
+        CHECK(read(4 * frame_size) == 32);
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ElementReportReader parallel", "[base]") {
+    const std::string path = "./data/elements-parallel.h5.tmp";
+    const std::string path_chunked = "./data/elements-parallel-chunked.h5.tmp";
+    writeElementReport(path, 50, 3, 40);
+    writeElementReport(path_chunked, 50, 3, 40, {8, 16});
+
+    try {
+        // Contiguous reports are read with pread, chunked ones fall back to HDF5
+        for (const auto& filename : {path, path_chunked}) {
+            const ElementReportReader serial_reader(filename);
+            const ElementReportReader parallel_reader(filename, 4);
+            const auto& serial = serial_reader.openPopulation("All");
+            const auto& parallel = parallel_reader.openPopulation("All");
+
+            for (const auto& sel : {Selection({{1, 51}}),
+                                    Selection({{2, 4}, {6, 7}, {30, 45}}),
+                                    Selection({{17, 18}})}) {
+                const auto reference = serial.get(sel);
+                const auto data = parallel.get(sel);
+                REQUIRE(data.ids == reference.ids);
+                REQUIRE(data.times == reference.times);
+                REQUIRE(data.data == reference.data);
+
+                REQUIRE(parallel.get(sel, 0.3, 3.5, 3).data == serial.get(sel, 0.3, 3.5, 3).data);
+                for (size_t max_read_size : {size_t(1), size_t(200)}) {
+                    REQUIRE(parallel.get(sel,
+                                         nonstd::nullopt,
+                                         nonstd::nullopt,
+                                         2,
+                                         nonstd::nullopt,
+                                         max_read_size)
+                                .data == serial.get(sel, nonstd::nullopt, nonstd::nullopt, 2).data);
+                }
+            }
+            REQUIRE(parallel.get(Selection({{100, 101}})).ids.empty());
+        }
+
+        {
+            // Opened by a relative path, the file is read even after the working directory changes
+            namespace fs = ghc::filesystem;
+            const ElementReportReader serial_reader(path);
+            const ElementReportReader parallel_reader(path, 4);
+            const auto reference = serial_reader.openPopulation("All").get();
+            const auto& parallel = parallel_reader.openPopulation("All");
+
+            const auto cwd = fs::current_path();
+            fs::current_path(cwd.parent_path());
+            DataFrame<CompartmentID> data;
+            try {
+                data = parallel.get();
+            } catch (...) {
+                fs::current_path(cwd);
+                throw;
+            }
+            fs::current_path(cwd);
+            CHECK(data.data == reference.data);
+        }
+    } catch (...) {
+        std::remove(path.c_str());
+        std::remove(path_chunked.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+    std::remove(path_chunked.c_str());
+}
+
+TEST_CASE("ElementReportReader reductions", "[base]") {
+    const std::string path = "./data/elements-reductions.h5.tmp";
+    const size_t n_elements = 11;
+    writeElementReport(path, 20, n_elements, 30, {4, 16});
+
+    // Reduce `count` values, `stride` apart from `begin`
+    const auto reduce = [](const std::vector<float>& values,
+                           size_t begin,
+                           size_t count,
+                           size_t stride,
+                           ReportReduction reduction) {
+        std::vector<double> group;
+        for (size_t i = 0; i < count; ++i) {
+            group.push_back(values[begin + i * stride]);
+        }
+        switch (reduction) {
+        case ReportReduction::min:
+            return *std::min_element(group.begin(), group.end());
+        case ReportReduction::max:
+            return *std::max_element(group.begin(), group.end());
+        case ReportReduction::sum:
+            return std::accumulate(group.begin(), group.end(), 0.);
+        default:
+            return std::accumulate(group.begin(), group.end(), 0.) / count;
+        }
+    };
+
+    try {
+        for (const size_t n_threads : {1, 3}) {
+            const ElementReportReader reader(path, n_threads);
+            const auto& pop = reader.openPopulation("All");
+            const auto sel = Selection({{5, 7}, {2, 3}, {15, 21}});
+
+            for (const auto reduction : {ReportReduction::sum,
+                                         ReportReduction::mean,
+                                         ReportReduction::min,
+                                         ReportReduction::max}) {
+                const auto frames = pop.get(sel, 0.4, 2.5, 2);
+                const size_t n_frames = frames.times.size();
+                const size_t n_cols = frames.ids.size();
+
+                const auto by_node = pop.getReducedByNode(sel, 0.4, 2.5, reduction, 2);
+                CHECK(by_node.times == frames.times);
+                REQUIRE(by_node.ids == std::vector<NodeID>{5, 6, 2, 15, 16, 17, 18, 19, 20});
+                REQUIRE(by_node.data.size() == n_frames * by_node.ids.size());
+                for (size_t t = 0; t < n_frames; ++t) {
+                    for (size_t i = 0; i < by_node.ids.size(); ++i) {
+                        const auto expected = reduce(
+                            frames.data, t * n_cols + i * n_elements, n_elements, 1, reduction);
+                        CHECK(by_node.data[t * by_node.ids.size() + i] ==
+                              Catch::Approx(expected).epsilon(1e-5));
+                    }
+                }
+
+                const size_t window = 4;
+                const auto by_window = pop.getReducedByWindow(window, sel, 0.4, 2.5, reduction, 2);
+                CHECK(by_window.ids == frames.ids);
+                const size_t n_windows = (n_frames + window - 1) / window;
+                REQUIRE(by_window.times.size() == n_windows);
+                REQUIRE(by_window.data.size() == n_windows * n_cols);
+                for (size_t w = 0; w < n_windows; ++w) {
+                    CHECK(by_window.times[w] == frames.times[w * window]);
+                    const size_t count = std::min(window, n_frames - w * window);
+                    for (size_t i = 0; i < n_cols; ++i) {
+                        const auto expected =
+                            reduce(frames.data, w * window * n_cols + i, count, n_cols, reduction);
+                        CHECK(by_window.data[w * n_cols + i] ==
+                              Catch::Approx(expected).epsilon(1e-5));
+                    }
+                }
+            }
+
+            CHECK(pop.getReducedByNode(Selection({{100, 101}})).data.empty());
+            CHECK_THROWS_AS(pop.getReducedByWindow(0), SonataError);
+        }
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ReportWriter", "[base]") {
+    using ChunkShape = ReportWriter::ChunkShape;
+    const std::string path = "./data/elements-written.h5.tmp";
+    const size_t n_frames = 10;
+    // Node 3 with 2 elements, node 1 with 3 and node 2 with 1
+    const std::vector<NodeID> node_ids{3, 3, 1, 1, 1, 2};
+    const std::vector<ElementID> element_ids{0, 1, 0, 1, 2, 0};
+    const size_t n_cols = node_ids.size();
+    std::vector<float> data(n_frames * n_cols);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<float>(i) / 10.f;
+    }
+
+    const std::vector<std::pair<ChunkShape, unsigned>> layouts{{ChunkShape::contiguous, 0},
+                                                               {ChunkShape::time_major, 0},
+                                                               {ChunkShape::element_major, 4},
+                                                               {ChunkShape::balanced, 4}};
+    for (const auto& layout : layouts) {
+        {
+            ReportWriter writer(path);
+            auto& population = writer.addPopulation("All",
+                                                    node_ids,
+                                                    element_ids,
+                                                    std::make_tuple(0., 1., 0.1),
+                                                    "ms",
+                                                    "mV",
+                                                    layout.first,
+                                                    /* chunkSize */ 8,
+                                                    layout.second);
+            CHECK(population.getFrameCount() == n_frames);
+            CHECK(population.getElementCount() == n_cols);
+            CHECK(&writer.getPopulation("All") == &population);
+
+            // Uneven batches, not aligned on the chunks
+            population.writeFrames(data.data(), 3);
+            population.writeFrames(std::vector<float>(data.begin() + 3 * n_cols,
+                                                      data.begin() + 4 * n_cols));
+            population.writeFrames(data.data() + 4 * n_cols, n_frames - 4);
+            CHECK(population.getWrittenFrameCount() == n_frames);
+            CHECK_THROWS_AS(population.writeFrames(data.data(), 1), SonataError);
+            writer.close();
+        }
+
+        const ElementReportReader reader(path);
+        const auto& population = reader.openPopulation("All");
+        CHECK(population.getTimes() == std::make_tuple(0., 1., 0.1));
+        CHECK(population.getTimeUnits() == "ms");
+        CHECK(population.getDataUnits() == "mV");
+        CHECK_FALSE(population.getSorted());
+        CHECK(population.getNodeIds() == std::vector<NodeID>{3, 1, 2});
+
+        const auto frames = population.get(Selection({{3, 4}}), 0.2, 0.4);
+        CHECK(frames.ids == DataFrame<CompartmentID>::DataType{{3, 0}, {3, 1}});
+        REQUIRE(frames.times.size() == 3);
+        for (size_t t = 0; t < 3; ++t) {
+            CHECK(frames.data[2 * t] == data[(t + 2) * n_cols]);
+            CHECK(frames.data[2 * t + 1] == data[(t + 2) * n_cols + 1]);
+        }
+
+        const auto all = population.get(Selection({{1, 4}}));
+        REQUIRE(all.data.size() == data.size());
+        // Node 1 comes first when read
+        CHECK(all.data[0] == data[2]);
+        CHECK(all.data[5] == data[1]);
+    }
+
+    {
+        const auto times = std::make_tuple(0., 1., 0.1);
+        ReportWriter writer(path);
+        CHECK_THROWS_AS(writer.addPopulation("All", {1, 2, 1}, {0, 0, 1}, times), SonataError);
+        CHECK_THROWS_AS(writer.addPopulation("All", {1}, {0, 1}, times), SonataError);
+        CHECK_THROWS_AS(writer.addPopulation("All",
+                                             {1},
+                                             {0},
+                                             times,
+                                             "ms",
+                                             "mV",
+                                             ChunkShape::contiguous,
+                                             /* chunkSize */ 8,
+                                             /* compressionLevel */ 4),
+                        SonataError);
+
+        auto& population = writer.addPopulation("All", {1, 2}, {0, 0}, times);
+        CHECK_THROWS_AS(writer.addPopulation("All", {1}, {0}, times), SonataError);
+        CHECK_THROWS_AS(writer.getPopulation("no-such-population"), SonataError);
+        CHECK_THROWS_AS(population.writeFrames(std::vector<float>{1.f, 2.f, 3.f}), SonataError);
+        population.writeFrames(std::vector<float>{1.f, 2.f});
+        CHECK_THROWS_AS(writer.close(), SonataError);
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ReportWriter buffer bound", "[base]") {
+    using ChunkShape = ReportWriter::ChunkShape;
+    const std::string path = "./data/elements-wide.h5.tmp";
+    // 2^16 nodes of 4 elements: 1MB per frame
+    const size_t n_cols = size_t(1) << 18;
+    std::vector<NodeID> node_ids(n_cols);
+    std::vector<ElementID> element_ids(n_cols);
+    for (size_t i = 0; i < n_cols; ++i) {
+        node_ids[i] = i / 4;
+        element_ids[i] = static_cast<ElementID>(i % 4);
+    }
+
+    // The frames of a row of chunks are buffered: whatever the shape, at most 64MB of them
+    for (const auto shape :
+         {ChunkShape::time_major, ChunkShape::element_major, ChunkShape::balanced}) {
+        {
+            ReportWriter writer(path);
+            writer.addPopulation("All",
+                                 node_ids,
+                                 element_ids,
+                                 std::make_tuple(0., 100., 0.1),
+                                 "ms",
+                                 "mV",
+                                 shape,
+                                 /* chunkSize */ 262144);
+            CHECK_THROWS_AS(writer.close(), SonataError);
+        }
+
+        HighFive::File file(path, HighFive::File::ReadOnly);
+        const auto data = file.getDataSet("/report/All/data");
+        const hid_t plist = H5Dget_create_plist(data.getId());
+        hsize_t dims[2] = {0, 0};
+        REQUIRE(H5Pget_chunk(plist, 2, dims) == 2);
+        H5Pclose(plist);
+        CHECK(dims[0] >= 1);
+        CHECK(dims[0] * n_cols * sizeof(float) <= size_t(1) << 26);
+        CHECK(dims[0] * dims[1] <= 262144);
+        if (shape == ChunkShape::element_major) {
+            CHECK(dims[0] == 64);
+        }
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ReportWriter encodings", "[base]") {
+    using ChunkShape = ReportWriter::ChunkShape;
+    const std::string path = "./data/elements-encoded.h5.tmp";
+    const size_t n_nodes = 20;
+    const size_t n_elements = 3;
+    const size_t n_frames = 200;
+    const size_t n_cols = n_nodes * n_elements;
+    std::vector<NodeID> node_ids(n_cols);
+    std::vector<ElementID> element_ids(n_cols);
+    for (size_t i = 0; i < n_cols; ++i) {
+        node_ids[i] = static_cast<NodeID>(i / n_elements + 1);
+        element_ids[i] = static_cast<ElementID>(i % n_elements);
+    }
+    // Potentials between -80mV and 40mV
+    std::vector<float> data(n_frames * n_cols);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = -80.f + static_cast<float>((i * 37) % 1201) / 10.f;
+    }
+    data[5] = 0.f;
+    data[6] = -0.f;
+
+    const auto write = [&](ReportEncoding encoding, ChunkShape chunkShape, unsigned compression) {
+        ReportWriter writer(path);
+        writer
+            .addPopulation("All",
+                           node_ids,
+                           element_ids,
+                           std::make_tuple(0., 0.1 * n_frames, 0.1),
+                           "ms",
+                           "mV",
+                           chunkShape,
+                           /* chunkSize */ 256,
+                           compression,
+                           encoding,
+                           /* scaleFactor */ 0.005f,
+                           /* addOffset */ -20.f)
+            .writeFrames(data);
+        writer.close();
+    };
+    const auto check = [&](const std::vector<float>& values,
+                           const Selection& sel,
+                           size_t start,
+                           size_t stride,
+                           float tolerance) {
+        size_t k = 0;
+        for (size_t t = start; t < n_frames; t += stride) {
+            for (const auto node_id : sel.flatten()) {
+                for (size_t e = 0; e < n_elements; ++e) {
+                    REQUIRE(k < values.size());
+                    const float expected = data[t * n_cols + (node_id - 1) * n_elements + e];
+                    REQUIRE(std::abs(values[k++] - expected) <=
+                            tolerance * std::max(1.f, std::abs(expected)));
+                }
+            }
+        }
+        REQUIRE(k == values.size());
+    };
+
+    // float16 is accurate to half a unit of its 11 bits mantissa; int16 to half of scaleFactor
+    const std::vector<std::tuple<ReportEncoding, ChunkShape, unsigned, float>> layouts{
+        {ReportEncoding::float16, ChunkShape::contiguous, 0, 1.f / 2048.f},
+        {ReportEncoding::float16, ChunkShape::balanced, 4, 1.f / 2048.f},
+        {ReportEncoding::int16, ChunkShape::contiguous, 0, 0.0025f},
+        {ReportEncoding::int16, ChunkShape::time_major, 4, 0.0025f}};
+
+    try {
+        for (const auto& layout : layouts) {
+            write(std::get<0>(layout), std::get<1>(layout), std::get<2>(layout));
+            const float tolerance = std::get<3>(layout);
+
+            {
+                // Contiguous reports are read with pread by several threads
+                const ElementReportReader serial_reader(path);
+                const ElementReportReader parallel_reader(path, 4);
+                const auto& serial = serial_reader.openPopulation("All");
+                const auto& parallel = parallel_reader.openPopulation("All");
+                for (const auto& sel : {Selection({{1, 21}}),
+                                        Selection({{2, 4}, {6, 7}, {15, 19}}),
+                                        Selection({{17, 18}})}) {
+                    const auto frames = serial.get(sel);
+                    check(frames.data, sel, 0, 1, tolerance);
+                    REQUIRE(parallel.get(sel).data == frames.data);
+                    check(serial.get(sel, 0.5, nonstd::nullopt, 3).data, sel, 5, 3, tolerance);
+                    check(serial.get(sel,
+                                     nonstd::nullopt,
+                                     nonstd::nullopt,
+                                     7,
+                                     nonstd::nullopt,
+                                     /* max_read_size */ 1)
+                              .data,
+                          sel,
+                          0,
+                          7,
+                          tolerance);
+
+                    std::vector<float> values;
+                    auto it = serial.iterate(sel, nonstd::nullopt, nonstd::nullopt, 30);
+                    while (it.hasNext()) {
+                        const auto block = it.next();
+                        values.insert(values.end(), block.data.begin(), block.data.end());
+                    }
+                    REQUIRE(values == frames.data);
+                }
+                // Zeros keep their sign in float16
+                if (std::get<0>(layout) == ReportEncoding::float16) {
+                    const auto first = serial.get(Selection({{2, 4}}), 0., 0.).data;
+                    CHECK(first[2] == 0.f);
+                    CHECK_FALSE(std::signbit(first[2]));
+                    CHECK(first[3] == 0.f);
+                    CHECK(std::signbit(first[3]));
+                }
+            }
+
+            // The transposed copy and the summary pyramid are written decoded
+            ReportWriter::writeTransposedData(path, "All", 16, 64);
+            ReportWriter::writeSummaryPyramid(path, "All");
+            const ElementReportReader reader(path);
+            const auto& pop = reader.openPopulation("All");
+            REQUIRE(pop.hasTransposedData());
+            const auto sel = Selection({{17, 18}});
+            check(pop.get(sel).data, sel, 0, 1, tolerance);
+
+            const auto summary = pop.getSummary(0.2, sel);
+            REQUIRE(summary.window == 2);
+            for (size_t r = 0; r < summary.times.size(); ++r) {
+                for (size_t c = 0; c < n_elements; ++c) {
+                    const size_t i = 16 * n_elements + c;
+                    const float a = data[2 * r * n_cols + i];
+                    const float b = data[(2 * r + 1) * n_cols + i];
+                    const float margin = tolerance * std::max(std::abs(a), std::abs(b)) + 0.01f;
+                    CHECK(summary.min[r * n_elements + c] ==
+                          Catch::Approx(std::min(a, b)).margin(margin));
+                    CHECK(summary.max[r * n_elements + c] ==
+                          Catch::Approx(std::max(a, b)).margin(margin));
+                }
+            }
+        }
+
+        {
+            // int16 values are clamped, and need a scale factor
+            ReportWriter writer(path);
+            CHECK_THROWS_AS(writer.addPopulation("All",
+                                                 {1},
+                                                 {0},
+                                                 std::make_tuple(0., 0.2, 0.1),
+                                                 "ms",
+                                                 "mV",
+                                                 ChunkShape::contiguous,
+                                                 /* chunkSize */ 8,
+                                                 /* compressionLevel */ 0,
+                                                 ReportEncoding::int16,
+                                                 /* scaleFactor */ 0.f),
+                            SonataError);
+            writer
+                .addPopulation("All",
+                               {1},
+                               {0},
+                               std::make_tuple(0., 0.2, 0.1),
+                               "ms",
+                               "mV",
+                               ChunkShape::contiguous,
+                               /* chunkSize */ 8,
+                               /* compressionLevel */ 0,
+                               ReportEncoding::int16,
+                               /* scaleFactor */ 1.f)
+                .writeFrames(std::vector<float>{1e6f, -1e6f});
+            writer.close();
+        }
+        CHECK(ElementReportReader(path).openPopulation("All").get().data ==
+              std::vector<float>{32767.f, -32768.f});
+
+        {
+            // Other types of 'data' are not supported
+            HighFive::File file(path, HighFive::File::ReadWrite);
+            auto pop = file.getGroup("/report/All");
+            pop.unlink("data");
+            pop.createDataSet("data", std::vector<std::vector<double>>{{1.}, {2.}});
+        }
+        const ElementReportReader reader(path);
+        CHECK_THROWS_AS(reader.openPopulation("All").get(), SonataError);
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ReportWriter::writeTransposedData", "[base]") {
+    const std::string path = "./data/elements-transposed.h5.tmp";
+    const std::string path_negated = "./data/elements-transposed-negated.h5.tmp";
+    const size_t n_nodes = 50;
+    const size_t n_elements = 3;
+    const size_t n_frames = 2000;
+    writeElementReport(path, n_nodes, n_elements, n_frames);
+    writeElementReport(path_negated, n_nodes, n_elements, n_frames);
+
+    const auto expected = [&](const Selection& selection, size_t start, size_t stride) {
+        std::vector<float> values;
+        for (size_t t = start; t < n_frames; t += stride) {
+            for (const auto node_id : selection.flatten()) {
+                for (size_t e = 0; e < n_elements; ++e) {
+                    const size_t i = (node_id - 1) * n_elements + e;
+                    values.push_back(static_cast<float>(t) + static_cast<float>(i) / 1000.f);
+                }
+            }
+        }
+        return values;
+    };
+
+    try {
+        CHECK_FALSE(ElementReportReader(path).openPopulation("All").hasTransposedData());
+
+        ReportWriter::writeTransposedData(path, "All", 16, 256);
+        CHECK_THROWS_AS(ReportWriter::writeTransposedData(path, "All"), SonataError);
+        ReportWriter::writeTransposedData(path,
+                                          "All",
+                                          /* elementsPerChunk */ 16,
+                                          /* framesPerChunk */ 256,
+                                          /* compressionLevel */ 4,
+                                          /* overwrite */ true);
+
+        {
+            const ElementReportReader reader(path);
+            const auto& pop = reader.openPopulation("All");
+            CHECK(pop.hasTransposedData());
+
+            for (const auto& sel : {Selection({{17, 18}}),
+                                    Selection({{2, 4}, {6, 7}, {30, 45}}),
+                                    Selection({{1, 51}})}) {
+                REQUIRE(pop.get(sel).data == expected(sel, 0, 1));
+                REQUIRE(pop.get(sel, 0.5, nonstd::nullopt, 3).data == expected(sel, 5, 3));
+                for (size_t max_read_size : {size_t(1), size_t(200)}) {
+                    REQUIRE(pop.get(sel,
+                                    nonstd::nullopt,
+                                    nonstd::nullopt,
+                                    7,
+                                    nonstd::nullopt,
+                                    max_read_size)
+                                .data == expected(sel, 0, 7));
+                }
+
+                std::vector<float> data;
+                auto it = pop.iterate(sel, nonstd::nullopt, nonstd::nullopt, 300);
+                while (it.hasNext()) {
+                    const auto frames = it.next();
+                    data.insert(data.end(), frames.data.begin(), frames.data.end());
+                }
+                REQUIRE(data == expected(sel, 0, 1));
+            }
+        }
+
+        ReportWriter::writeTransposedData(path_negated, "All");
+        {
+            // Negated transposed data, to tell which dataset is read, written in place so that
+            // its fingerprint of 'data' still matches
+            HighFive::File file(path_negated, HighFive::File::ReadWrite);
+            auto pop = file.getGroup("/report/All");
+            const size_t n_cols = n_nodes * n_elements;
+            std::vector<float> transposed(n_cols * n_frames);
+            for (size_t i = 0; i < n_cols; ++i) {
+                for (size_t t = 0; t < n_frames; ++t) {
+                    transposed[i * n_frames + t] =
+                        -(static_cast<float>(t) + static_cast<float>(i) / 1000.f);
+                }
+            }
+            pop.getDataSet("data_transposed").write_raw(transposed.data());
+        }
+
+        {
+            const ElementReportReader reader(path_negated);
+            const auto& pop = reader.openPopulation("All");
+            REQUIRE(pop.hasTransposedData());
+
+            // The long trace of a node is read from 'data_transposed'
+            const auto trace = pop.get(Selection({{17, 18}})).data;
+            auto negated = expected(Selection({{17, 18}}), 0, 1);
+            for (auto& value : negated) {
+                value = -value;
+            }
+            CHECK(trace == negated);
+
+            // A few frames of all the nodes are read from 'data'
+            const auto frames = pop.get(Selection({{1, 51}}), 0.0, 0.2).data;
+            auto all = expected(Selection({{1, 51}}), 0, 1);
+            all.resize(3 * n_nodes * n_elements);
+            CHECK(frames == all);
+        }
+
+        {
+            // 'data' written anew, with the same shape: the transposed data is outdated
+            HighFive::File file(path_negated, HighFive::File::ReadWrite);
+            file.getDataSet("/report/All/data").getAttribute("generation").write(uint64_t{43});
+        }
+        {
+            const ElementReportReader reader(path_negated);
+            const auto& pop = reader.openPopulation("All");
+            CHECK_FALSE(pop.hasTransposedData());
+            CHECK(pop.get(Selection({{17, 18}})).data == expected(Selection({{17, 18}}), 0, 1));
+        }
+
+        {
+            // 'data' written in place, keeping its generation, shape and header
+            HighFive::File file(path, HighFive::File::ReadWrite);
+            auto data = file.getDataSet("/report/All/data");
+            std::vector<float> values(n_frames * n_nodes * n_elements);
+            data.read_raw(values.data());
+            for (auto& value : values) {
+                value += 1.f;
+            }
+            data.write_raw(values.data());
+        }
+        {
+            const ElementReportReader reader(path);
+            const auto& pop = reader.openPopulation("All");
+            CHECK_FALSE(pop.hasTransposedData());
+            auto shifted = expected(Selection({{17, 18}}), 0, 1);
+            for (auto& value : shifted) {
+                value += 1.f;
+            }
+            CHECK(pop.get(Selection({{17, 18}})).data == shifted);
+        }
+        ReportWriter::writeTransposedData(path, "All", 16, 256, 0, /* overwrite */ true);
+        CHECK(ElementReportReader(path).openPopulation("All").hasTransposedData());
+
+        {
+            // 'data' replaced by a dataset without generation: the transposed data is outdated
+            HighFive::File file(path, HighFive::File::ReadWrite);
+            auto pop = file.getGroup("/report/All");
+            std::vector<float> values(n_frames * n_nodes * n_elements);
+            pop.getDataSet("data").read_raw(values.data());
+            pop.unlink("data");
+            auto data = pop.createDataSet<float>(
+                "data", HighFive::DataSpace({n_frames, n_nodes * n_elements}));
+            data.write_raw(values.data());
+            data.createAttribute("units", std::string("mV"));
+        }
+        CHECK_FALSE(ElementReportReader(path).openPopulation("All").hasTransposedData());
+    } catch (...) {
+        std::remove(path.c_str());
+        std::remove(path_negated.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+    std::remove(path_negated.c_str());
+}
+
+TEST_CASE("ReportWriter::writeSummaryPyramid", "[base]") {
+    const std::string path = "./data/elements-summary.h5.tmp";
+    const size_t n_nodes = 10;
+    const size_t n_elements = 2;
+    const size_t n_frames = 1000;
+    writeElementReport(path, n_nodes, n_elements, n_frames);
+
+    // The values of `writeElementReport` increase with time, by one per frame
+    const auto check = [&](const ReportSummary<CompartmentID>& summary, const Selection& sel) {
+        const size_t n_cols = summary.ids.size();
+        REQUIRE(n_cols == sel.flatSize() * n_elements);
+        REQUIRE(summary.min.size() == summary.times.size() * n_cols);
+        REQUIRE(summary.max.size() == summary.min.size());
+        REQUIRE(summary.mean.size() == summary.min.size());
+        const size_t first_row = static_cast<size_t>(summary.times[0] * 10. + 0.5) /
+                                 summary.window;
+        for (size_t r = 0; r < summary.times.size(); ++r) {
+            const size_t first = (first_row + r) * summary.window;
+            const size_t last = std::min(first + summary.window, n_frames) - 1;
+            CHECK(summary.times[r] == Catch::Approx(0.1 * first));
+            for (size_t c = 0; c < n_cols; ++c) {
+                const auto i = (summary.ids[c][0] - 1) * n_elements + summary.ids[c][1];
+                const float offset = static_cast<float>(i) / 1000.f;
+                const size_t index = r * n_cols + c;
+                CHECK(summary.min[index] == Catch::Approx(first + offset).margin(1e-3));
+                CHECK(summary.max[index] == Catch::Approx(last + offset).margin(1e-3));
+                CHECK(summary.mean[index] ==
+                      Catch::Approx((first + last) / 2. + offset).margin(1e-3));
+            }
+        }
+    };
+
+    try {
+        {
+            // Without a summary pyramid, the values of each timestep
+            const ElementReportReader reader(path);
+            const auto& pop = reader.openPopulation("All");
+            CHECK(pop.getSummaryWindows().empty());
+            const auto summary = pop.getSummary(10., Selection({{3, 5}}), 1.0, 2.0);
+            CHECK(summary.window == 1);
+            CHECK(summary.min == pop.get(Selection({{3, 5}}), 1.0, 2.0).data);
+            CHECK(summary.max == summary.min);
+            CHECK(summary.mean == summary.min);
+        }
+
+        ReportWriter::writeSummaryPyramid(path, "All");
+        CHECK_THROWS_AS(ReportWriter::writeSummaryPyramid(path, "All"), SonataError);
+        ReportWriter::writeSummaryPyramid(path,
+                                          "All",
+                                          /* compressionLevel */ 4,
+                                          /* overwrite */ true);
+
+        {
+            const ElementReportReader reader(path);
+            const auto& pop = reader.openPopulation("All");
+            CHECK(pop.getSummaryWindows() ==
+                  std::vector<size_t>{2, 4, 8, 16, 32, 64, 128, 256, 512, 1024});
+
+            for (const auto& sel : {Selection({{3, 5}}), Selection({{1, 2}, {6, 11}})}) {
+                // Windows of 8 timesteps, covering [10.05, 50.]
+                const auto summary = pop.getSummary(1.0, sel, 10.05, 50.);
+                CHECK(summary.window == 8);
+                CHECK(summary.times.size() == 51);
+                check(summary, sel);
+
+                // A single window, cut short
+                const auto overview = pop.getSummary(1000., sel);
+                CHECK(overview.window == 1024);
+                CHECK(overview.times.size() == 1);
+                check(overview, sel);
+
+                const auto detailed = pop.getSummary(0.1, sel, 0.0, 1.0);
+                CHECK(detailed.window == 1);
+                check(detailed, sel);
+            }
+
+            CHECK(pop.getSummary(1.0, Selection({{100, 101}})).min.empty());
+        }
+
+        {
+            // 'data' written in place, keeping its generation: the pyramid is outdated
+            HighFive::File file(path, HighFive::File::ReadWrite);
+            auto data = file.getDataSet("/report/All/data");
+            std::vector<float> values(n_frames * n_nodes * n_elements);
+            data.read_raw(values.data());
+            for (auto& value : values) {
+                value = -value;
+            }
+            data.write_raw(values.data());
+        }
+        CHECK(ElementReportReader(path).openPopulation("All").getSummaryWindows().empty());
+        ReportWriter::writeSummaryPyramid(path, "All", 0, /* overwrite */ true);
+        CHECK_FALSE(ElementReportReader(path).openPopulation("All").getSummaryWindows().empty());
+
+        {
+            // 'data' written anew, with the same shape: the pyramid is outdated
+            HighFive::File file(path, HighFive::File::ReadWrite);
+            file.getDataSet("/report/All/data").getAttribute("generation").write(uint64_t{43});
+        }
+        const ElementReportReader reader(path);
+        const auto& pop = reader.openPopulation("All");
+        CHECK(pop.getSummaryWindows().empty());
+        CHECK(pop.getSummary(10., Selection({{3, 5}}), 1.0, 2.0).window == 1);
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ReportWriter::writeNodeIndex", "[base]") {
+    const std::string path = "./data/elements-node-index.h5.tmp";
+    // Node 3 with 2 elements, node 1 with 3 and node 2 with 1
+    const std::vector<NodeID> node_ids{3, 3, 1, 1, 1, 2};
+    const std::vector<ElementID> element_ids{0, 1, 0, 1, 2, 0};
+    const size_t n_cols = node_ids.size();
+    std::vector<float> data(10 * n_cols);
+    std::iota(data.begin(), data.end(), 0.f);
+
+    const auto read = [&]() {
+        const ElementReportReader reader(path);
+        return reader.openPopulation("All").get(Selection({{1, 3}}), 0.25, 0.55);
+    };
+    const auto readNodeIndex = [&]() {
+        HighFive::File file(path, HighFive::File::ReadOnly);
+        std::vector<uint64_t> node_index;
+        file.getDataSet("/report/All/mapping/node_index").read(node_index);
+        return node_index;
+    };
+
+    try {
+        {
+            ReportWriter writer(path);
+            writer.addPopulation("All", node_ids, element_ids, std::make_tuple(0., 1., 0.1))
+                .writeFrames(data);
+            writer.close();
+        }
+        // Written along with the unsorted node ids
+        CHECK(readNodeIndex() == std::vector<uint64_t>{1, 2, 0});
+
+        const auto expected = read();
+        CHECK(expected.ids == DataFrame<CompartmentID>::DataType{{1, 0}, {1, 1}, {1, 2}, {2, 0}});
+        REQUIRE(expected.times.size() == 3);
+        CHECK(expected.times[0] == Catch::Approx(0.3));
+        CHECK(expected.times[2] == Catch::Approx(0.5));
+        for (size_t t = 0; t < 3; ++t) {
+            for (size_t i = 0; i < 4; ++i) {
+                CHECK(expected.data[t * 4 + i] == data[(t + 3) * n_cols + 2 + i]);
+            }
+        }
+
+        CHECK_THROWS_AS(ReportWriter::writeNodeIndex(path, "All"), SonataError);
+        ReportWriter::writeNodeIndex(path, "All", /* overwrite */ true);
+        CHECK(readNodeIndex() == std::vector<uint64_t>{1, 2, 0});
+        CHECK(read().data == expected.data);
+
+        {
+            // An index which doesn't sort the node ids is ignored
+            HighFive::File file(path, HighFive::File::ReadWrite);
+            auto mapping = file.getGroup("/report/All/mapping");
+            mapping.unlink("node_index");
+            mapping.createDataSet("node_index", std::vector<uint64_t>{0, 1, 2});
+        }
+        const auto unsorted = read();
+        CHECK(unsorted.ids == expected.ids);
+        CHECK(unsorted.data == expected.data);
+    } catch (...) {
+        std::remove(path.c_str());
+        throw;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("ElementReportReader read throughput", "[.benchmark]") {
+    const std::string path = "./data/elements-benchmark.h5.tmp";
+    const std::string path_counted = "./data/elements-benchmark-counted.h5.tmp";
+    const size_t n_nodes = 1000;
+    const size_t n_elements = 4;
+    const size_t n_frames = 2000;
+    writeElementReport(path, n_nodes, n_elements, n_frames);
+    writeElementReport(path_counted, n_nodes, n_elements, n_frames);
+
+    const auto selection = Selection({{1, n_nodes + 1}});
+    const size_t frame_size = n_nodes * n_elements * sizeof(float);
+
+    {
+        // The reads counted on a copy in chunks of 100 frames, of 1.6MB: more than the chunk
+        // cache of HDF5, so that each read of a chunk decodes it. A single block covers the
+        // selection: each read of a timestep decodes its chunk, while the reads of the default
+        // `max_read_size`, of floor(max_read_size / frame_size) frames cut at chunk boundaries,
+        // decode each chunk once
+        rewriteCountedData(path_counted, {100, n_nodes * n_elements});
+        const ElementReportReader reader(path_counted);
+        const auto& pop = reader.openPopulation("All");
+
+        decoded_chunks = 0;
+        pop.get(selection,
+                nonstd::nullopt,
+                nonstd::nullopt,
+                nonstd::nullopt,
+                nonstd::nullopt,
+                frame_size);
+        WARN("Chunks decoded with one timestep per read: " << decoded_chunks);
+
+        decoded_chunks = 0;
+        pop.get(selection);
+        WARN("Chunks decoded with the default read size: " << decoded_chunks);
+    }
+
+    {
+        const ElementReportReader reader(path);
+        const auto& pop = reader.openPopulation("All");
+        WARN("Bytes per query: " << n_frames * frame_size);
+
+        BENCHMARK("one timestep per read") {
+            return pop.get(selection,
+                           nonstd::nullopt,
+                           nonstd::nullopt,
+                           nonstd::nullopt,
+                           nonstd::nullopt,
+                           frame_size);
+        };
+
+        BENCHMARK("default read size") {
+            return pop.get(selection);
+        };
+    }
+
+    std::remove(path.c_str());
+    std::remove(path_counted.c_str());
+}
+
+TEST_CASE("ElementReportReader parallel scaling", "[.benchmark]") {
+    const std::string path = "./data/elements-scaling.h5.tmp";
+    const size_t n_nodes = 2000;
+    const size_t n_elements = 8;
+    const size_t n_frames = 2000;
+    writeElementReport(path, n_nodes, n_elements, n_frames);
+
+    {
+        WARN("Bytes per query: " << n_frames * n_nodes * n_elements * sizeof(float));
+
+        // Every other node, so that each timestep is read in several pieces
+        Selection::Values every_other(n_nodes / 2);
+        for (size_t i = 0; i < every_other.size(); ++i) {
+            every_other[i] = 1 + 2 * i;
+        }
+        const auto sparse = Selection::fromValues(every_other);
+
+        for (size_t n_threads : {1, 2, 4, 8, 16, 32}) {
+            const ElementReportReader reader(path, n_threads);
+            const auto& pop = reader.openPopulation("All");
+
+            BENCHMARK("all nodes, " + std::to_string(n_threads) + " threads") {
+                return pop.get();
+            };
+
+            BENCHMARK("every other node, " + std::to_string(n_threads) + " threads") {
+                return pop.get(sparse);
+            };
+        }
+    }
+
+    std::remove(path.c_str());
+}